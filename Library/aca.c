@@ -368,6 +368,249 @@ decomp_partialaca_rkmatrix(matrixentry_t entry, void *data,
   freemem(cpiv);
 }
 
+/* Column j of the residual of the rank-k approximation in R */
+static void
+residual_column_aca(matrixentry_t entry, void *data, const uint * ridx,
+		    const uint * cidx, uint j, pcrkmatrix R, uint k,
+		    pamatrix c)
+{
+  pcfield   aa = R->A.a;
+  pcfield   bb = R->B.a;
+  longindex lda = R->A.ld;
+  longindex ldb = R->B.ld;
+  uint      rows = c->rows;
+  field     Bj;
+  uint      i, mu;
+
+  entry(ridx, cidx + j, data, false, c);
+
+  for (mu = 0; mu < k; ++mu) {
+    Bj = bb[j + mu * ldb];
+    for (i = 0; i < rows; ++i) {
+      c->a[i] -= aa[i + mu * lda] * Bj;
+    }
+  }
+}
+
+/* Row i of the residual of the rank-k approximation in R, stored
+ * as a column in r */
+static void
+residual_row_aca(matrixentry_t entry, void *data, const uint * ridx,
+		 const uint * cidx, uint i, pcrkmatrix R, uint k, pamatrix r)
+{
+  pcfield   aa = R->A.a;
+  pcfield   bb = R->B.a;
+  longindex lda = R->A.ld;
+  longindex ldb = R->B.ld;
+  uint      cols = r->rows;
+  field     Ai;
+  uint      j, mu;
+
+  entry(ridx + i, cidx, data, true, r);
+
+  for (mu = 0; mu < k; ++mu) {
+    Ai = aa[i + mu * lda];
+    for (j = 0; j < cols; ++j) {
+      r->a[j] -= bb[j + mu * ldb] * Ai;
+    }
+  }
+}
+
+/* Index of the largest entry of x not marked in done */
+static uint
+argmax_aca(pcfield x, const bool * done, uint n)
+{
+  real      M;
+  uint      i, i_k;
+
+  M = -1.0;
+  i_k = 0;
+  for (i = 0; i < n; ++i) {
+    if (!done[i] && ABSSQR(x[i]) > M) {
+      M = ABSSQR(x[i]);
+      i_k = i;
+    }
+  }
+
+  return i_k;
+}
+
+/* Index of the smallest entry of x not marked in done */
+static uint
+argmin_aca(pcfield x, const bool * done, uint n)
+{
+  real      M;
+  uint      i, i_k;
+
+  M = -1.0;
+  i_k = 0;
+  for (i = 0; i < n; ++i) {
+    if (!done[i] && (M < 0.0 || ABSSQR(x[i]) < M)) {
+      M = ABSSQR(x[i]);
+      i_k = i;
+    }
+  }
+
+  return i_k;
+}
+
+void
+decomp_partialacaplus_rkmatrix(matrixentry_t entry, void *data,
+			       const uint * ridx, const uint rows,
+			       const uint * cidx, const uint cols,
+			       real accur,
+			       uint ** rpivot, uint ** cpivot, prkmatrix R)
+{
+  pamatrix  A, B, cref, rref;
+  amatrix   a_k, b_k, tmp1, tmp2;
+  bool     *rdone, *cdone;
+  uint     *rpiv, *cpiv;
+  uint      i, j, k, i_k, j_k, iref, jref, kmax;
+  real      error, error2, starterror;
+  field     Aij;
+  pfield    aa, bb;
+
+  k = 0;
+  kmax = (rows < cols ? rows : cols);
+
+  rdone = (bool *) allocmem(sizeof(bool) * rows);
+  cdone = (bool *) allocmem(sizeof(bool) * cols);
+  rpiv = allocuint(kmax);
+  cpiv = allocuint(kmax);
+
+  for (i = 0; i < rows; ++i) {
+    rdone[i] = false;
+  }
+
+  for (j = 0; j < cols; ++j) {
+    cdone[j] = false;
+  }
+
+  A = &R->A;
+  B = &R->B;
+
+  cref = init_amatrix(&tmp1, rows, 1);
+  rref = init_amatrix(&tmp2, cols, 1);
+
+  /* Reference column and a reference row with a small entry in it. */
+  iref = 0;
+  jref = cols / 2;
+  if (kmax > 0) {
+    residual_column_aca(entry, data, ridx, cidx, jref, R, 0, cref);
+    iref = argmin_aca(cref->a, rdone, rows);
+    residual_row_aca(entry, data, ridx, cidx, iref, R, 0, rref);
+  }
+
+  error = 1.0;
+  starterror = 1.0;
+
+  while (error > accur && k < kmax) {
+    resizecopy_amatrix(A, rows, k + 1);
+    resizecopy_amatrix(B, cols, k + 1);
+    aa = A->a;
+    bb = B->a;
+
+    (void) init_sub_amatrix(&a_k, A, rows, 0, 1, k);
+    (void) init_sub_amatrix(&b_k, B, cols, 0, 1, k);
+
+    /* Start with the row or column containing the largest entry of
+     * the reference column or row, respectively. */
+    i_k = argmax_aca(cref->a, rdone, rows);
+    j_k = argmax_aca(rref->a, cdone, cols);
+
+    if (ABSSQR(cref->a[i_k]) > ABSSQR(rref->a[j_k])) {
+      residual_row_aca(entry, data, ridx, cidx, i_k, R, k, &b_k);
+      j_k = argmax_aca(b_k.a, cdone, cols);
+      residual_column_aca(entry, data, ridx, cidx, j_k, R, k, &a_k);
+    }
+    else {
+      residual_column_aca(entry, data, ridx, cidx, j_k, R, k, &a_k);
+      i_k = argmax_aca(a_k.a, rdone, rows);
+      residual_row_aca(entry, data, ridx, cidx, i_k, R, k, &b_k);
+    }
+
+    uninit_amatrix(&a_k);
+    uninit_amatrix(&b_k);
+
+    if (ABSSQR(bb[j_k + k * cols]) == 0.0) {
+      break;
+    }
+
+    Aij = 1.0 / bb[j_k + k * cols];
+    for (i = 0; i < rows; ++i) {
+      aa[i + k * rows] = aa[i + k * rows] * Aij;
+    }
+
+    rdone[i_k] = true;
+    cdone[j_k] = true;
+    rpiv[k] = i_k;
+    cpiv[k] = j_k;
+
+    /* Computation of current relative error. */
+    error = 0.0;
+    for (i = 0; i < rows; ++i) {
+      error += ABSSQR(aa[i + k * rows]);
+    }
+    error2 = 0.0;
+    for (j = 0; j < cols; ++j) {
+      error2 += ABSSQR(bb[j + k * cols]);
+    }
+    if (k == 0) {
+      starterror = 1.0 / REAL_SQRT(error * error2);
+    }
+    error = REAL_SQRT(error * error2) * starterror;
+
+    /* Update reference column and row. */
+    Aij = bb[jref + k * cols];
+    for (i = 0; i < rows; ++i) {
+      cref->a[i] -= aa[i + k * rows] * Aij;
+    }
+    Aij = aa[iref + k * rows];
+    for (j = 0; j < cols; ++j) {
+      rref->a[j] -= bb[j + k * cols] * Aij;
+    }
+
+    k++;
+
+    /* Replace reference column and row if they have become pivots. */
+    if (k < kmax && cdone[jref]) {
+      do {
+	jref = (jref + 1) % cols;
+      } while (cdone[jref]);
+      residual_column_aca(entry, data, ridx, cidx, jref, R, k, cref);
+    }
+    if (k < kmax && rdone[iref]) {
+      iref = argmin_aca(cref->a, rdone, rows);
+      residual_row_aca(entry, data, ridx, cidx, iref, R, k, rref);
+    }
+  }
+
+  resizecopy_amatrix(A, rows, k);
+  resizecopy_amatrix(B, cols, k);
+  R->k = k;
+
+  if (rpivot != NULL) {
+    *rpivot = allocuint(k);
+    for (i = 0; i < k; ++i) {
+      (*rpivot)[i] = ridx[rpiv[i]];
+    }
+  }
+
+  if (cpivot != NULL) {
+    *cpivot = allocuint(k);
+    for (i = 0; i < k; ++i) {
+      (*cpivot)[i] = cidx[cpiv[i]];
+    }
+  }
+
+  uninit_amatrix(rref);
+  uninit_amatrix(cref);
+  freemem(cpiv);
+  freemem(rpiv);
+  freemem(cdone);
+  freemem(rdone);
+}
+
 void
 copy_lower_aca_amatrix(bool unit, pcamatrix A, uint * xi, pamatrix B)
 {
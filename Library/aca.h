@@ -117,6 +117,42 @@ decomp_partialaca_rkmatrix(matrixentry_t entry, void *data,
 			   real accur,
 			   uint **rpivot, uint **cpivot, prkmatrix R);
 
+/**
+ * @brief This routine computes the adaptive cross approximation of an
+ * implicitly given matrix @f$ A @f$ using the pivoting strategy ACA+.
+ *
+ * Instead of taking the next pivot row from the last computed column as in
+ * @ref decomp_partialaca_rkmatrix , ACA+ keeps the residuals of a reference
+ * row and a reference column up to date. In every step, the pivot
+ * is taken from the row or column that contains the largest entry of
+ * these two reference vectors. This avoids missing parts of the matrix that
+ * are not visible in the last computed cross, e.g., for blocks
+ * containing zero or almost zero rows, at the cost of occasionally evaluating
+ * a new reference row or column.
+ *
+ * @param entry This callback function implicitly defines the matrix @f$ A @f$,
+ * see @ref decomp_partialaca_rkmatrix.
+ * @param data An additional void-pointer to some data-object that will be needed
+ * by <tt>entry</tt> to compute the matrix entries.
+ * @param ridx An array of all row indices defining the complete matrix @f$ A @f$.
+ * @param rows Number of rows for the implicit matrix and therefore the length of
+ * <tt>ridx</tt>.
+ * @param cidx An array of all column indices defining the complete matrix @f$ A @f$.
+ * @param cols Number of columns for the implicit matrix and therefore the length of
+ * <tt>cidx</tt>.
+ * @param accur Accuracy defining how good the approximation has to be relative
+ * to the input matrix.
+ * @param rpivot Returns an array of row pivot indices.
+ * @param cpivot Returns an array of column pivot indices.
+ * @param R The resulting low rank matrix is returned via <tt>R</tt> .
+ */
+HEADER_PREFIX void
+decomp_partialacaplus_rkmatrix(matrixentry_t entry, void *data,
+			       const uint *ridx, const uint rows,
+			       const uint *cidx, const uint cols,
+			       real accur,
+			       uint **rpivot, uint **cpivot, prkmatrix R);
+
 /**
  * @brief Copies the lower triangular part of a matrix <tt>A</tt> to a matrix <tt>B</tt>
  * after applying the row pivoting denoted by <tt>xi</tt>.
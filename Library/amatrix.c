@@ -13,6 +13,14 @@
 
 #include "lapack_types.h"
 
+/* Without BLAS, the matrix multiplication and the matrix-vector
+ * multiplications use AVX2 kernels if the processor supports them,
+ * this is checked at runtime. */
+#if !defined(USE_BLAS) && defined(USE_SIMD) && defined(__GNUC__) && defined(__x86_64__)
+#define USE_SIMD_AMATRIX
+#include <immintrin.h>
+#endif
+
 static uint active_amatrix = 0;
 
 /* ------------------------------------------------------------
@@ -82,6 +90,26 @@ init_vec_amatrix(pamatrix a, pavector src, uint rows, uint cols)
   return a;
 }
 
+pamatrix
+init_pointer_amatrix(pamatrix a, pfield src, uint rows, uint cols)
+{
+  assert(a != NULL);
+  assert(rows == 0 || cols == 0 || src != NULL);
+
+  a->a = src;
+  a->ld = rows;
+  a->rows = rows;
+  a->cols = cols;
+  a->owner = src;
+
+#ifdef USE_OPENMP
+#pragma omp atomic
+#endif
+  active_amatrix++;
+
+  return a;
+}
+
 pamatrix
 init_zero_amatrix(pamatrix a, uint rows, uint cols)
 {
@@ -747,41 +775,200 @@ addevaltrans_amatrix_avector(field alpha, pcamatrix a, pcavector src,
 	   src->v, &l_one, &f_one, trg->v, &l_one);
 }
 #else
+/* Kernels for y <- y + alpha A x and y <- y + alpha A^* x with a
+   column-major rows x cols matrix A */
+typedef void (*gemvkernel) (uint rows, uint cols, field alpha, pcfield aa,
+			    longindex lda, pcfield sv, pfield tv);
+
+static void
+kernel_gemv_amatrix(uint rows, uint cols, field alpha, pcfield aa,
+		    longindex lda, pcfield sv, pfield tv)
+{
+  field     x0, x1, x2, x3;
+  uint      i, j;
+
+  /* Run through the columns to access the matrix contiguously,
+     four at a time to reduce the number of passes through trg */
+  for (j = 0; j + 4 <= cols; j += 4) {
+    x0 = alpha * sv[j];
+    x1 = alpha * sv[j + 1];
+    x2 = alpha * sv[j + 2];
+    x3 = alpha * sv[j + 3];
+    for (i = 0; i < rows; i++)
+      tv[i] += (aa[i + j * lda] * x0 + aa[i + (j + 1) * lda] * x1
+		+ aa[i + (j + 2) * lda] * x2 + aa[i + (j + 3) * lda] * x3);
+  }
+  for (; j < cols; j++) {
+    x0 = alpha * sv[j];
+    for (i = 0; i < rows; i++)
+      tv[i] += aa[i + j * lda] * x0;
+  }
+}
+
+static void
+kernel_gemvtrans_amatrix(uint rows, uint cols, field alpha, pcfield aa,
+			 longindex lda, pcfield sv, pfield tv)
+{
+  field     sum0, sum1, sum2, sum3;
+  uint      i, j;
+
+  /* Four dot products at a time share the loads of src */
+  for (j = 0; j + 4 <= cols; j += 4) {
+    sum0 = sum1 = sum2 = sum3 = f_zero;
+    for (i = 0; i < rows; i++) {
+      sum0 += CONJ(aa[i + j * lda]) * sv[i];
+      sum1 += CONJ(aa[i + (j + 1) * lda]) * sv[i];
+      sum2 += CONJ(aa[i + (j + 2) * lda]) * sv[i];
+      sum3 += CONJ(aa[i + (j + 3) * lda]) * sv[i];
+    }
+    tv[j] += alpha * sum0;
+    tv[j + 1] += alpha * sum1;
+    tv[j + 2] += alpha * sum2;
+    tv[j + 3] += alpha * sum3;
+  }
+  for (; j < cols; j++) {
+    sum0 = f_zero;
+    for (i = 0; i < rows; i++)
+      sum0 += CONJ(aa[i + j * lda]) * sv[i];
+    tv[j] += alpha * sum0;
+  }
+}
+
+#ifdef USE_SIMD_AMATRIX
+__attribute__ ((target("avx2,fma")))
+static void
+kernel_gemv_avx2_amatrix(uint rows, uint cols, field alpha, pcfield aa,
+			 longindex lda, pcfield sv, pfield tv)
+{
+  __m256d   x0, x1, x2, x3, t;
+  pcfield   a0, a1, a2, a3;
+  uint      i, j;
+
+  for (j = 0; j + 4 <= cols; j += 4) {
+    a0 = aa + j * lda;
+    a1 = a0 + lda;
+    a2 = a1 + lda;
+    a3 = a2 + lda;
+    x0 = _mm256_set1_pd(alpha * sv[j]);
+    x1 = _mm256_set1_pd(alpha * sv[j + 1]);
+    x2 = _mm256_set1_pd(alpha * sv[j + 2]);
+    x3 = _mm256_set1_pd(alpha * sv[j + 3]);
+
+    for (i = 0; i + 4 <= rows; i += 4) {
+      t = _mm256_loadu_pd(tv + i);
+      t = _mm256_fmadd_pd(_mm256_loadu_pd(a0 + i), x0, t);
+      t = _mm256_fmadd_pd(_mm256_loadu_pd(a1 + i), x1, t);
+      t = _mm256_fmadd_pd(_mm256_loadu_pd(a2 + i), x2, t);
+      t = _mm256_fmadd_pd(_mm256_loadu_pd(a3 + i), x3, t);
+      _mm256_storeu_pd(tv + i, t);
+    }
+    for (; i < rows; i++)
+      tv[i] += (a0[i] * sv[j] + a1[i] * sv[j + 1]
+		+ a2[i] * sv[j + 2] + a3[i] * sv[j + 3]) * alpha;
+  }
+
+  if (j < cols)
+    kernel_gemv_amatrix(rows, cols - j, alpha, aa + j * lda, lda, sv + j,
+			tv);
+}
+
+__attribute__ ((target("avx2,fma")))
+static    field
+hsum_avx2_amatrix(__m256d s)
+{
+  __m128d   h;
+
+  h = _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+  h = _mm_add_sd(h, _mm_unpackhi_pd(h, h));
+
+  return _mm_cvtsd_f64(h);
+}
+
+__attribute__ ((target("avx2,fma")))
+static void
+kernel_gemvtrans_avx2_amatrix(uint rows, uint cols, field alpha,
+			      pcfield aa, longindex lda, pcfield sv,
+			      pfield tv)
+{
+  __m256d   s0, s1, s2, s3, v;
+  pcfield   a0, a1, a2, a3;
+  field     sum0, sum1, sum2, sum3;
+  uint      i, j;
+
+  for (j = 0; j + 4 <= cols; j += 4) {
+    a0 = aa + j * lda;
+    a1 = a0 + lda;
+    a2 = a1 + lda;
+    a3 = a2 + lda;
+    s0 = s1 = s2 = s3 = _mm256_setzero_pd();
+
+    for (i = 0; i + 4 <= rows; i += 4) {
+      v = _mm256_loadu_pd(sv + i);
+      s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a0 + i), v, s0);
+      s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a1 + i), v, s1);
+      s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a2 + i), v, s2);
+      s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a3 + i), v, s3);
+    }
+
+    sum0 = hsum_avx2_amatrix(s0);
+    sum1 = hsum_avx2_amatrix(s1);
+    sum2 = hsum_avx2_amatrix(s2);
+    sum3 = hsum_avx2_amatrix(s3);
+    for (; i < rows; i++) {
+      sum0 += a0[i] * sv[i];
+      sum1 += a1[i] * sv[i];
+      sum2 += a2[i] * sv[i];
+      sum3 += a3[i] * sv[i];
+    }
+
+    tv[j] += alpha * sum0;
+    tv[j + 1] += alpha * sum1;
+    tv[j + 2] += alpha * sum2;
+    tv[j + 3] += alpha * sum3;
+  }
+
+  if (j < cols)
+    kernel_gemvtrans_amatrix(rows, cols - j, alpha, aa + j * lda, lda, sv,
+			     tv + j);
+}
+#endif
+
+static gemvkernel
+select_kernel_gemv_amatrix(bool atrans)
+{
+#ifdef USE_SIMD_AMATRIX
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return (atrans ? kernel_gemvtrans_avx2_amatrix :
+	    kernel_gemv_avx2_amatrix);
+#endif
+  return (atrans ? kernel_gemvtrans_amatrix : kernel_gemv_amatrix);
+}
+
 void
 addeval_amatrix_avector(field alpha, pcamatrix a, pcavector src, pavector trg)
 {
-  field     sum;
-  longindex lda = a->ld;
-  uint      i, j;
+  gemvkernel kernel;
 
   assert(src->dim >= a->cols);
   assert(trg->dim >= a->rows);
 
-  for (i = 0; i < a->rows; i++) {
-    sum = f_zero;
-    for (j = 0; j < a->cols; j++)
-      sum += a->a[i + j * lda] * src->v[j];
-    trg->v[i] += alpha * sum;
-  }
+  kernel = select_kernel_gemv_amatrix(false);
+
+  kernel(a->rows, a->cols, alpha, a->a, a->ld, src->v, trg->v);
 }
 
 void
 addevaltrans_amatrix_avector(field alpha, pcamatrix a, pcavector src,
 			     pavector trg)
 {
-  field     sum;
-  longindex lda = a->ld;
-  uint      i, j;
+  gemvkernel kernel;
 
   assert(src->dim >= a->rows);
   assert(trg->dim >= a->cols);
 
-  for (j = 0; j < a->cols; j++) {
-    sum = f_zero;
-    for (i = 0; i < a->rows; i++)
-      sum += CONJ(a->a[i + j * lda]) * src->v[i];
-    trg->v[j] += alpha * sum;
-  }
+  kernel = select_kernel_gemv_amatrix(true);
+
+  kernel(a->rows, a->cols, alpha, a->a, a->ld, src->v, trg->v);
 }
 #endif
 
@@ -940,9 +1127,26 @@ addmul_amatrix(field alpha,
   }
 }
 #else
-void
-addmul_amatrix(field alpha, bool atrans, pcamatrix a, bool btrans,
-	       pcamatrix b, pamatrix c)
+/* Without BLAS, the matrix multiplication follows the structure of
+ * optimized BLAS implementations: the factors are split into blocks
+ * that fit into the caches, these blocks are copied into contiguous
+ * panels of GEMM_MR rows and GEMM_NR columns, and a micro-kernel keeps
+ * a GEMM_MR x GEMM_NR block of the product in registers while running
+ * through the panels. Small products are handled by simple loops. */
+
+#define GEMM_MR 8
+#define GEMM_NR 4
+#define GEMM_MC 128
+#define GEMM_KC 256
+#define GEMM_NC 2048
+#define GEMM_SMALL 32768
+
+typedef void (*gemmkernel) (uint kc, pcfield ap, pcfield bp, field alpha,
+			    pfield c, longindex ldc);
+
+static void
+addmul_simple_amatrix(field alpha, bool atrans, pcamatrix a, bool btrans,
+		      pcamatrix b, pamatrix c)
 {
   uint      rows, cols, mid;
   pcfield   aa = a->a;
@@ -1027,6 +1231,198 @@ addmul_amatrix(field alpha, bool atrans, pcamatrix a, bool btrans,
     }
   }
 }
+
+/* Copy rows [i0, i0+mc) and columns [l0, l0+kc) of A or A^* into
+   panels of GEMM_MR rows, padded by zeros */
+static void
+pack_a_amatrix(bool atrans, pcamatrix a, uint i0, uint mc, uint l0, uint kc,
+	       pfield ap)
+{
+  pcfield   aa = a->a;
+  longindex lda = a->ld;
+  uint      i, ii, l;
+
+  for (i = 0; i < mc; i += GEMM_MR)
+    for (l = 0; l < kc; l++) {
+      for (ii = 0; ii < GEMM_MR && i + ii < mc; ii++)
+	ap[ii] = (atrans ? CONJ(aa[(l0 + l) + (i0 + i + ii) * lda]) :
+		  aa[(i0 + i + ii) + (l0 + l) * lda]);
+      for (; ii < GEMM_MR; ii++)
+	ap[ii] = f_zero;
+      ap += GEMM_MR;
+    }
+}
+
+/* Copy rows [l0, l0+kc) and columns [j0, j0+nc) of B or B^* into
+   panels of GEMM_NR columns, padded by zeros */
+static void
+pack_b_amatrix(bool btrans, pcamatrix b, uint l0, uint kc, uint j0, uint nc,
+	       pfield bp)
+{
+  pcfield   ba = b->a;
+  longindex ldb = b->ld;
+  uint      j, jj, l;
+
+  for (j = 0; j < nc; j += GEMM_NR)
+    for (l = 0; l < kc; l++) {
+      for (jj = 0; jj < GEMM_NR && j + jj < nc; jj++)
+	bp[jj] = (btrans ? CONJ(ba[(j0 + j + jj) + (l0 + l) * ldb]) :
+		  ba[(l0 + l) + (j0 + j + jj) * ldb]);
+      for (; jj < GEMM_NR; jj++)
+	bp[jj] = f_zero;
+      bp += GEMM_NR;
+    }
+}
+
+static void
+kernel_gemm_amatrix(uint kc, pcfield ap, pcfield bp, field alpha,
+		    pfield c, longindex ldc)
+{
+  field     ab[GEMM_MR * GEMM_NR];
+  uint      i, j, l;
+
+  for (i = 0; i < GEMM_MR * GEMM_NR; i++)
+    ab[i] = f_zero;
+
+  for (l = 0; l < kc; l++) {
+    for (j = 0; j < GEMM_NR; j++)
+      for (i = 0; i < GEMM_MR; i++)
+	ab[i + j * GEMM_MR] += ap[i] * bp[j];
+    ap += GEMM_MR;
+    bp += GEMM_NR;
+  }
+
+  for (j = 0; j < GEMM_NR; j++)
+    for (i = 0; i < GEMM_MR; i++)
+      c[i + j * ldc] += alpha * ab[i + j * GEMM_MR];
+}
+
+#ifdef USE_SIMD_AMATRIX
+__attribute__ ((target("avx2,fma")))
+static void
+kernel_gemm_avx2_amatrix(uint kc, pcfield ap, pcfield bp, field alpha,
+			 pfield c, longindex ldc)
+{
+  __m256d   c00, c10, c01, c11, c02, c12, c03, c13;
+  __m256d   a0, a1, b;
+  uint      l;
+
+  c00 = c10 = c01 = c11 = _mm256_setzero_pd();
+  c02 = c12 = c03 = c13 = _mm256_setzero_pd();
+
+  for (l = 0; l < kc; l++) {
+    a0 = _mm256_loadu_pd(ap);
+    a1 = _mm256_loadu_pd(ap + 4);
+
+    b = _mm256_broadcast_sd(bp);
+    c00 = _mm256_fmadd_pd(a0, b, c00);
+    c10 = _mm256_fmadd_pd(a1, b, c10);
+    b = _mm256_broadcast_sd(bp + 1);
+    c01 = _mm256_fmadd_pd(a0, b, c01);
+    c11 = _mm256_fmadd_pd(a1, b, c11);
+    b = _mm256_broadcast_sd(bp + 2);
+    c02 = _mm256_fmadd_pd(a0, b, c02);
+    c12 = _mm256_fmadd_pd(a1, b, c12);
+    b = _mm256_broadcast_sd(bp + 3);
+    c03 = _mm256_fmadd_pd(a0, b, c03);
+    c13 = _mm256_fmadd_pd(a1, b, c13);
+
+    ap += GEMM_MR;
+    bp += GEMM_NR;
+  }
+
+  b = _mm256_set1_pd(alpha);
+  _mm256_storeu_pd(c, _mm256_fmadd_pd(b, c00, _mm256_loadu_pd(c)));
+  _mm256_storeu_pd(c + 4, _mm256_fmadd_pd(b, c10, _mm256_loadu_pd(c + 4)));
+  c += ldc;
+  _mm256_storeu_pd(c, _mm256_fmadd_pd(b, c01, _mm256_loadu_pd(c)));
+  _mm256_storeu_pd(c + 4, _mm256_fmadd_pd(b, c11, _mm256_loadu_pd(c + 4)));
+  c += ldc;
+  _mm256_storeu_pd(c, _mm256_fmadd_pd(b, c02, _mm256_loadu_pd(c)));
+  _mm256_storeu_pd(c + 4, _mm256_fmadd_pd(b, c12, _mm256_loadu_pd(c + 4)));
+  c += ldc;
+  _mm256_storeu_pd(c, _mm256_fmadd_pd(b, c03, _mm256_loadu_pd(c)));
+  _mm256_storeu_pd(c + 4, _mm256_fmadd_pd(b, c13, _mm256_loadu_pd(c + 4)));
+}
+#endif
+
+static gemmkernel
+select_kernel_gemm_amatrix()
+{
+#ifdef USE_SIMD_AMATRIX
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return kernel_gemm_avx2_amatrix;
+#endif
+  return kernel_gemm_amatrix;
+}
+
+void
+addmul_amatrix(field alpha, bool atrans, pcamatrix a, bool btrans,
+	       pcamatrix b, pamatrix c)
+{
+  gemmkernel kernel;
+  pfield    ap, bp;
+  field     ct[GEMM_MR * GEMM_NR];
+  pfield    ca = c->a;
+  longindex ldc = c->ld;
+  uint      rows, cols, mid;
+  uint      ic, jc, pc, ir, jr, mc, nc, kc, i, j;
+
+  rows = (atrans ? a->cols : a->rows);
+  mid = (atrans ? a->rows : a->cols);
+  cols = (btrans ? b->rows : b->cols);
+
+  assert(rows <= c->rows);
+  assert(cols <= c->cols);
+  assert(mid == (btrans ? b->cols : b->rows));
+
+  if (rows < GEMM_MR || cols < GEMM_NR
+      || (size_t) rows * cols * mid < GEMM_SMALL) {
+    addmul_simple_amatrix(alpha, atrans, a, btrans, b, c);
+    return;
+  }
+
+  kernel = select_kernel_gemm_amatrix();
+
+  ap = allocfield(GEMM_MC * GEMM_KC);
+  bp = allocfield(GEMM_KC * GEMM_NC);
+
+  for (jc = 0; jc < cols; jc += GEMM_NC) {
+    nc = UINT_MIN(GEMM_NC, cols - jc);
+
+    for (pc = 0; pc < mid; pc += GEMM_KC) {
+      kc = UINT_MIN(GEMM_KC, mid - pc);
+
+      pack_b_amatrix(btrans, b, pc, kc, jc, nc, bp);
+
+      for (ic = 0; ic < rows; ic += GEMM_MC) {
+	mc = UINT_MIN(GEMM_MC, rows - ic);
+
+	pack_a_amatrix(atrans, a, ic, mc, pc, kc, ap);
+
+	for (jr = 0; jr < nc; jr += GEMM_NR)
+	  for (ir = 0; ir < mc; ir += GEMM_MR) {
+	    if (ir + GEMM_MR <= mc && jr + GEMM_NR <= nc)
+	      kernel(kc, ap + ir * kc, bp + jr * kc, alpha,
+		     ca + (ic + ir) + (longindex) (jc + jr) * ldc, ldc);
+	    else {
+	      /* Partial block at the boundary */
+	      for (i = 0; i < GEMM_MR * GEMM_NR; i++)
+		ct[i] = f_zero;
+	      kernel(kc, ap + ir * kc, bp + jr * kc, alpha, ct, GEMM_MR);
+	      for (j = 0; j < GEMM_NR && jr + j < nc; j++)
+		for (i = 0; i < GEMM_MR && ir + i < mc; i++)
+		  ca[(ic + ir + i) + (longindex) (jc + jr + j) * ldc] +=
+		    ct[i + j * GEMM_MR];
+	    }
+	  }
+      }
+    }
+  }
+
+  freemem(bp);
+  freemem(ap);
+}
 #endif
 
 #ifdef USE_BLAS
@@ -110,6 +110,24 @@ init_sub_amatrix(pamatrix a, pamatrix src,
 HEADER_PREFIX pamatrix
 init_vec_amatrix(pamatrix a, pavector src, uint rows, uint cols);
 
+/** @brief Initialize an @ref amatrix object using a given array for
+ *  the coefficients.
+ *
+ *  Sets up the components of the object and uses the given array to
+ *  represent the coefficients column by column.
+ *
+ *  @remark Should always be matched by a call to @ref uninit_amatrix that
+ *  will <em>not</em> release the coefficient storage.
+ *
+ *  @param a Object to be initialized.
+ *  @param src Source array, should contain at least <tt>rows*cols</tt>
+ *         elements.
+ *  @param rows Number of rows.
+ *  @param cols Number of columns.
+ *  @returns Initialized @ref amatrix object. */
+HEADER_PREFIX pamatrix
+init_pointer_amatrix(pamatrix a, pfield src, uint rows, uint cols);
+
 /** @brief Initialize an @ref amatrix object and set it to zero.
  *
  *  Sets up the components of the object, allocates storage for the
@@ -208,6 +208,164 @@ freemem(void *ptr)
   free(ptr);
 }
 
+/* ------------------------------------------------------------
+   Arena allocation
+   ------------------------------------------------------------ */
+
+/* Every chunk starts with a header holding a pointer to the next
+   chunk and the size of the chunk, padded to ARENA_ALIGN bytes,
+   followed by the objects. */
+#define ARENA_ALIGN 16
+
+typedef struct {
+  char     *next;
+  size_t    size;
+} arenachunk;
+
+struct _arena {
+  /** @brief First chunk, new objects are taken from it. */
+  char     *chunk;
+  /** @brief Bytes used in the first chunk. */
+  size_t    used;
+  /** @brief Total size of the first chunk. */
+  size_t    avail;
+
+  /** @brief Default size of new chunks. */
+  size_t    chunksize;
+  /** @brief Total size of all chunks. */
+  size_t    size;
+
+  /** @brief Number of references to this arena. */
+  uint      refs;
+};
+
+parena
+new_arena(size_t chunksize)
+{
+  parena    pa;
+
+  assert(sizeof(arenachunk) <= ARENA_ALIGN);
+
+  pa = (parena) allocmem(sizeof(arena));
+
+  pa->chunk = NULL;
+  pa->used = 0;
+  pa->avail = 0;
+  pa->chunksize = (chunksize > 0 ? chunksize : 65536);
+  pa->size = 0;
+  pa->refs = 0;
+
+  return pa;
+}
+
+void
+del_arena(parena pa)
+{
+  char     *chunk, *next;
+
+  assert(pa->refs == 0);
+
+  chunk = pa->chunk;
+  while (chunk) {
+    next = ((arenachunk *) chunk)->next;
+    freemem(chunk);
+    chunk = next;
+  }
+
+  freemem(pa);
+}
+
+void
+ref_arena(parena *ptr, parena pa)
+{
+  if (*ptr)
+    unref_arena(*ptr);
+
+  *ptr = pa;
+
+  if (pa)
+    pa->refs++;
+}
+
+void
+unref_arena(parena pa)
+{
+  assert(pa->refs > 0);
+
+  pa->refs--;
+
+  if (pa->refs == 0)
+    del_arena(pa);
+}
+
+void     *
+_h2_allocarena(parena pa, size_t sz, const char *filename, int line)
+{
+  char     *chunk;
+  size_t    csz;
+
+  sz = (sz + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+
+  if (pa->chunk == NULL || pa->used + sz > pa->avail) {
+    csz = ARENA_ALIGN + sz;
+
+    if (csz <= pa->chunksize / 4 || pa->chunk == NULL) {
+      /* Start a new chunk for this and the following objects */
+      if (csz < pa->chunksize)
+	csz = pa->chunksize;
+
+      chunk = (char *) _h2_allocmem(csz, filename, line);
+      ((arenachunk *) chunk)->next = pa->chunk;
+      ((arenachunk *) chunk)->size = csz;
+      pa->chunk = chunk;
+      pa->used = ARENA_ALIGN;
+      pa->avail = csz;
+    }
+    else {
+      /* Large objects get a chunk of their own, so that the
+         remainder of the current chunk is not wasted */
+      chunk = (char *) _h2_allocmem(csz, filename, line);
+      ((arenachunk *) chunk)->next = ((arenachunk *) pa->chunk)->next;
+      ((arenachunk *) chunk)->size = csz;
+      ((arenachunk *) pa->chunk)->next = chunk;
+      pa->size += csz;
+
+      return chunk + ARENA_ALIGN;
+    }
+
+    pa->size += csz;
+  }
+
+  chunk = pa->chunk + pa->used;
+  pa->used += sz;
+
+  return chunk;
+}
+
+size_t
+getsize_arena(pcarena pa)
+{
+  return sizeof(arena) + pa->size;
+}
+
+bool
+contains_arena(pcarena pa, const void *ptr)
+{
+  const char *p = (const char *) ptr;
+  const char *chunk;
+
+  chunk = pa->chunk;
+  while (chunk) {
+    /* Comparing unrelated pointers is not covered by C89, but works
+       for the flat address spaces we support */
+    if (p >= chunk && p < chunk + ((const arenachunk *) chunk)->size)
+      return true;
+    chunk = ((const arenachunk *) chunk)->next;
+  }
+
+  return false;
+}
+
 /* ------------------------------------------------------------
    Sorting
    ------------------------------------------------------------ */
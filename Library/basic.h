@@ -21,6 +21,15 @@ typedef struct _stopwatch stopwatch;
 /** @brief Pointer to a @ref stopwatch object. */
 typedef stopwatch *pstopwatch;
 
+/** @brief Arena for the bulk allocation of many small objects. */
+typedef struct _arena arena;
+
+/** @brief Pointer to an @ref arena object. */
+typedef arena *parena;
+
+/** @brief Pointer to a constant @ref arena object. */
+typedef const arena *pcarena;
+
 #include <stdlib.h>
 #include <assert.h>
 #include <stdarg.h>
@@ -381,6 +390,93 @@ _h2_allocmatrix(size_t rows, size_t cols, const char *filename, int line);
 void
 freemem(void *ptr);
 
+/* ------------------------------------------------------------
+   Arena allocation
+   ------------------------------------------------------------ */
+
+/** @brief Create an @ref arena object.
+ *
+ *  An arena hands out storage from a small number of large chunks.
+ *  Objects allocated from an arena cannot be released individually,
+ *  instead all chunks are released together when the arena is
+ *  deleted.
+ *  Objects referencing the arena should use @ref ref_arena and
+ *  @ref unref_arena, so that the arena is deleted as soon as the last
+ *  of them has been released.
+ *
+ *  @remark Arenas are not thread-safe.
+ *
+ *  @param chunksize Size of one chunk in bytes, a default is used
+ *         if this is zero.
+ *  @returns New @ref arena object. */
+HEADER_PREFIX parena
+new_arena(size_t chunksize);
+
+/** @brief Delete an @ref arena object and all storage allocated
+ *  from it.
+ *
+ *  Only objects with no references left can be deleted.
+ *
+ *  @param pa Arena to be deleted. */
+HEADER_PREFIX void
+del_arena(parena pa);
+
+/** @brief Set a pointer to an @ref arena object, increase its
+ *  reference counter, and decrease the reference counter of the
+ *  previous arena the pointer pointed to.
+ *
+ *  @param ptr Pointer to the @ref parena variable that will be changed.
+ *  @param pa @ref arena that will be referenced. */
+HEADER_PREFIX void
+ref_arena(parena *ptr, parena pa);
+
+/** @brief Reduce the reference counter of an @ref arena object.
+ *
+ *  If the reference counter reaches zero, the arena and all storage
+ *  allocated from it are released.
+ *
+ *  @param pa @ref arena that will be unreferenced. */
+HEADER_PREFIX void
+unref_arena(parena pa);
+
+/** @brief Allocate storage from an arena.
+ *
+ *  @param pa Arena.
+ *  @param sz Number of bytes.
+ *  @returns Pointer to <tt>sz</tt> bytes, suitably aligned for
+ *  all types used by the library. */
+#define allocarena(pa,sz) _h2_allocarena(pa,sz,__FILE__,__LINE__)
+/** @brief Allocate storage from an arena.
+ *
+ *  @param pa Arena.
+ *  @param sz Number of bytes.
+ *  @param filename Name of source file (used for error messages).
+ *  @param line Line number in source file.
+ *  @returns Pointer to <tt>sz</tt> bytes. */
+HEADER_PREFIX void *
+_h2_allocarena(parena pa, size_t sz, const char *filename, int line);
+
+/** @brief Get the total size of all chunks of an arena.
+ *
+ *  @param pa Arena.
+ *  @returns Size of allocated storage in bytes. */
+HEADER_PREFIX size_t
+getsize_arena(pcarena pa);
+
+/** @brief Check whether an object has been allocated from an arena.
+ *
+ *  Objects that have been allocated from an arena must not be
+ *  released by @ref freemem, while objects that have been allocated
+ *  by @ref allocmem and only attached to an arena-based structure
+ *  later have to be released individually.
+ *
+ *  @param pa Arena.
+ *  @param ptr Pointer to an object.
+ *  @returns <tt>true</tt> if <tt>ptr</tt> points into one of the
+ *  chunks of <tt>pa</tt>, <tt>false</tt> otherwise. */
+HEADER_PREFIX bool
+contains_arena(pcarena pa, const void *ptr);
+
 /* ------------------------------------------------------------
    Sorting
    ------------------------------------------------------------ */
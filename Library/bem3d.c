@@ -628,6 +628,7 @@ new_bem3d(pcsurface3d gr)
 
   bem->mass = NULL;
   bem->v2t = NULL;
+  bem->quadpoints = NULL;
   bem->alpha = 0.0;
 
   bem->N_neumann = 0;
@@ -677,9 +678,81 @@ del_bem3d(pbem3d bem)
     freemem(bem->v2t);
   }
 
+  if (bem->quadpoints != NULL) {
+    freemem(bem->quadpoints);
+  }
+
   freemem(bem);
 }
 
+static void
+map_quadpoints_bem3d(pcbem3d bem, uint t, preal Xq)
+{
+  pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  uint      nq = bem->sq->n_single;
+  real     *xx = bem->sq->x_single;
+  real     *yy = bem->sq->y_single;
+
+  const real *A, *B, *C;
+  real      tx, sx, Ax, Bx, Cx;
+  uint      q, k;
+
+  A = gr_x[gr_t[t][0]];
+  B = gr_x[gr_t[t][1]];
+  C = gr_x[gr_t[t][2]];
+
+  for (q = 0; q < nq; ++q) {
+    tx = xx[q];
+    sx = yy[q];
+    Ax = 1.0 - tx;
+    Bx = tx - sx;
+    Cx = sx;
+
+    for (k = 0; k < 3; ++k) {
+      Xq[q + k * nq] = A[k] * Ax + B[k] * Bx + C[k] * Cx;
+    }
+  }
+}
+
+void
+setup_quadpoints_bem3d(pbem3d bem)
+{
+  uint      triangles = bem->gr->triangles;
+  uint      nq;
+  uint      t;
+
+  assert(bem->sq != NULL);
+
+  nq = bem->sq->n_single;
+
+  if (bem->quadpoints != NULL) {
+    freemem(bem->quadpoints);
+  }
+  bem->quadpoints = allocreal((size_t) 3 * nq * triangles);
+
+  for (t = 0; t < triangles; ++t) {
+    map_quadpoints_bem3d(bem, t, bem->quadpoints + (size_t) 3 * nq * t);
+  }
+}
+
+const real *
+getquadpoints_bem3d(pcbem3d bem, uint t, preal buf)
+{
+  uint      nq = bem->sq->n_single;
+
+  assert(t < bem->gr->triangles);
+
+  if (bem->quadpoints != NULL) {
+    return bem->quadpoints + (size_t) 3 * nq * t;
+  }
+
+  map_quadpoints_bem3d(bem, t, buf);
+
+  return buf;
+}
+
 pvert_list
 new_vert_list(pvert_list next)
 {
@@ -1542,12 +1615,21 @@ assemble_bem3d_greenhybrid_row_rkmatrix(pccluster rc, uint rname,
 
   grc = par->grcn[rname];
 
+  /* Usually prepared by prepare_greencluster3d. Callers that skip it,
+   * e.g., build_bem3d_rkmatrix, construct the cluster here, guarded
+   * against concurrent construction by other threads */
+  if (grc == NULL) {
 #ifdef USE_OPENMP
-#pragma omp critical
+#pragma omp critical (greencluster3d)
 #endif
-  if (grc == NULL) {
-    grc = par->grcn[rname] = new_greencluster3d(rc);
-    assemble_row_greencluster3d(bem, grc);
+    {
+      grc = par->grcn[rname];
+      if (grc == NULL) {
+	grc = new_greencluster3d(rc);
+	assemble_row_greencluster3d(bem, grc);
+	par->grcn[rname] = grc;
+      }
+    }
   }
 
   V = grc->V;
@@ -1645,12 +1727,21 @@ assemble_bem3d_greenhybrid_col_rkmatrix(pccluster rc, uint rname,
 
   gcc = par->gccn[cname];
 
+  /* Usually prepared by prepare_greencluster3d. Callers that skip it,
+   * e.g., build_bem3d_rkmatrix, construct the cluster here, guarded
+   * against concurrent construction by other threads */
+  if (gcc == NULL) {
 #ifdef USE_OPENMP
-#pragma omp critical
+#pragma omp critical (greencluster3d)
 #endif
-  if (gcc == NULL) {
-    gcc = par->gccn[cname] = new_greencluster3d(cc);
-    assemble_col_greencluster3d(bem, gcc);
+    {
+      gcc = par->gccn[cname];
+      if (gcc == NULL) {
+	gcc = new_greencluster3d(cc);
+	assemble_col_greencluster3d(bem, gcc);
+	par->gccn[cname] = gcc;
+      }
+    }
   }
 
   V = gcc->V;
@@ -1684,20 +1775,35 @@ assemble_bem3d_greenhybrid_mixed_rkmatrix(pccluster rc, uint rname,
   grc = par->grcn[rname];
   gcc = par->gccn[cname];
 
+  /* Usually prepared by prepare_greencluster3d. Callers that skip it,
+   * e.g., build_bem3d_rkmatrix, construct the cluster here, guarded
+   * against concurrent construction by other threads */
+  if (grc == NULL) {
 #ifdef USE_OPENMP
-#pragma omp critical
+#pragma omp critical (greencluster3d)
 #endif
-  if (grc == NULL) {
-    grc = par->grcn[rname] = new_greencluster3d(rc);
-    assemble_row_greencluster3d(bem, grc);
+    {
+      grc = par->grcn[rname];
+      if (grc == NULL) {
+	grc = new_greencluster3d(rc);
+	assemble_row_greencluster3d(bem, grc);
+	par->grcn[rname] = grc;
+      }
+    }
   }
 
+  if (gcc == NULL) {
 #ifdef USE_OPENMP
-#pragma omp critical
+#pragma omp critical (greencluster3d)
 #endif
-  if (gcc == NULL) {
-    gcc = par->gccn[cname] = new_greencluster3d(cc);
-    assemble_col_greencluster3d(bem, gcc);
+    {
+      gcc = par->gccn[cname];
+      if (gcc == NULL) {
+	gcc = new_greencluster3d(cc);
+	assemble_col_greencluster3d(bem, gcc);
+	par->gccn[cname] = gcc;
+      }
+    }
   }
 
   rankV = grc->V->cols;
@@ -1773,6 +1879,27 @@ assemble_bem3d_PACA_rkmatrix(pccluster rc, uint rname, pccluster cc,
 			     accur, NULL, NULL, R);
 }
 
+static void
+assemble_bem3d_PACAplus_rkmatrix(pccluster rc, uint rname, pccluster cc,
+				 uint cname, pcbem3d bem, prkmatrix R)
+{
+  paprxbem3d aprx = bem->aprx;
+  const real accur = aprx->accur_aca;
+  void      (*entry) (const uint *, const uint *, void *, bool, pamatrix) =
+    (void (*)(const uint *, const uint *, void *, bool, pamatrix)) bem->
+    nearfield;
+  const uint *ridx = rc->idx;
+  const uint *cidx = cc->idx;
+  const uint rows = rc->size;
+  const uint cols = cc->size;
+
+  (void) rname;
+  (void) cname;
+
+  decomp_partialacaplus_rkmatrix(entry, (void *) bem, ridx, rows, cidx, cols,
+				 accur, NULL, NULL, R);
+}
+
 static void
 assemble_bem3d_HCA_rkmatrix(pccluster rc, uint rname, pccluster cc,
 			    uint cname, pcbem3d bem, prkmatrix R)
@@ -2915,27 +3042,25 @@ assemble_bem3d_lagrange_const_amatrix(const uint * idx, pcavector px,
 {
 
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const preal gr_g = (const preal) gr->g;
   uint      rows = V->rows;
   uint      ld = V->ld;
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * nq;
   uint      mx = px->dim;
   uint      my = py->dim;
   uint      mz = pz->dim;
 
-  const real *A, *B, *C;
+  const real *Xq;
+  real     *xbuf;
   real     *denomx, *denomy, *denomz;
   uint      t, tt, jx, jy, jz, q, l, index;
-  real      gt, sum, lagr, denom, x, y, z, tx, sx, Ax, Bx, Cx;
+  real      gt, sum, lagr, denom, x, y, z;
 
   denomx = allocreal(mx);
   denomy = allocreal(my);
   denomz = allocreal(mz);
+  xbuf = allocreal(3 * nq);
 
   /*
    * integrate Lagrange polynomials with constant basisfunctions
@@ -2982,22 +3107,14 @@ assemble_bem3d_lagrange_const_amatrix(const uint * idx, pcavector px,
 	for (t = 0; t < rows; ++t) {
 	  tt = (idx == NULL ? t : idx[t]);
 	  gt = gr_g[tt];
-	  A = gr_x[gr_t[tt][0]];
-	  B = gr_x[gr_t[tt][1]];
-	  C = gr_x[gr_t[tt][2]];
+	  Xq = getquadpoints_bem3d(bem, tt, xbuf);
 
 	  sum = 0.0;
 
 	  for (q = 0; q < nq; ++q) {
-	    tx = xx[q];
-	    sx = yy[q];
-	    Ax = 1.0 - tx;
-	    Bx = tx - sx;
-	    Cx = sx;
-
-	    x = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-	    y = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-	    z = A[2] * Ax + B[2] * Bx + C[2] * Cx;
+	    x = Xq[q];
+	    y = Xq[q + nq];
+	    z = Xq[q + 2 * nq];
 
 	    lagr = 1.0;
 
@@ -3035,6 +3152,7 @@ assemble_bem3d_lagrange_const_amatrix(const uint * idx, pcavector px,
   freemem(denomx);
   freemem(denomy);
   freemem(denomz);
+  freemem(xbuf);
 }
 
 void
@@ -3043,7 +3161,6 @@ assemble_bem3d_lagrange_linear_amatrix(const uint * idx, pcavector px,
 				       pcbem3d bem, pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const preal gr_g = (const preal) gr->g;
   plistnode *v2t = bem->v2t;
@@ -3051,8 +3168,6 @@ assemble_bem3d_lagrange_linear_amatrix(const uint * idx, pcavector px,
   field    *aa = V->a;
   uint      ld = V->ld;
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
   real      base = bem->sq->base_single;
   field    *quad;
@@ -3062,14 +3177,16 @@ assemble_bem3d_lagrange_linear_amatrix(const uint * idx, pcavector px,
 
   ptri_list tl, tl1;
   pvert_list vl;
-  const real *A, *B, *C;
+  const real *Xq;
+  real     *xbuf;
   uint      tri_sp[3];
   plistnode v;
   uint      s, ss, i, jx, jy, jz, l, k, q, cj, index;
-  real      gs, sum, lagr, x, y, z, tx, sx, Ax, Bx, Cx;
+  real      gs, sum, lagr, x, y, z;
   longindex ii, vv;
 
   quad = allocfield(bem->sq->n_single);
+  xbuf = allocreal(3 * nq);
 
   clear_amatrix(V);
 
@@ -3100,9 +3217,7 @@ assemble_bem3d_lagrange_linear_amatrix(const uint * idx, pcavector px,
   for (s = 0, tl1 = tl; s < cj; s++, tl1 = tl1->next) {
     ss = tl1->t;
     gs = gr_g[ss];
-    A = gr_x[gr_t[ss][0]];
-    B = gr_x[gr_t[ss][1]];
-    C = gr_x[gr_t[ss][2]];
+    Xq = getquadpoints_bem3d(bem, ss, xbuf);
 
     for (i = 0; i < 3; ++i) {
       tri_sp[i] = gr_t[ss][i];
@@ -3115,15 +3230,9 @@ assemble_bem3d_lagrange_linear_amatrix(const uint * idx, pcavector px,
 	for (jz = 0; jz < mz; ++jz) {
 
 	  for (q = 0; q < nq; ++q) {
-	    tx = xx[q];
-	    sx = yy[q];
-	    Ax = 1.0 - tx;
-	    Bx = tx - sx;
-	    Cx = sx;
-
-	    x = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-	    y = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-	    z = A[2] * Ax + B[2] * Bx + C[2] * Cx;
+	    x = Xq[q];
+	    y = Xq[q + nq];
+	    z = Xq[q + 2 * nq];
 
 	    lagr = 1.0;
 
@@ -3183,6 +3292,7 @@ assemble_bem3d_lagrange_linear_amatrix(const uint * idx, pcavector px,
 
   del_tri_list(tl);
   freemem(quad);
+  freemem(xbuf);
 }
 
 void
@@ -3191,25 +3301,24 @@ assemble_bem3d_dn_lagrange_const_amatrix(const uint * idx, pcavector px,
 					 pcbem3d bem, pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const preal gr_g = (const preal) gr->g;
   uint      rows = V->rows;
   uint      ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * nq;
   uint      mx = px->dim;
   uint      my = py->dim;
   uint      mz = pz->dim;
 
-  const real *A, *B, *C, *nt;
+  const real *Xq, *nt;
+  real     *xbuf;
   real      lagr[3];
   uint      t, tt, jx, jy, jz, q, l, index;
-  real      gt, sum, lagrx, lagry, lagrz, x, y, z, tx, sx, Ax, Bx, Cx;
+  real      gt, sum, lagrx, lagry, lagrz, x, y, z;
+
+  xbuf = allocreal(3 * nq);
 
   /*
    * integrate Lagrange polynomials with constant basisfunctions
@@ -3219,9 +3328,7 @@ assemble_bem3d_dn_lagrange_const_amatrix(const uint * idx, pcavector px,
     tt = (idx == NULL ? t : idx[t]);
     gt = gr_g[tt];
     nt = gr_n[tt];
-    A = gr_x[gr_t[tt][0]];
-    B = gr_x[gr_t[tt][1]];
-    C = gr_x[gr_t[tt][2]];
+    Xq = getquadpoints_bem3d(bem, tt, xbuf);
 
     index = 0;
 
@@ -3232,15 +3339,9 @@ assemble_bem3d_dn_lagrange_const_amatrix(const uint * idx, pcavector px,
 	  sum = 0.0;
 
 	  for (q = 0; q < nq; ++q) {
-	    tx = xx[q];
-	    sx = yy[q];
-	    Ax = 1.0 - tx;
-	    Bx = tx - sx;
-	    Cx = sx;
-
-	    x = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-	    y = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-	    z = A[2] * Ax + B[2] * Bx + C[2] * Cx;
+	    x = Xq[q];
+	    y = Xq[q + nq];
+	    z = Xq[q + 2 * nq];
 
 	    lagrx = 1.0;
 	    lagry = 1.0;
@@ -3308,6 +3409,8 @@ assemble_bem3d_dn_lagrange_const_amatrix(const uint * idx, pcavector px,
       }
     }
   }
+
+  freemem(xbuf);
 }
 
 void
@@ -3316,7 +3419,6 @@ assemble_bem3d_dn_lagrange_linear_amatrix(const uint * idx, pcavector px,
 					  pcbem3d bem, pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const preal gr_g = (const preal) gr->g;
@@ -3325,8 +3427,6 @@ assemble_bem3d_dn_lagrange_linear_amatrix(const uint * idx, pcavector px,
   field    *aa = V->a;
   uint      ld = V->ld;
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
   real      base = bem->sq->base_single;
   real     *quad;
@@ -3336,15 +3436,17 @@ assemble_bem3d_dn_lagrange_linear_amatrix(const uint * idx, pcavector px,
 
   ptri_list tl, tl1;
   pvert_list vl;
-  const real *A, *B, *C, *ns;
+  const real *Xq, *ns;
+  real     *xbuf;
   real      lagr[3];
   uint      tri_sp[3];
   plistnode v;
   uint      s, ss, i, jx, jy, jz, l, k, q, cj, index;
-  real      gs, sum, lagrx, lagry, lagrz, x, y, z, tx, sx, Ax, Bx, Cx;
+  real      gs, sum, lagrx, lagry, lagrz, x, y, z;
   longindex ii, vv;
 
   quad = allocfield(bem->sq->n_single);
+  xbuf = allocreal(3 * nq);
 
   clear_amatrix(V);
 
@@ -3376,9 +3478,7 @@ assemble_bem3d_dn_lagrange_linear_amatrix(const uint * idx, pcavector px,
     ss = tl1->t;
     gs = gr_g[ss];
     ns = gr_n[ss];
-    A = gr_x[gr_t[ss][0]];
-    B = gr_x[gr_t[ss][1]];
-    C = gr_x[gr_t[ss][2]];
+    Xq = getquadpoints_bem3d(bem, ss, xbuf);
 
     for (i = 0; i < 3; ++i) {
       tri_sp[i] = gr_t[ss][i];
@@ -3391,15 +3491,9 @@ assemble_bem3d_dn_lagrange_linear_amatrix(const uint * idx, pcavector px,
 	for (jz = 0; jz < mz; ++jz) {
 
 	  for (q = 0; q < nq; ++q) {
-	    tx = xx[q];
-	    sx = yy[q];
-	    Ax = 1.0 - tx;
-	    Bx = tx - sx;
-	    Cx = sx;
-
-	    x = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-	    y = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-	    z = A[2] * Ax + B[2] * Bx + C[2] * Cx;
+	    x = Xq[q];
+	    y = Xq[q + nq];
+	    z = Xq[q + 2 * nq];
 
 	    lagrx = 1.0;
 	    lagry = 1.0;
@@ -3490,54 +3584,48 @@ assemble_bem3d_dn_lagrange_linear_amatrix(const uint * idx, pcavector px,
 
   del_tri_list(tl);
   freemem(quad);
+  freemem(xbuf);
 }
 
 void
 projectl2_bem3d_const_avector(pbem3d bem, boundary_func3d rhs, pavector f)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * nq;
   uint      n = f->dim;
 
-  const real *A, *B, *C, *N;
+  const real *Xq, *N;
+  real     *xbuf;
   real      x[3];
-  real      sum, tx, sx, Ax, Bx, Cx;
+  real      sum;
   uint      t, q;
 
+  xbuf = allocreal(3 * nq);
+
   /*
    *  integrate function with constant basisfunctions
    */
 
   for (t = 0; t < n; ++t) {
-    A = gr_x[gr_t[t][0]];
-    B = gr_x[gr_t[t][1]];
-    C = gr_x[gr_t[t][2]];
+    Xq = getquadpoints_bem3d(bem, t, xbuf);
     N = gr_n[t];
 
     sum = 0.0;
 
     for (q = 0; q < nq; ++q) {
-      tx = xx[q];
-      sx = yy[q];
-      Ax = 1.0 - tx;
-      Bx = tx - sx;
-      Cx = sx;
-
-      x[0] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-      x[1] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-      x[2] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
+      x[0] = Xq[q];
+      x[1] = Xq[q + nq];
+      x[2] = Xq[q + 2 * nq];
 
       sum += ww[q] * rhs(x, N);
     }
 
     f->v[t] = 2.0 * sum;
   }
+
+  freemem(xbuf);
 }
 
 static void
@@ -3577,51 +3665,42 @@ void
 projectl2_bem3d_linear_avector(pbem3d bem, boundary_func3d rhs, pavector f)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const real *gr_g = (const real(*)) gr->g;
   const uint triangles = gr->triangles;
   const uint vertices = gr->vertices;
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
   real      base = bem->sq->base_single;
 
   pavector  v, r, p, a;
-  const real *A, *B, *C, *N;
+  const real *Xq, *N;
+  real     *xbuf;
   field    *quad, sum;
   real      x[3];
   const uint *tri_t;
-  real      tx, sx, Ax, Bx, Cx, gt_fac;
+  real      gt_fac;
   uint      t, q, i;
   longindex ii;
 
   assert(vertices == f->dim);
 
   quad = allocfield(nq);
+  xbuf = allocreal(3 * nq);
   v = new_avector(vertices);
   clear_avector(v);
 
   for (t = 0; t < triangles; t++) {
     tri_t = gr_t[t];
     gt_fac = gr_g[t];
-    A = gr_x[tri_t[0]];
-    B = gr_x[tri_t[1]];
-    C = gr_x[tri_t[2]];
+    Xq = getquadpoints_bem3d(bem, t, xbuf);
     N = gr_n[t];
 
     for (q = 0; q < nq; ++q) {
-      tx = xx[q];
-      sx = yy[q];
-      Ax = 1.0 - tx;
-      Bx = tx - sx;
-      Cx = sx;
-
-      x[0] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-      x[1] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-      x[2] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
+      x[0] = Xq[q];
+      x[1] = Xq[q + nq];
+      x[2] = Xq[q + 2 * nq];
 
       quad[q] = rhs(x, N);
     }
@@ -3660,6 +3739,7 @@ projectl2_bem3d_linear_avector(pbem3d bem, boundary_func3d rhs, pavector f)
   del_avector(a);
   del_avector(v);
   freemem(quad);
+  freemem(xbuf);
 }
 
 prkmatrix
@@ -4101,6 +4181,28 @@ setup_hmatrix_aprx_paca_bem3d(pbem3d bem, pccluster rc, pccluster cc,
   bem->transfer_col = NULL;
 }
 
+void
+setup_hmatrix_aprx_pacaplus_bem3d(pbem3d bem, pccluster rc, pccluster cc,
+				  pcblock tree, real accur)
+{
+
+  (void) rc;
+  (void) cc;
+  (void) tree;
+
+  assert(bem->nearfield != NULL);
+
+  setup_aca_bem3d(bem->aprx, accur);
+
+  bem->farfield_rk = assemble_bem3d_PACAplus_rkmatrix;
+  bem->farfield_u = NULL;
+
+  bem->leaf_row = NULL;
+  bem->leaf_col = NULL;
+  bem->transfer_row = NULL;
+  bem->transfer_col = NULL;
+}
+
 /* ------------------------------------------------------------
  HCA
  ------------------------------------------------------------ */
@@ -4322,6 +4424,107 @@ setup_h2matrix_aprx_greenhybrid_ortho_bem3d(pbem3d bem, pcclusterbasis rb,
   par->gcbnn = n;
 }
 
+/* ------------------------------------------------------------
+ Set up green hybrid clusters before a parallel assembly
+ ------------------------------------------------------------ */
+
+struct _greenprepare {
+  pbem3d    bem;
+  bool     *rneeded;
+  bool     *cneeded;
+};
+
+static void
+mark_greencluster3d(pcblock b, uint bname, uint rname, uint cname,
+		    uint pardepth, void *data)
+{
+  struct _greenprepare *gp = (struct _greenprepare *) data;
+
+  (void) bname;
+  (void) pardepth;
+
+  if (b->a && b->son == NULL) {
+    if (gp->rneeded)
+      gp->rneeded[rname] = true;
+    if (gp->cneeded)
+      gp->cneeded[cname] = true;
+  }
+}
+
+static void
+prepare_row_greencluster3d(pccluster t, uint tname, void *data)
+{
+  struct _greenprepare *gp = (struct _greenprepare *) data;
+  pparbem3d par = gp->bem->par;
+
+  if (gp->rneeded[tname] && par->grcn[tname] == NULL) {
+    par->grcn[tname] = new_greencluster3d(t);
+    assemble_row_greencluster3d(gp->bem, par->grcn[tname]);
+  }
+}
+
+static void
+prepare_col_greencluster3d(pccluster t, uint tname, void *data)
+{
+  struct _greenprepare *gp = (struct _greenprepare *) data;
+  pparbem3d par = gp->bem->par;
+
+  if (gp->cneeded[tname] && par->gccn[tname] == NULL) {
+    par->gccn[tname] = new_greencluster3d(t);
+    assemble_col_greencluster3d(gp->bem, par->gccn[tname]);
+  }
+}
+
+/* The green hybrid approximations of all clusters appearing in
+ * admissible leaves are constructed in a parallel pass through the
+ * cluster trees. Since every cluster is handled by exactly one thread,
+ * no synchronization is required, and the subsequent assembly of the
+ * leaves only reads par->grcn and par->gccn. */
+static void
+prepare_greencluster3d(pbem3d bem, pcblock b)
+{
+  pparbem3d par = bem->par;
+  struct _greenprepare gp;
+  uint      i;
+
+  gp.bem = bem;
+  gp.rneeded = NULL;
+  gp.cneeded = NULL;
+
+  if (bem->farfield_rk == assemble_bem3d_greenhybrid_row_rkmatrix
+      || bem->farfield_rk == assemble_bem3d_greenhybrid_mixed_rkmatrix) {
+    assert(par->grcnn == b->rc->desc);
+    gp.rneeded = (bool *) allocmem((size_t) sizeof(bool) * b->rc->desc);
+    for (i = 0; i < b->rc->desc; i++)
+      gp.rneeded[i] = false;
+  }
+
+  if (bem->farfield_rk == assemble_bem3d_greenhybrid_col_rkmatrix
+      || bem->farfield_rk == assemble_bem3d_greenhybrid_mixed_rkmatrix) {
+    assert(par->gccnn == b->cc->desc);
+    gp.cneeded = (bool *) allocmem((size_t) sizeof(bool) * b->cc->desc);
+    for (i = 0; i < b->cc->desc; i++)
+      gp.cneeded[i] = false;
+  }
+
+  if (gp.rneeded == NULL && gp.cneeded == NULL)
+    return;
+
+  iterate_block(b, 0, 0, 0, mark_greencluster3d, NULL, &gp);
+
+  if (gp.rneeded) {
+    iterate_parallel_cluster(b->rc, 0, max_pardepth,
+			     prepare_row_greencluster3d, NULL, &gp);
+    freemem(gp.rneeded);
+  }
+
+  if (gp.cneeded) {
+    iterate_parallel_cluster(b->cc, 0, max_pardepth,
+			     prepare_col_greencluster3d, NULL, &gp);
+    freemem(gp.cneeded);
+  }
+}
+
 /* ------------------------------------------------------------
  Fill hmatrix
  ------------------------------------------------------------ */
@@ -4379,14 +4582,103 @@ assemblecoarsen_bem3d_block_hmatrix(pcblock b, uint bname,
   }
 }
 
+/* Leaf of the block tree together with an estimate of the work
+ * required to fill it */
+struct _assembleleaf {
+  pcblock   b;
+  uint      bname;
+  uint      rname;
+  uint      cname;
+  size_t    cost;
+};
+
+struct _assemblelist {
+  struct _assembleleaf *leaf;
+  uint      leaves;
+};
+
+static void
+collect_leaf_bem3d(pcblock b, uint bname, uint rname, uint cname,
+		   uint pardepth, void *data)
+{
+  struct _assemblelist *al = (struct _assemblelist *) data;
+  struct _assembleleaf *l;
+  size_t    rows, cols, k;
+
+  (void) pardepth;
+
+  if (b->son == NULL) {
+    rows = b->rc->size;
+    cols = b->cc->size;
+
+    l = al->leaf + al->leaves;
+    al->leaves++;
+
+    l->b = b;
+    l->bname = bname;
+    l->rname = rname;
+    l->cname = cname;
+
+    /* Dense blocks require all entries, approximations roughly one
+     * row and one column per rank, for an unknown rank of at most a
+     * few dozen. Only the order of the estimates matters. */
+    if (b->a) {
+      k = (rows < cols ? rows : cols);
+      l->cost = (rows + cols) * (k < 32 ? k : 32);
+    }
+    else {
+      l->cost = rows * cols;
+    }
+  }
+}
+
+static int
+compare_leaf_bem3d(const void *a, const void *b)
+{
+  const struct _assembleleaf *la = (const struct _assembleleaf *) a;
+  const struct _assembleleaf *lb = (const struct _assembleleaf *) b;
+
+  if (la->cost > lb->cost)
+    return -1;
+  if (la->cost < lb->cost)
+    return 1;
+  return (la->bname < lb->bname ? -1 : la->bname > lb->bname);
+}
+
 void
 assemble_bem3d_hmatrix(pbem3d bem, pblock b, phmatrix G)
 {
   pparbem3d par = bem->par;
+  struct _assemblelist al;
+  struct _assembleleaf *l;
+  int       i;
+
   par->hn = enumerate_hmatrix(b, G);
 
-  iterate_byrow_block(b, 0, 0, 0, max_pardepth, NULL,
-		      assemble_bem3d_block_hmatrix, bem);
+  prepare_greencluster3d(bem, b);
+
+  /* Collect all leaves and handle them in order of decreasing cost,
+   * with threads picking up the next leaf as soon as they are done.
+   * This keeps all threads busy even if the block tree is unbalanced,
+   * and leaves the small blocks for the end. */
+  al.leaf = (struct _assembleleaf *)
+    allocmem(sizeof(struct _assembleleaf) * b->desc);
+  al.leaves = 0;
+  iterate_block(b, 0, 0, 0, collect_leaf_bem3d, NULL, &al);
+
+  qsort(al.leaf, al.leaves, sizeof(struct _assembleleaf),
+	compare_leaf_bem3d);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for if(max_pardepth > 0), schedule(dynamic, 1), private(l)
+#endif
+  for (i = 0; i < (int) al.leaves; i++) {
+    l = al.leaf + i;
+    assemble_bem3d_block_hmatrix(l->b, l->bname, l->rname, l->cname, 0,
+				 bem);
+  }
+
+  freemem(al.leaf);
 
   freemem(par->hn);
   par->hn = NULL;
@@ -4398,6 +4690,8 @@ assemblecoarsen_bem3d_hmatrix(pbem3d bem, pblock b, phmatrix G)
   pparbem3d par = bem->par;
   par->hn = enumerate_hmatrix(b, G);
 
+  prepare_greencluster3d(bem, b);
+
   iterate_byrow_block(b, 0, 0, 0, max_pardepth, NULL,
 		      assemblecoarsen_bem3d_block_hmatrix, bem);
 
@@ -4520,14 +4814,38 @@ assemblehiercomp_bem3d_block_h2matrix(pcblock b, uint bname,
   }
 }
 
+/* Only leaves are filled and they do not depend on each other, so the
+ * blocks of one block row can be handled in any order. */
+static void
+assemble_bem3d_rowlist_h2matrix(pcflatblock fb, uint rname,
+				const uint * blk, uint n, void *data)
+{
+  uint      i, k;
+
+  for (i = 0; i < n; i++) {
+    k = blk[i];
+    assemble_bem3d_block_h2matrix(fb->b[k], fb->bname[k], rname,
+				  fb->cname[k], 0, data);
+  }
+}
+
 void
 assemble_bem3d_h2matrix(pbem3d bem, pblock b, ph2matrix G)
 {
   pparbem3d par = bem->par;
+  pflatblock fb;
+
   par->h2n = enumerate_h2matrix(b, G);
 
-  iterate_byrow_block(b, 0, 0, 0, max_pardepth, NULL,
-		      assemble_bem3d_block_h2matrix, bem);
+  /* Threads work on different row clusters as with
+   * iterate_byrow_block, but share one loop over all block rows
+   * instead of splitting only along the sons of the upper levels. */
+  fb = new_flatblock(b);
+
+  iterate_rowlist_flatblock(fb, max_pardepth,
+			    assemble_bem3d_rowlist_h2matrix, bem);
+
+  del_flatblock(fb);
 
   freemem(par->h2n);
   par->h2n = NULL;
@@ -4558,6 +4876,8 @@ assemblehiercomp_bem3d_h2matrix(pbem3d bem, pblock b, ph2matrix G)
   s = REAL_POW(aprx->tm->zeta_level, getdepth_block(b));
   aprx->accur_hiercomp /= s;
 
+  prepare_greencluster3d(bem, b);
+
   iterate_byrow_block(b, 0, 0, 0, max_pardepth, NULL,
 		      assemblehiercomp_bem3d_block_h2matrix, bem);
 
@@ -297,6 +297,18 @@ struct _bem3d {
    */
   plistnode *v2t;
 
+  /**
+   * @brief Quadrature points of the regular quadrature rule mapped to all
+   * triangles of the geometry.
+   *
+   * If not <tt>NULL</tt>, the <tt>sq->n_single</tt> points of the triangle
+   * @f$ t @f$ start at <tt>quadpoints + 3 * sq->n_single * t</tt>: first all
+   * @f$ x @f$-, then all @f$ y @f$- and finally all @f$ z @f$-coordinates.
+   * The array is filled by @ref setup_quadpoints_bem3d and used by
+   * @ref getquadpoints_bem3d .
+   */
+  real *quadpoints;
+
   /**
    * @brief Computes nearfield entries of Galkerin matrices.
    *
@@ -1015,6 +1027,41 @@ HEADER_PREFIX pbem3d new_bem3d(pcsurface3d gr);
  */
 HEADER_PREFIX void del_bem3d(pbem3d bem);
 
+/**
+ * @brief Precompute the quadrature points of the regular quadrature rule for
+ * all triangles of the geometry.
+ *
+ * The functions computing kernel integrals for interpolation, Green's and
+ * ACA-based approximations as well as the @f$ L^2 @f$-projections map the
+ * reference quadrature points to a triangle every time it is visited.
+ * After this function has been called, the mapped points are taken from
+ * <tt>bem->quadpoints</tt> instead, at the cost of
+ * <tt>3 * bem->sq->n_single * gr->triangles</tt> additional reals.
+ *
+ * Has to be called after the quadrature rules <tt>bem->sq</tt> have been set
+ * up, e.g., after @ref new_slp_laplace_bem3d . The points are released
+ * by @ref del_bem3d .
+ *
+ * @param bem @ref _bem3d "bem3d" object.
+ */
+HEADER_PREFIX void setup_quadpoints_bem3d(pbem3d bem);
+
+/**
+ * @brief Get the quadrature points of the regular quadrature rule mapped to
+ * a triangle.
+ *
+ * @param bem @ref _bem3d "bem3d" object.
+ * @param t Index of the triangle.
+ * @param buf Auxiliary storage for at least <tt>3 * bem->sq->n_single</tt>
+ * reals, only used if the points have not been precomputed by
+ * @ref setup_quadpoints_bem3d .
+ * @return Pointer to the <tt>bem->sq->n_single</tt> @f$ x @f$-coordinates,
+ * followed by the @f$ y @f$- and @f$ z @f$-coordinates of the quadrature
+ * points in the triangle <tt>t</tt>.
+ */
+HEADER_PREFIX const real *getquadpoints_bem3d(pcbem3d bem, uint t,
+    preal buf);
+
 /* ------------------------------------------------------------
  Methods to build clustertrees
  ------------------------------------------------------------ */
@@ -1624,6 +1671,22 @@ HEADER_PREFIX void setup_hmatrix_aprx_aca_bem3d(pbem3d bem, pccluster rc,
 HEADER_PREFIX void setup_hmatrix_aprx_paca_bem3d(pbem3d bem, pccluster rc,
     pccluster cc, pcblock tree, real accur);
 
+/**
+ * @brief Approximate matrix block with ACA using the pivoting strategy ACA+.
+ *
+ * This approximation scheme works like @ref setup_hmatrix_aprx_paca_bem3d ,
+ * but chooses the pivots by @ref decomp_partialacaplus_rkmatrix , i.e., by
+ * means of a reference row and a reference column of the residual.
+ * @param bem All needed callback functions and parameters for this approximation
+ * scheme are set within the bem object.
+ * @param rc Root of the row @ref _cluster "clustertree".
+ * @param cc Root of the column @ref _cluster "clustertree".
+ * @param tree Root of the @ref _block "blocktree".
+ * @param accur Assesses the minimum accuracy for the ACA approximation.
+ */
+HEADER_PREFIX void setup_hmatrix_aprx_pacaplus_bem3d(pbem3d bem, pccluster rc,
+    pccluster cc, pcblock tree, real accur);
+
 /* ------------------------------------------------------------
  HCA
  ------------------------------------------------------------ */
@@ -1939,6 +2002,11 @@ HEADER_PREFIX void setup_h2matrix_aprx_greenhybrid_ortho_bem3d(pbem3d bem,
  * @ref _bem3d "bem3d" object is created as @f$ G_{|t \times s} \approx A_b
  * \, B_b^* @f$
  *
+ * The leaves are filled in order of decreasing estimated cost and
+ * distributed dynamically among the available threads. Every leaf is
+ * still filled by its own call of the approximation technique, there
+ * is no batching of kernel evaluations across leaves.
+ *
  * @attention Before using this function to fill an @ref _hmatrix "hmatrix" one has to
  * initialize the @ref _bem3d "bem3d" object with one of the approximation
  * techniques such as @ref setup_hmatrix_aprx_inter_row_bem3d. Otherwise the
@@ -0,0 +1,904 @@
+/* ------------------------------------------------------------
+   This is the file "binfile.c" of the H2Lib package.
+   All rights reserved, Steffen Boerm 2015
+   ------------------------------------------------------------ */
+
+#include <stdio.h>
+#include <string.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "binfile.h"
+
+#include "basic.h"
+
+/* All arrays in the data area start at multiples of this number
+   of bytes */
+#define BINFILE_ALIGN 64
+
+/* Used to detect files written on machines with a different byte
+   order */
+#define BINFILE_BYTEORDER 0x01020304
+
+/* Contents of a file */
+#define BINFILE_HMATRIX 1
+#define BINFILE_H2MATRIX 2
+
+/* Types of nodes in a matrix tree */
+#define BINFILE_SUPER 0
+#define BINFILE_FARFIELD 1
+#define BINFILE_NEARFIELD 2
+#define BINFILE_ZERO 3
+
+static const char binfile_magic[8] = { 'H', '2', 'L', 'i', 'b', 'B', 'i', 'n' };
+
+/* Header at the start of every file.
+   "rdepth" and "cdepth" are the depths of the row and column cluster
+   trees, they bound the depth of all trees in the file.
+   The file continues with "streamlen" entries of type uint describing
+   all trees in pre-order, followed by the data area starting at
+   byte "dataoff". */
+typedef struct {
+  char      magic[8];
+  uint      version;
+  uint      byteorder;
+  uint      fieldsize;
+  uint      realsize;
+  uint      uintsize;
+  uint      kind;
+  uint      shared;
+  uint      rdepth;
+  uint      cdepth;
+  uint      streamlen;
+  size_t    dataoff;
+  size_t    datasize;
+} binheader;
+
+static    size_t
+align_size(size_t sz)
+{
+  return (sz + BINFILE_ALIGN - 1) / BINFILE_ALIGN * BINFILE_ALIGN;
+}
+
+/* ------------------------------------------------------------
+   Writing
+   ------------------------------------------------------------ */
+
+/* Array that will be written into the data area */
+typedef struct {
+  const char *src;
+  size_t    elsize;
+  uint      rows;
+  uint      cols;
+  size_t    ld;
+} bindata;
+
+typedef struct {
+  uint     *stream;
+  uint      len;
+  uint      maxlen;
+
+  bindata  *data;
+  uint      datas;
+  uint      maxdatas;
+
+  size_t    datasize;
+} binwriter;
+
+static void
+put_uint(binwriter * bw, uint x)
+{
+  uint     *stream;
+  uint      i;
+
+  if (bw->len == bw->maxlen) {
+    bw->maxlen = 2 * bw->maxlen + 64;
+    stream = allocuint(bw->maxlen);
+    for (i = 0; i < bw->len; i++)
+      stream[i] = bw->stream[i];
+    freemem(bw->stream);
+    bw->stream = stream;
+  }
+
+  bw->stream[bw->len++] = x;
+}
+
+static void
+put_size(binwriter * bw, size_t x)
+{
+  put_uint(bw, (uint) (x & 0xffffffff));
+  put_uint(bw, (uint) ((x >> 16) >> 16));
+}
+
+static void
+put_data(binwriter * bw, const void *src, size_t elsize, uint rows,
+	 uint cols, size_t ld)
+{
+  bindata  *data;
+  uint      i;
+
+  if (bw->datas == bw->maxdatas) {
+    bw->maxdatas = 2 * bw->maxdatas + 16;
+    data = (bindata *) allocmem(sizeof(bindata) * bw->maxdatas);
+    for (i = 0; i < bw->datas; i++)
+      data[i] = bw->data[i];
+    freemem(bw->data);
+    bw->data = data;
+  }
+
+  data = bw->data + bw->datas;
+  bw->datas++;
+
+  data->src = (const char *) src;
+  data->elsize = elsize;
+  data->rows = rows;
+  data->cols = cols;
+  data->ld = ld;
+
+  put_size(bw, bw->datasize);
+  bw->datasize += align_size(elsize * rows * cols);
+}
+
+static void
+put_amatrix(binwriter * bw, pcamatrix a)
+{
+  put_uint(bw, a->rows);
+  put_uint(bw, a->cols);
+  put_data(bw, a->a, sizeof(field), a->rows, a->cols, a->ld);
+}
+
+static void
+put_cluster(binwriter * bw, pccluster t, pccluster root)
+{
+  uint      i;
+
+  /* Index sets of all clusters are stored as parts of the root's */
+  assert(t->size == 0 || (t->idx >= root->idx &&
+			  t->idx + t->size <= root->idx + root->size));
+
+  put_uint(bw, t->size);
+  put_uint(bw, (t->size > 0 ? (uint) (t->idx - root->idx) : 0));
+  put_uint(bw, t->sons);
+  put_uint(bw, t->dim);
+  put_uint(bw, t->type);
+  put_data(bw, t->bmin, sizeof(real), t->dim, 1, t->dim);
+  put_data(bw, t->bmax, sizeof(real), t->dim, 1, t->dim);
+
+  for (i = 0; i < t->sons; i++)
+    put_cluster(bw, t->son[i], root);
+}
+
+static void
+put_clustertree(binwriter * bw, pccluster root)
+{
+  put_data(bw, root->idx, sizeof(uint), root->size, 1, root->size);
+  put_cluster(bw, root, root);
+}
+
+static void
+put_hmatrix(binwriter * bw, pchmatrix G)
+{
+  uint      rsons, csons;
+  uint      i, j;
+
+  if (G->son) {
+    rsons = G->rsons;
+    csons = G->csons;
+
+    put_uint(bw, BINFILE_SUPER);
+    put_uint(bw, rsons);
+    put_uint(bw, csons);
+    put_uint(bw, G->son[0]->rc != G->rc);
+    put_uint(bw, G->son[0]->cc != G->cc);
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	put_hmatrix(bw, G->son[i + j * rsons]);
+  }
+  else if (G->r) {
+    put_uint(bw, BINFILE_FARFIELD);
+    put_uint(bw, G->r->k);
+    put_amatrix(bw, &G->r->A);
+    put_amatrix(bw, &G->r->B);
+  }
+  else if (G->f) {
+    put_uint(bw, BINFILE_NEARFIELD);
+    put_amatrix(bw, G->f);
+  }
+  else
+    put_uint(bw, BINFILE_ZERO);
+}
+
+static void
+put_clusterbasis(binwriter * bw, pcclusterbasis cb)
+{
+  uint      i;
+
+  put_uint(bw, cb->k);
+  put_uint(bw, cb->sons);
+  put_amatrix(bw, &cb->V);
+  put_amatrix(bw, &cb->E);
+
+  for (i = 0; i < cb->sons; i++)
+    put_clusterbasis(bw, cb->son[i]);
+}
+
+static void
+put_h2matrix(binwriter * bw, pch2matrix G)
+{
+  uint      rsons, csons;
+  uint      i, j;
+
+  if (G->son) {
+    rsons = G->rsons;
+    csons = G->csons;
+
+    put_uint(bw, BINFILE_SUPER);
+    put_uint(bw, rsons);
+    put_uint(bw, csons);
+    put_uint(bw, G->son[0]->rb->t != G->rb->t);
+    put_uint(bw, G->son[0]->cb->t != G->cb->t);
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	put_h2matrix(bw, G->son[i + j * rsons]);
+  }
+  else if (G->u) {
+    put_uint(bw, BINFILE_FARFIELD);
+    put_amatrix(bw, &G->u->S);
+  }
+  else if (G->f) {
+    put_uint(bw, BINFILE_NEARFIELD);
+    put_amatrix(bw, G->f);
+  }
+  else
+    put_uint(bw, BINFILE_ZERO);
+}
+
+static void
+init_binwriter(binwriter * bw)
+{
+  bw->stream = NULL;
+  bw->len = 0;
+  bw->maxlen = 0;
+
+  bw->data = NULL;
+  bw->datas = 0;
+  bw->maxdatas = 0;
+
+  bw->datasize = 0;
+}
+
+static void
+uninit_binwriter(binwriter * bw)
+{
+  freemem(bw->data);
+  freemem(bw->stream);
+}
+
+static void
+write_padding(FILE * out, size_t sz)
+{
+  static const char zeros[BINFILE_ALIGN] = { 0 };
+
+  assert(sz < BINFILE_ALIGN);
+
+  if (sz > 0)
+    (void) fwrite(zeros, 1, sz, out);
+}
+
+static void
+write_binwriter(const binwriter * bw, uint kind, uint shared,
+		pccluster rc, pccluster cc, const char *filename)
+{
+  binheader hd;
+  const bindata *data;
+  FILE     *out;
+  size_t    sz;
+  uint      i, j;
+
+  memset(&hd, 0, sizeof(binheader));
+  memcpy(hd.magic, binfile_magic, sizeof(hd.magic));
+  hd.version = BINFILE_VERSION;
+  hd.byteorder = BINFILE_BYTEORDER;
+  hd.fieldsize = sizeof(field);
+  hd.realsize = sizeof(real);
+  hd.uintsize = sizeof(uint);
+  hd.kind = kind;
+  hd.shared = shared;
+  hd.rdepth = getdepth_cluster(rc);
+  hd.cdepth = getdepth_cluster(cc);
+  hd.streamlen = bw->len;
+  hd.dataoff = align_size(sizeof(binheader) + sizeof(uint) * bw->len);
+  hd.datasize = bw->datasize;
+
+  assert(hd.rdepth <= BINFILE_MAXDEPTH && hd.cdepth <= BINFILE_MAXDEPTH);
+
+  out = fopen(filename, "wb");
+  assert(out != 0);
+
+  (void) fwrite(&hd, sizeof(binheader), 1, out);
+  (void) fwrite(bw->stream, sizeof(uint), bw->len, out);
+  write_padding(out, hd.dataoff - sizeof(binheader)
+		- sizeof(uint) * bw->len);
+
+  for (i = 0; i < bw->datas; i++) {
+    data = bw->data + i;
+
+    for (j = 0; j < data->cols; j++)
+      (void) fwrite(data->src + data->elsize * data->ld * j, data->elsize,
+		    data->rows, out);
+
+    sz = data->elsize * data->rows * data->cols;
+    write_padding(out, align_size(sz) - sz);
+  }
+
+  fclose(out);
+}
+
+void
+write_binfile_hmatrix(pchmatrix G, const char *filename)
+{
+  binwriter bw;
+  uint      shared;
+
+  init_binwriter(&bw);
+
+  shared = (G->rc == G->cc ? 1 : 0);
+
+  put_clustertree(&bw, G->rc);
+  if (!(shared & 1))
+    put_clustertree(&bw, G->cc);
+
+  put_hmatrix(&bw, G);
+
+  write_binwriter(&bw, BINFILE_HMATRIX, shared, G->rc, G->cc, filename);
+
+  uninit_binwriter(&bw);
+}
+
+void
+write_binfile_h2matrix(pch2matrix G, const char *filename)
+{
+  binwriter bw;
+  uint      shared;
+
+  init_binwriter(&bw);
+
+  shared = (G->rb->t == G->cb->t ? 1 : 0) + (G->rb == G->cb ? 2 : 0);
+
+  put_clustertree(&bw, G->rb->t);
+  if (!(shared & 1))
+    put_clustertree(&bw, G->cb->t);
+
+  put_clusterbasis(&bw, G->rb);
+  if (!(shared & 2))
+    put_clusterbasis(&bw, G->cb);
+
+  put_h2matrix(&bw, G);
+
+  write_binwriter(&bw, BINFILE_H2MATRIX, shared, G->rb->t, G->cb->t,
+		  filename);
+
+  uninit_binwriter(&bw);
+}
+
+/* ------------------------------------------------------------
+   Reading
+   ------------------------------------------------------------ */
+
+/* Every read is checked against the length of the stream and the size
+   of the data area.  The first violation sets "error", from then on
+   all reads return zeros, so that the recursion stops and only valid,
+   if incomplete, objects are constructed. */
+typedef struct {
+  const uint *stream;
+  uint      len;
+  uint      pos;
+
+  char     *data;
+  size_t    datasize;
+
+  bool      error;
+} binreader;
+
+static    uint
+get_uint(binreader * br)
+{
+  if (br->error || br->pos >= br->len) {
+    br->error = true;
+    return 0;
+  }
+
+  return br->stream[br->pos++];
+}
+
+static    size_t
+get_size(binreader * br)
+{
+  size_t    lo, hi;
+
+  lo = get_uint(br);
+  hi = get_uint(br);
+
+  return lo + ((hi << 16) << 16);
+}
+
+/* Number of entries left in the stream, bounds the number of sons */
+static    uint
+remaining_stream(const binreader * br)
+{
+  return (br->error ? 0 : br->len - br->pos);
+}
+
+static void *
+check_data(binreader * br, size_t off, size_t elsize, uint rows, uint cols)
+{
+  if (br->error || off > br->datasize || off % BINFILE_ALIGN != 0
+      || (rows > 0 && cols > 0
+	  && (size_t) rows > (br->datasize - off) / elsize / cols)) {
+    br->error = true;
+    return NULL;
+  }
+
+  return br->data + off;
+}
+
+static void *
+get_data(binreader * br, size_t elsize, uint rows, uint cols)
+{
+  size_t    off;
+
+  off = get_size(br);
+
+  return check_data(br, off, elsize, rows, cols);
+}
+
+static void
+get_amatrix(binreader * br, pamatrix a)
+{
+  pfield    data;
+  uint      rows, cols;
+
+  rows = get_uint(br);
+  cols = get_uint(br);
+  data = (pfield) get_data(br, sizeof(field), rows, cols);
+
+  if (br->error)
+    rows = cols = 0;
+
+  init_pointer_amatrix(a, data, rows, cols);
+}
+
+/* Index sets of sons have to lie within [lo, hi), sons are only allowed
+   up to the given depth */
+static    pcluster
+get_cluster(binreader * br, uint * idx, uint lo, uint hi, uint depth)
+{
+  pcluster  t;
+  preal     bmin, bmax;
+  uint      size, off, sons, dim, type;
+  uint      i;
+
+  size = get_uint(br);
+  off = get_uint(br);
+  sons = get_uint(br);
+  dim = get_uint(br);
+  type = get_uint(br);
+  bmin = (preal) get_data(br, sizeof(real), dim, 1);
+  bmax = (preal) get_data(br, sizeof(real), dim, 1);
+
+  if (size == 0)
+    off = lo;
+  else if (off < lo || off > hi || size > hi - off)
+    br->error = true;
+  if (sons > remaining_stream(br) || (sons > 0 && depth == 0))
+    br->error = true;
+
+  if (br->error) {
+    size = off = sons = dim = 0;
+    lo = hi = 0;
+  }
+
+  t = new_cluster(size, idx + off, sons, dim);
+  t->type = type;
+
+  for (i = 0; i < dim; i++) {
+    t->bmin[i] = bmin[i];
+    t->bmax[i] = bmax[i];
+  }
+
+  for (i = 0; i < sons; i++)
+    t->son[i] = get_cluster(br, idx, off, off + size, depth - 1);
+
+  update_cluster(t);
+
+  return t;
+}
+
+static    pcluster
+get_clustertree(binreader * br, uint depth)
+{
+  uint     *idx;
+  size_t    off;
+  uint      size;
+  uint      i;
+
+  /* The index array precedes the root, whose size determines its
+     length */
+  off = get_size(br);
+  size = (br->pos < br->len ? br->stream[br->pos] : 0);
+  idx = (uint *) check_data(br, off, sizeof(uint), size, 1);
+
+  for (i = 0; !br->error && i < size; i++)
+    if (idx[i] >= size)
+      br->error = true;
+
+  return get_cluster(br, idx, 0, size, depth);
+}
+
+/* Every level of a block tree descends in the row or column cluster
+   tree, so its depth is bounded by the sum of their depths */
+static    phmatrix
+get_hmatrix(binreader * br, pccluster rc, pccluster cc, uint depth)
+{
+  phmatrix  G, G1;
+  pccluster rc1, cc1;
+  uint      rsons, csons, rdesc, cdesc;
+  uint      i, j;
+
+  G = NULL;
+
+  switch (get_uint(br)) {
+  case BINFILE_SUPER:
+    rsons = get_uint(br);
+    csons = get_uint(br);
+    rdesc = get_uint(br);
+    cdesc = get_uint(br);
+
+    if (depth == 0 || rsons == 0 || csons == 0
+	|| rsons > remaining_stream(br)
+	|| csons > remaining_stream(br) / rsons
+	|| (rdesc && rc->sons != rsons) || (cdesc && cc->sons != csons)) {
+      br->error = true;
+      G = new_hmatrix(rc, cc);
+      break;
+    }
+
+    G = new_super_hmatrix(rc, cc, rsons, csons);
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++) {
+	rc1 = (rdesc ? rc->son[i] : rc);
+	cc1 = (cdesc ? cc->son[j] : cc);
+
+	G1 = get_hmatrix(br, rc1, cc1, depth - 1);
+
+	ref_hmatrix(G->son + i + j * rsons, G1);
+      }
+    break;
+
+  case BINFILE_FARFIELD:
+    G = new_hmatrix(rc, cc);
+    G->r = (prkmatrix) allocmem(sizeof(rkmatrix));
+    G->r->k = get_uint(br);
+    get_amatrix(br, &G->r->A);
+    get_amatrix(br, &G->r->B);
+    if (G->r->A.rows != rc->size || G->r->A.cols != G->r->k
+	|| G->r->B.rows != cc->size || G->r->B.cols != G->r->k)
+      br->error = true;
+    break;
+
+  case BINFILE_NEARFIELD:
+    G = new_hmatrix(rc, cc);
+    G->f = (pamatrix) allocmem(sizeof(amatrix));
+    get_amatrix(br, G->f);
+    if (G->f->rows != rc->size || G->f->cols != cc->size)
+      br->error = true;
+    break;
+
+  case BINFILE_ZERO:
+    G = new_hmatrix(rc, cc);
+    break;
+
+  default:
+    br->error = true;
+    G = new_hmatrix(rc, cc);
+  }
+
+  update_hmatrix(G);
+
+  return G;
+}
+
+static    pclusterbasis
+get_clusterbasis(binreader * br, pccluster t)
+{
+  pclusterbasis cb, cb1;
+  uint      k, sons;
+  uint      i;
+
+  k = get_uint(br);
+  sons = get_uint(br);
+
+  if (sons > 0 && sons != t->sons) {
+    br->error = true;
+    sons = 0;
+  }
+
+  if (sons > 0)
+    cb = new_clusterbasis(t);
+  else
+    cb = new_leaf_clusterbasis(t);
+
+  cb->k = k;
+
+  uninit_amatrix(&cb->V);
+  get_amatrix(br, &cb->V);
+
+  uninit_amatrix(&cb->E);
+  get_amatrix(br, &cb->E);
+
+  /* Leaves need t->size x k bases, inner nodes may omit them */
+  if (!((cb->V.rows == t->size && cb->V.cols == k)
+	|| (sons > 0 && cb->V.rows == 0 && cb->V.cols == 0)))
+    br->error = true;
+
+  for (i = 0; i < sons; i++) {
+    cb1 = get_clusterbasis(br, t->son[i]);
+    ref_clusterbasis(cb->son + i, cb1);
+
+    if (cb1->E.rows != cb1->k || cb1->E.cols != k)
+      br->error = true;
+  }
+
+  update_clusterbasis(cb);
+
+  return cb;
+}
+
+static    ph2matrix
+get_h2matrix(binreader * br, pclusterbasis rb, pclusterbasis cb, uint depth)
+{
+  ph2matrix G, G1;
+  pclusterbasis rb1, cb1;
+  uint      rsons, csons, rdesc, cdesc;
+  uint      i, j;
+
+  G = NULL;
+
+  switch (get_uint(br)) {
+  case BINFILE_SUPER:
+    rsons = get_uint(br);
+    csons = get_uint(br);
+    rdesc = get_uint(br);
+    cdesc = get_uint(br);
+
+    if (depth == 0 || rsons == 0 || csons == 0
+	|| rsons > remaining_stream(br)
+	|| csons > remaining_stream(br) / rsons
+	|| (rdesc && rb->sons != rsons) || (cdesc && cb->sons != csons)) {
+      br->error = true;
+      G = new_h2matrix(rb, cb);
+      break;
+    }
+
+    G = new_super_h2matrix(rb, cb, rsons, csons);
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++) {
+	rb1 = (rdesc ? rb->son[i] : rb);
+	cb1 = (cdesc ? cb->son[j] : cb);
+
+	G1 = get_h2matrix(br, rb1, cb1, depth - 1);
+
+	ref_h2matrix(G->son + i + j * rsons, G1);
+      }
+    break;
+
+  case BINFILE_FARFIELD:
+    G = new_h2matrix(rb, cb);
+    G->u = new_uniform(rb, cb);
+    uninit_amatrix(&G->u->S);
+    get_amatrix(br, &G->u->S);
+    if (G->u->S.rows != rb->k || G->u->S.cols != cb->k)
+      br->error = true;
+    break;
+
+  case BINFILE_NEARFIELD:
+    G = new_h2matrix(rb, cb);
+    G->f = (pamatrix) allocmem(sizeof(amatrix));
+    get_amatrix(br, G->f);
+    if (G->f->rows != rb->t->size || G->f->cols != cb->t->size)
+      br->error = true;
+    break;
+
+  case BINFILE_ZERO:
+    G = new_h2matrix(rb, cb);
+    break;
+
+  default:
+    br->error = true;
+    G = new_h2matrix(rb, cb);
+  }
+
+  update_h2matrix(G);
+
+  return G;
+}
+
+static void
+release_map(void *map, size_t size)
+{
+#ifdef WIN32
+  (void) size;
+
+  freemem(map);
+#else
+  (void) munmap(map, size);
+#endif
+}
+
+pbinfile
+read_binfile(const char *filename)
+{
+  pbinfile  bf;
+  binreader br;
+  const binheader *hd;
+  void     *map;
+  size_t    size;
+#ifdef WIN32
+  FILE     *in;
+#else
+  struct stat st;
+  int       fd;
+#endif
+
+  /* Map the file into memory */
+#ifdef WIN32
+  in = fopen(filename, "rb");
+  if (in == NULL) {
+    (void) fprintf(stderr, "Could not open \"%s\"\n", filename);
+    return NULL;
+  }
+  (void) fseek(in, 0, SEEK_END);
+  size = ftell(in);
+  (void) fseek(in, 0, SEEK_SET);
+  map = allocmem(size);
+  if (fread(map, 1, size, in) != size) {
+    (void) fprintf(stderr, "Could not read \"%s\"\n", filename);
+    freemem(map);
+    fclose(in);
+    return NULL;
+  }
+  fclose(in);
+#else
+  fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    (void) fprintf(stderr, "Could not open \"%s\"\n", filename);
+    return NULL;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    (void) fprintf(stderr, "Could not read \"%s\"\n", filename);
+    close(fd);
+    return NULL;
+  }
+  size = st.st_size;
+
+  /* Private mapping: pages are shared until they are changed */
+  map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    (void) fprintf(stderr, "Could not map \"%s\"\n", filename);
+    return NULL;
+  }
+#endif
+
+  /* Check the header */
+  hd = (const binheader *) map;
+  if (size < sizeof(binheader)
+      || memcmp(hd->magic, binfile_magic, sizeof(hd->magic)) != 0) {
+    (void) fprintf(stderr, "\"%s\" is not an H2Lib binary file\n",
+		   filename);
+    release_map(map, size);
+    return NULL;
+  }
+  if (hd->version != BINFILE_VERSION) {
+    (void) fprintf(stderr, "\"%s\" has version %u, expected %u\n",
+		   filename, hd->version, BINFILE_VERSION);
+    release_map(map, size);
+    return NULL;
+  }
+  if (hd->byteorder != BINFILE_BYTEORDER || hd->fieldsize != sizeof(field)
+      || hd->realsize != sizeof(real) || hd->uintsize != sizeof(uint)) {
+    (void) fprintf(stderr, "\"%s\" uses an incompatible number format\n",
+		   filename);
+    release_map(map, size);
+    return NULL;
+  }
+  if (hd->kind != BINFILE_HMATRIX && hd->kind != BINFILE_H2MATRIX) {
+    (void) fprintf(stderr, "\"%s\" has unknown contents\n", filename);
+    release_map(map, size);
+    return NULL;
+  }
+  /* Written without sums that could overflow */
+  if (hd->streamlen > (size - sizeof(binheader)) / sizeof(uint)
+      || hd->dataoff < sizeof(binheader) + sizeof(uint) * hd->streamlen
+      || hd->dataoff > size || hd->datasize > size - hd->dataoff) {
+    (void) fprintf(stderr, "\"%s\" is truncated\n", filename);
+    release_map(map, size);
+    return NULL;
+  }
+  if (hd->dataoff % BINFILE_ALIGN != 0 || hd->rdepth > BINFILE_MAXDEPTH
+      || hd->cdepth > BINFILE_MAXDEPTH) {
+    (void) fprintf(stderr, "\"%s\" is corrupt\n", filename);
+    release_map(map, size);
+    return NULL;
+  }
+
+  br.stream = (const uint *) ((const char *) map + sizeof(binheader));
+  br.len = hd->streamlen;
+  br.pos = 0;
+  br.data = (char *) map + hd->dataoff;
+  br.datasize = hd->datasize;
+  br.error = false;
+
+  /* Reconstruct the objects */
+  bf = (pbinfile) allocmem(sizeof(binfile));
+  bf->map = map;
+  bf->size = size;
+  bf->hm = NULL;
+  bf->rb = NULL;
+  bf->cb = NULL;
+  bf->h2 = NULL;
+
+  bf->rc = get_clustertree(&br, hd->rdepth);
+  bf->cc = (hd->shared & 1 ? bf->rc : get_clustertree(&br, hd->cdepth));
+
+  switch (hd->kind) {
+  case BINFILE_HMATRIX:
+    bf->hm = get_hmatrix(&br, bf->rc, bf->cc, hd->rdepth + hd->cdepth);
+    break;
+
+  case BINFILE_H2MATRIX:
+    ref_clusterbasis(&bf->rb, get_clusterbasis(&br, bf->rc));
+    ref_clusterbasis(&bf->cb, (hd->shared & 2 ? bf->rb :
+			       get_clusterbasis(&br, bf->cc)));
+    bf->h2 = get_h2matrix(&br, bf->rb, bf->cb, hd->rdepth + hd->cdepth);
+    break;
+  }
+
+  if (br.error || br.pos != br.len) {
+    (void) fprintf(stderr, "\"%s\" is corrupt\n", filename);
+    del_binfile(bf);
+    return NULL;
+  }
+
+  return bf;
+}
+
+void
+del_binfile(pbinfile bf)
+{
+  if (bf->h2)
+    del_h2matrix(bf->h2);
+  if (bf->cb)
+    unref_clusterbasis(bf->cb);
+  if (bf->rb)
+    unref_clusterbasis(bf->rb);
+
+  if (bf->hm)
+    del_hmatrix(bf->hm);
+
+  if (bf->cc != bf->rc)
+    del_cluster(bf->cc);
+  del_cluster(bf->rc);
+
+  release_map(bf->map, bf->size);
+
+  freemem(bf);
+}
@@ -0,0 +1,138 @@
+
+/* ------------------------------------------------------------
+   This is the file "binfile.h" of the H2Lib package.
+   All rights reserved, Steffen Boerm 2015
+   ------------------------------------------------------------ */
+
+/** @file binfile.h
+ *  @author Steffen B&ouml;rm
+ */
+
+#ifndef BINFILE_H
+#define BINFILE_H
+
+/** @defgroup binfile binfile
+ *  @brief Binary files containing hierarchical matrices.
+ *
+ *  A binary file contains the cluster trees, the block structure,
+ *  the cluster bases and the coefficients of an @ref hmatrix or
+ *  @ref h2matrix in the native number format of the machine.
+ *
+ *  The file starts with a versioned header, followed by a description
+ *  of all trees and finally by a data area containing all coefficient
+ *  arrays and index sets, each aligned to a multiple of 64 bytes.
+ *  When a file is read, it is mapped into memory, and the coefficients
+ *  and index sets of the reconstructed objects point directly into
+ *  the mapped data area, so no coefficients are copied.
+ *  @{ */
+
+/** @brief Binary file opened for reading. */
+typedef struct _binfile binfile;
+
+/** @brief Pointer to a @ref binfile object. */
+typedef binfile *pbinfile;
+
+/** @brief Pointer to a constant @ref binfile object. */
+typedef const binfile *pcbinfile;
+
+#include "hmatrix.h"
+#include "h2matrix.h"
+#include "settings.h"
+
+/** @brief Version of the binary file format. */
+#define BINFILE_VERSION 2
+
+/** @brief Maximal depth of the cluster trees in a binary file.
+ *
+ *  Deeper trees are neither written nor read, so that reading
+ *  a corrupt file cannot exhaust the stack. */
+#define BINFILE_MAXDEPTH 1024
+
+/** @brief Binary file opened for reading.
+ *
+ *  Depending on the contents of the file, either <tt>hm</tt> or
+ *  <tt>h2</tt> is set, the other pointer is <tt>NULL</tt>.
+ *
+ *  @attention The coefficients of all matrices and the index sets of
+ *  all clusters are part of the mapped file, so the matrices must not
+ *  be resized, and all objects are only valid until the file is
+ *  released by @ref del_binfile. */
+struct _binfile {
+  /** @brief Contents of the file. */
+  void *map;
+  /** @brief Size of the file in bytes. */
+  size_t size;
+
+  /** @brief Root of the row cluster tree. */
+  pcluster rc;
+  /** @brief Root of the column cluster tree, may be identical to
+   *  <tt>rc</tt>. */
+  pcluster cc;
+
+  /** @brief Hierarchical matrix, if the file contains one. */
+  phmatrix hm;
+
+  /** @brief Row cluster basis, if the file contains an
+   *  @f$\mathcal{H}^2@f$-matrix. */
+  pclusterbasis rb;
+  /** @brief Column cluster basis, if the file contains an
+   *  @f$\mathcal{H}^2@f$-matrix. May be identical to <tt>rb</tt>. */
+  pclusterbasis cb;
+  /** @brief @f$\mathcal{H}^2@f$-matrix, if the file contains one. */
+  ph2matrix h2;
+};
+
+/* ------------------------------------------------------------
+   Writing
+   ------------------------------------------------------------ */
+
+/** @brief Write an @ref hmatrix together with its cluster trees into
+ *  a binary file.
+ *
+ *  The index sets of all clusters have to be parts of the index set
+ *  of the root, as they are for trees created by the functions in
+ *  @ref clustergeometry, and the cluster trees must not be deeper than
+ *  @ref BINFILE_MAXDEPTH.
+ *
+ *  @param G Hierarchical matrix.
+ *  @param filename Name of the target file. */
+HEADER_PREFIX void
+write_binfile_hmatrix(pchmatrix G, const char *filename);
+
+/** @brief Write an @ref h2matrix together with its cluster trees and
+ *  cluster bases into a binary file.
+ *
+ *  The cluster trees must not be deeper than @ref BINFILE_MAXDEPTH.
+ *
+ *  @param G @f$\mathcal{H}^2@f$-matrix.
+ *  @param filename Name of the target file. */
+HEADER_PREFIX void
+write_binfile_h2matrix(pch2matrix G, const char *filename);
+
+/* ------------------------------------------------------------
+   Reading
+   ------------------------------------------------------------ */
+
+/** @brief Map a binary file into memory and reconstruct the objects
+ *  it contains.
+ *
+ *  @remark Should always be matched by a call to @ref del_binfile.
+ *
+ *  @param filename Name of the source file.
+ *  @returns New @ref binfile object, or <tt>NULL</tt> if the file
+ *  could not be read, was written with an incompatible version,
+ *  number format or byte order, contains trees deeper than
+ *  @ref BINFILE_MAXDEPTH, or is truncated or corrupt. */
+HEADER_PREFIX pbinfile
+read_binfile(const char *filename);
+
+/** @brief Delete all objects reconstructed from a binary file and
+ *  release the file.
+ *
+ *  @param bf Object to be deleted. */
+HEADER_PREFIX void
+del_binfile(pbinfile bf);
+
+/** @} */
+
+#endif
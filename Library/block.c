@@ -143,6 +143,7 @@ new_block(pcluster rc, pcluster cc, bool a, uint rsons, uint csons)
   b->rsons = rsons;
   b->csons = csons;
   b->son = NULL;
+  b->arena = NULL;
   if (rsons > 0 && csons > 0)
     b->son = (pblock *) allocmem((size_t) rsons * csons * sizeof(pblock));
   for (i = 0; i < rsons * csons; i++) {
@@ -152,16 +153,51 @@ new_block(pcluster rc, pcluster cc, bool a, uint rsons, uint csons)
   return b;
 }
 
+/* Blocks taken from an arena always get their son array from the
+   same arena, so del_block does not have to search its chunks */
+static    pblock
+new_arena_block(parena pa, pcluster rc, pcluster cc, bool a, uint rsons,
+		uint csons)
+{
+  pblock    b;
+
+  uint      i;
+
+  b = (pblock) allocarena(pa, sizeof(block));
+  b->rc = rc;
+  b->cc = cc;
+  b->a = a;
+  b->rsons = rsons;
+  b->csons = csons;
+  b->son = NULL;
+  b->arena = NULL;
+  ref_arena(&b->arena, pa);
+  if (rsons > 0 && csons > 0)
+    b->son = (pblock *) allocarena(pa, (size_t) rsons * csons *
+				   sizeof(pblock));
+  for (i = 0; i < rsons * csons; i++) {
+    b->son[i] = NULL;
+  }
+
+  return b;
+}
+
 void
 del_block(pblock b)
 {
+  parena    pa = b->arena;
   uint      i, j;
 
   for (j = 0; j < b->csons; j++)
     for (i = 0; i < b->rsons; i++)
       del_block(b->son[i + j * b->rsons]);
-  freemem(b->son);
-  freemem(b);
+
+  if (pa)
+    unref_arena(pa);
+  else {
+    freemem(b->son);
+    freemem(b);
+  }
 }
 
 /* ------------------------------------------------------------
@@ -296,6 +332,252 @@ build_strict_block(pcluster rc, pcluster cc, void *eta, admissible admis)
   return b;
 }
 
+/* ------------------------------------------------------------
+ Parallel block clustering
+ ------------------------------------------------------------ */
+
+/* auxiliary structure, cluster tree with cached geometric quantities */
+typedef struct _blockcluster blockcluster;
+
+struct _blockcluster {
+  /* cluster */
+  pcluster  t;
+
+  /* squared Euclidean diameter of the bounding box */
+  real      diam2;
+
+  /* Euclidean diameter of the bounding box */
+  real      diam;
+
+  /* maximum diameter of the bounding box */
+  real      diammax;
+
+  /* bmin + bmax, i.e., twice the center of the bounding box */
+  real     *ctr;
+
+  /* sons */
+  blockcluster *son;
+};
+
+static void
+init_blockcluster(blockcluster * bc, pcluster t, parena pa)
+{
+  real      a;
+  uint      i;
+
+  bc->t = t;
+  bc->ctr = (real *) allocarena(pa, (size_t) sizeof(real) * t->dim);
+
+  bc->diam2 = 0.0;
+  for (i = 0; i < t->dim; i++) {
+    a = t->bmax[i] - t->bmin[i];
+    bc->diam2 += a * a;
+    bc->ctr[i] = t->bmin[i] + t->bmax[i];
+  }
+  bc->diam = getdiam_2_cluster(t);
+  bc->diammax = getdiam_max_cluster(t);
+
+  bc->son = NULL;
+  if (t->sons > 0) {
+    bc->son = (blockcluster *) allocarena(pa, (size_t) t->sons *
+					  sizeof(blockcluster));
+    for (i = 0; i < t->sons; i++)
+      init_blockcluster(bc->son + i, t->son[i], pa);
+  }
+}
+
+/* the cached tree lives in a single arena of sufficient size */
+static    blockcluster *
+new_blockcluster(pcluster t, parena * pa)
+{
+  blockcluster *bc;
+
+  *pa = new_arena((size_t) (t->desc + 1) *
+		  (sizeof(blockcluster) + sizeof(real) * t->dim + 32));
+
+  bc = (blockcluster *) allocarena(*pa, sizeof(blockcluster));
+  init_blockcluster(bc, t, *pa);
+
+  return bc;
+}
+
+/* chunk size for the arena of a sequentially constructed subtree,
+   proportional to the number of clusters involved, so that small
+   subtrees do not claim large chunks */
+static    size_t
+chunksize_block(pccluster rc, pccluster cc)
+{
+  size_t    sz;
+
+  sz = (size_t) 4 * (rc->desc + cc->desc) *
+    (sizeof(block) + sizeof(pblock) + 32);
+
+  return (sz < 4096 ? 4096 : (sz > 1048576 ? 1048576 : sz));
+}
+
+/* evaluate the admissibility condition using cached diameters and
+   centers for the standard conditions, the result coincides with the
+   one of the admissibility condition itself */
+static    bool
+admissible_blockcluster(const blockcluster * rc, const blockcluster * cc,
+			void *data, admissible admis)
+{
+  real      eta, dist, a;
+  uint      i;
+
+  if (admis == admissible_2_cluster) {
+    eta = *(real *) data;
+
+    dist = 0.0;
+    for (i = 0; i < rc->t->dim; i++) {
+      a = REAL_MAX3(0.0, rc->t->bmin[i] - cc->t->bmax[i],
+		    cc->t->bmin[i] - rc->t->bmax[i]);
+      dist += a * a;
+    }
+
+    return (REAL_MAX(rc->diam2, cc->diam2) < eta * eta * dist);
+  }
+  else if (admis == admissible_max_cluster) {
+    eta = *(real *) data;
+
+    dist = getdist_max_cluster(rc->t, cc->t);
+
+    return (REAL_MAX(rc->diammax, cc->diammax) <= eta * dist);
+  }
+  else if (admis == admissible_sphere_cluster) {
+    eta = *(real *) data;
+
+    dist = 0.0;
+    for (i = 0; i < rc->t->dim; i++)
+      dist += REAL_SQR(0.5 * (rc->ctr[i] - cc->ctr[i]));
+    dist = REAL_SQRT(dist) - 0.5 * (rc->diam + cc->diam);
+
+    return (REAL_MAX(rc->diam, cc->diam) <= eta * dist);
+  }
+
+  return admis(rc->t, cc->t, data);
+}
+
+static    pblock
+build_parallel_blockcluster(const blockcluster * rc,
+			    const blockcluster * cc, void *data,
+			    admissible admis, bool strict, uint pardepth,
+			    parena pa)
+{
+  pblock    b;
+
+  bool      a;
+  uint      rsons, csons;
+  uint      i, j;
+
+  a = admissible_blockcluster(rc, cc, data, admis);
+
+  rsons = 0;
+  csons = 0;
+  if (a == false) {
+    if (strict) {
+      /* subdivide until both clusters are leaves */
+      if (rc->t->sons > 0 || cc->t->sons > 0) {
+	rsons = (rc->t->sons > 0 ? rc->t->sons : 1);
+	csons = (cc->t->sons > 0 ? cc->t->sons : 1);
+      }
+    }
+    else if (rc->t->sons * cc->t->sons > 0) {
+      /* subdivide until one cluster is a leaf */
+      rsons = rc->t->sons;
+      csons = cc->t->sons;
+    }
+  }
+
+  if (pardepth > 0) {
+    /* blocks shared by several tasks are allocated individually */
+    b = new_block(rc->t, cc->t, a, rsons, csons);
+
+#ifdef USE_OPENMP
+    for (j = 0; j < csons; j++) {
+      for (i = 0; i < rsons; i++) {
+#pragma omp task firstprivate(i, j)
+	b->son[i + j * rsons] =
+	  build_parallel_blockcluster((rc->t->sons > 0 ? rc->son + i : rc),
+				      (cc->t->sons > 0 ? cc->son + j : cc),
+				      data, admis, strict, pardepth - 1,
+				      NULL);
+      }
+    }
+#pragma omp taskwait
+#else
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	b->son[i + j * rsons] =
+	  build_parallel_blockcluster((rc->t->sons > 0 ? rc->son + i : rc),
+				      (cc->t->sons > 0 ? cc->son + j : cc),
+				      data, admis, strict, pardepth - 1,
+				      NULL);
+#endif
+  }
+  else {
+    /* every sequential subtree gets an arena of its own, so that no
+       arena is ever used by two threads */
+    if (pa == NULL)
+      pa = new_arena(chunksize_block(rc->t, cc->t));
+
+    b = new_arena_block(pa, rc->t, cc->t, a, rsons, csons);
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	b->son[i + j * rsons] =
+	  build_parallel_blockcluster((rc->t->sons > 0 ? rc->son + i : rc),
+				      (cc->t->sons > 0 ? cc->son + j : cc),
+				      data, admis, strict, 0, pa);
+  }
+
+  update_block(b);
+
+  return b;
+}
+
+static    pblock
+build_parallel_block(pcluster rc, pcluster cc, void *data, admissible admis,
+		     bool strict, uint pardepth)
+{
+  blockcluster *rbc, *cbc;
+  parena    rpa, cpa;
+  pblock    b;
+
+  rbc = new_blockcluster(rc, &rpa);
+  cbc = rbc;
+  cpa = NULL;
+  if (cc != rc)
+    cbc = new_blockcluster(cc, &cpa);
+
+#ifdef USE_OPENMP
+#pragma omp parallel if(pardepth > 0)
+#pragma omp single
+#endif
+  b = build_parallel_blockcluster(rbc, cbc, data, admis, strict, pardepth,
+				  NULL);
+
+  if (cpa)
+    del_arena(cpa);
+  del_arena(rpa);
+
+  return b;
+}
+
+pblock
+build_parallel_nonstrict_block(pcluster rc, pcluster cc, void *data,
+			       admissible admis, uint pardepth)
+{
+  return build_parallel_block(rc, cc, data, admis, false, pardepth);
+}
+
+pblock
+build_parallel_strict_block(pcluster rc, pcluster cc, void *data,
+			    admissible admis, uint pardepth)
+{
+  return build_parallel_block(rc, cc, data, admis, true, pardepth);
+}
+
 /* ------------------------------------------------------------
  Drawing block cluster trees
  ------------------------------------------------------------ */
@@ -1126,6 +1408,199 @@ iterate_bycol_block(pcblock b, uint bname, uint rname, uint cname,
   del_blockentry(pb);
 }
 
+/* ------------------------------------------------------------
+ Flat level-wise representation
+ ------------------------------------------------------------ */
+
+pflatblock
+new_flatblock(pblock b)
+{
+  pflatblock fb;
+  pblock    b1;
+  uint      n, k, l, m, i, j;
+  uint      bname1, rname1, cname1;
+  uint     *pos;
+
+  n = b->desc;
+
+  fb = (pflatblock) allocmem((size_t) sizeof(flatblock));
+  fb->blocks = n;
+  fb->b = (pblock *) allocmem((size_t) sizeof(pblock) * n);
+  fb->rc = (pcluster *) allocmem((size_t) sizeof(pcluster) * n);
+  fb->cc = (pcluster *) allocmem((size_t) sizeof(pcluster) * n);
+  fb->a = (bool *) allocmem((size_t) sizeof(bool) * n);
+  fb->bname = allocuint(n);
+  fb->rname = allocuint(n);
+  fb->cname = allocuint(n);
+  fb->father = allocuint(n);
+  fb->sonstart = allocuint(n);
+  fb->levelstart = allocuint(getdepth_block(b) + 1);
+
+  /* breadth-first search, the sons of each block are appended to the
+     array, so the blocks of each level form a contiguous range */
+  fb->b[0] = b;
+  fb->bname[0] = 0;
+  fb->rname[0] = 0;
+  fb->cname[0] = 0;
+  fb->father[0] = 0;
+  fb->levelstart[0] = 0;
+  fb->depth = 0;
+  l = 1;
+  m = 1;
+  for (k = 0; k < n; k++) {
+    /* the first block of the next level has been reached */
+    if (k == l) {
+      fb->depth++;
+      fb->levelstart[fb->depth] = k;
+      l = m;
+    }
+
+    b1 = fb->b[k];
+    fb->rc[k] = b1->rc;
+    fb->cc[k] = b1->cc;
+    fb->a[k] = b1->a;
+    fb->sonstart[k] = m;
+
+    if (b1->son) {
+      bname1 = fb->bname[k] + 1;
+      cname1 = (b1->son[0]->cc == b1->cc ? fb->cname[k] : fb->cname[k] + 1);
+      for (j = 0; j < b1->csons; j++) {
+	rname1 =
+	  (b1->son[0]->rc == b1->rc ? fb->rname[k] : fb->rname[k] + 1);
+	for (i = 0; i < b1->rsons; i++) {
+	  fb->b[m] = b1->son[i + j * b1->rsons];
+	  fb->bname[m] = bname1;
+	  fb->rname[m] = rname1;
+	  fb->cname[m] = cname1;
+	  fb->father[m] = k;
+	  m++;
+
+	  bname1 += b1->son[i + j * b1->rsons]->desc;
+	  rname1 += b1->son[i + j * b1->rsons]->rc->desc;
+	}
+	cname1 += b1->son[j * b1->rsons]->cc->desc;
+      }
+      assert(bname1 == fb->bname[k] + b1->desc);
+    }
+  }
+  assert(m == n);
+  fb->depth++;
+  fb->levelstart[fb->depth] = n;
+
+  /* block rows, sorted by level within each row */
+  fb->rclusters = b->rc->desc;
+  fb->rowstart = allocuint(fb->rclusters + 1);
+  fb->rowblock = allocuint(n);
+  pos = allocuint(UINT_MAX(fb->rclusters, b->cc->desc) + 1);
+
+  for (i = 0; i <= fb->rclusters; i++)
+    fb->rowstart[i] = 0;
+  for (k = 0; k < n; k++)
+    fb->rowstart[fb->rname[k] + 1]++;
+  for (i = 0; i < fb->rclusters; i++) {
+    fb->rowstart[i + 1] += fb->rowstart[i];
+    pos[i] = fb->rowstart[i];
+  }
+  for (k = 0; k < n; k++)
+    fb->rowblock[pos[fb->rname[k]]++] = k;
+
+  /* block columns, sorted by level within each column */
+  fb->cclusters = b->cc->desc;
+  fb->colstart = allocuint(fb->cclusters + 1);
+  fb->colblock = allocuint(n);
+
+  for (j = 0; j <= fb->cclusters; j++)
+    fb->colstart[j] = 0;
+  for (k = 0; k < n; k++)
+    fb->colstart[fb->cname[k] + 1]++;
+  for (j = 0; j < fb->cclusters; j++) {
+    fb->colstart[j + 1] += fb->colstart[j];
+    pos[j] = fb->colstart[j];
+  }
+  for (k = 0; k < n; k++)
+    fb->colblock[pos[fb->cname[k]]++] = k;
+
+  freemem(pos);
+
+  return fb;
+}
+
+void
+del_flatblock(pflatblock fb)
+{
+  freemem(fb->colblock);
+  freemem(fb->colstart);
+  freemem(fb->rowblock);
+  freemem(fb->rowstart);
+  freemem(fb->levelstart);
+  freemem(fb->sonstart);
+  freemem(fb->father);
+  freemem(fb->cname);
+  freemem(fb->rname);
+  freemem(fb->bname);
+  freemem(fb->a);
+  freemem(fb->cc);
+  freemem(fb->rc);
+  freemem(fb->b);
+  freemem(fb);
+}
+
+void
+iterate_level_flatblock(pcflatblock fb, uint level, uint pardepth,
+			void (*func) (pcflatblock fb, uint k, void *data),
+			void *data)
+{
+  uint      k;
+
+  assert(level < fb->depth);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for if(pardepth > 0), schedule(dynamic, 16)
+#else
+  (void) pardepth;
+#endif
+  for (k = fb->levelstart[level]; k < fb->levelstart[level + 1]; k++)
+    func(fb, k, data);
+}
+
+void
+iterate_rowlist_flatblock(pcflatblock fb, uint pardepth,
+			  void (*func) (pcflatblock fb, uint rname,
+					const uint * blk, uint n,
+					void *data), void *data)
+{
+  uint      i;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for if(pardepth > 0), schedule(dynamic, 16)
+#else
+  (void) pardepth;
+#endif
+  for (i = 0; i < fb->rclusters; i++)
+    if (fb->rowstart[i + 1] > fb->rowstart[i])
+      func(fb, i, fb->rowblock + fb->rowstart[i],
+	   fb->rowstart[i + 1] - fb->rowstart[i], data);
+}
+
+void
+iterate_collist_flatblock(pcflatblock fb, uint pardepth,
+			  void (*func) (pcflatblock fb, uint cname,
+					const uint * blk, uint n,
+					void *data), void *data)
+{
+  uint      j;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for if(pardepth > 0), schedule(dynamic, 16)
+#else
+  (void) pardepth;
+#endif
+  for (j = 0; j < fb->cclusters; j++)
+    if (fb->colstart[j + 1] > fb->colstart[j])
+      func(fb, j, fb->colblock + fb->colstart[j],
+	   fb->colstart[j + 1] - fb->colstart[j], data);
+}
+
 /* ------------------------------------------------------------
  Enumeration
  ------------------------------------------------------------ */
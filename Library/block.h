@@ -65,6 +65,9 @@ struct _block {
 
   /** @brief Number of descendants.*/
   uint desc;
+
+  /** @brief Arena holding this block and its son array, if any.*/
+  parena arena;
 };
 
 /* ------------------------------------------------------------
@@ -211,6 +214,50 @@ build_nonstrict_block(pcluster rc, pcluster cc, void *data, admissible admis);
 HEADER_PREFIX pblock
 build_strict_block(pcluster rc, pcluster cc, void *data, admissible admis);
 
+/** @brief Build a non strict @ref block cluster tree using several threads.
+ *
+ * Builds the same block cluster tree as @ref build_nonstrict_block.
+ * The dual-tree recursion creates OpenMP tasks for the sons of blocks
+ * up to the depth <tt>pardepth</tt>.
+ * Diameters and centers of the bounding boxes are computed once per
+ * cluster, so the conditions @ref admissible_2_cluster,
+ * @ref admissible_max_cluster and @ref admissible_sphere_cluster are
+ * evaluated without recomputing them for every pair.
+ * Other admissibility conditions are called directly and have to be
+ * thread-safe.
+ * Below the depth <tt>pardepth</tt>, every task takes the blocks of
+ * its subtree from an @ref arena of its own instead of allocating
+ * them one by one.
+ *
+ * @param rc Row cluster.
+ * @param cc Col cluster.
+ * @param data Necessary data for the admissibility condition.
+ * @param admis Admissibility condition.
+ * @param pardepth Depth of the block tree up to which sons are
+ *        constructed in parallel, usually @ref max_pardepth.
+ * @returns Returns a non strict block cluster tree.
+ */
+HEADER_PREFIX pblock
+build_parallel_nonstrict_block(pcluster rc, pcluster cc, void *data,
+    admissible admis, uint pardepth);
+
+/** @brief Build a strict @ref block cluster tree using several threads.
+ *
+ * Builds the same block cluster tree as @ref build_strict_block, see
+ * @ref build_parallel_nonstrict_block for details.
+ *
+ * @param rc Row cluster.
+ * @param cc Col Cluster.
+ * @param data Necessary data for the admissibility condition.
+ * @param admis Admissibility condition.
+ * @param pardepth Depth of the block tree up to which sons are
+ *        constructed in parallel, usually @ref max_pardepth.
+ * @returns Returns a strict block cluster tree.
+ */
+HEADER_PREFIX pblock
+build_parallel_strict_block(pcluster rc, pcluster cc, void *data,
+    admissible admis, uint pardepth);
+
 /* ------------------------------------------------------------
  Drawing block cluster trees
  ------------------------------------------------------------ */
@@ -411,6 +458,162 @@ enumerate_block(pblock t);
 HEADER_PREFIX uint*
 enumerate_level_block(pblock t);
 
+/* ------------------------------------------------------------
+ Flat level-wise representation
+ ------------------------------------------------------------ */
+
+/** @brief Representation of a @ref flatblock object. */
+typedef struct _flatblock flatblock;
+
+/** @brief Pointer to a @ref flatblock object. */
+typedef flatblock *pflatblock;
+
+/** @brief Pointer to a constant @ref flatblock object. */
+typedef const flatblock *pcflatblock;
+
+/** @brief Flat level-wise representation of a @ref block cluster tree.
+ *
+ * The blocks are numbered level by level, the blocks of level @f$ l @f$
+ * are <tt>levelstart[l]</tt> to <tt>levelstart[l+1]-1</tt>, starting with
+ * the root <tt>0</tt>.
+ * The sons of a block <tt>k</tt> are stored consecutively starting at
+ * <tt>sonstart[k]</tt> in the order <tt>i + j * rsons</tt> of
+ * @ref block.
+ * For every row cluster, the array <tt>rowblock</tt> contains the numbers of
+ * all blocks with this row cluster, sorted by level, and the same holds for
+ * column clusters and <tt>colblock</tt>.
+ * Row and column clusters are identified by the numbers <tt>rname</tt> and
+ * <tt>cname</tt> also used by @ref iterate_block, the original numbers of the
+ * blocks are given by <tt>bname</tt>. */
+struct _flatblock {
+  /** @brief Number of blocks. */
+  uint blocks;
+
+  /** @brief Number of levels. */
+  uint depth;
+
+  /** @brief First block of each level, length <tt>depth+1</tt>. */
+  uint *levelstart;
+
+  /** @brief Original @ref block objects. */
+  pblock *b;
+
+  /** @brief Row clusters. */
+  pcluster *rc;
+
+  /** @brief Column clusters. */
+  pcluster *cc;
+
+  /** @brief Admissibility flags. */
+  bool *a;
+
+  /** @brief Numbers of the blocks as used by @ref iterate_block. */
+  uint *bname;
+
+  /** @brief Numbers of the row clusters. */
+  uint *rname;
+
+  /** @brief Numbers of the column clusters. */
+  uint *cname;
+
+  /** @brief Father of each block, the root is its own father. */
+  uint *father;
+
+  /** @brief First son of each block. */
+  uint *sonstart;
+
+  /** @brief Number of row clusters, i.e., <tt>rc->desc</tt> of the root. */
+  uint rclusters;
+
+  /** @brief First entry of each block row in <tt>rowblock</tt>,
+   *  length <tt>rclusters+1</tt>. */
+  uint *rowstart;
+
+  /** @brief Blocks sorted by row clusters. */
+  uint *rowblock;
+
+  /** @brief Number of column clusters, i.e., <tt>cc->desc</tt> of the root. */
+  uint cclusters;
+
+  /** @brief First entry of each block column in <tt>colblock</tt>,
+   *  length <tt>cclusters+1</tt>. */
+  uint *colstart;
+
+  /** @brief Blocks sorted by column clusters. */
+  uint *colblock;
+};
+
+/** @brief Create a flat level-wise representation of a @ref block cluster
+ *  tree.
+ *
+ * The @ref block cluster tree is not changed and has to remain valid as long
+ * as the @ref flatblock object is used.
+ *
+ * @param b Block cluster tree.
+ * @returns Flat representation of <tt>b</tt>. */
+HEADER_PREFIX pflatblock
+new_flatblock(pblock b);
+
+/** @brief Delete a @ref flatblock object.
+ *
+ * @param fb Object to be deleted. */
+HEADER_PREFIX void
+del_flatblock(pflatblock fb);
+
+/** @brief Iterate through all blocks of one level of a @ref flatblock
+ *  object.
+ *
+ * The blocks are handled by a parallel loop if <tt>pardepth>0</tt>.
+ * Algorithms that need fathers to be handled before their sons can
+ * call this function for the levels in increasing order.
+ *
+ * @param fb Flat block cluster tree.
+ * @param level Level, has to be smaller than <tt>fb->depth</tt>.
+ * @param pardepth Parallelization depth.
+ * @param func Function called for each block number <tt>k</tt> of the level.
+ * @param data Auxiliary data for the callback function. */
+HEADER_PREFIX void
+iterate_level_flatblock(pcflatblock fb, uint level, uint pardepth,
+    void (*func)(pcflatblock fb, uint k, void *data), void *data);
+
+/** @brief Iterate through all block rows of a @ref flatblock object.
+ *
+ * For each row cluster, <tt>func</tt> is called with the list of blocks
+ * <tt>blk</tt> of length <tt>n</tt> containing this row cluster.
+ * No linked lists are constructed, and if <tt>pardepth>0</tt>, the
+ * block rows are handled by a parallel loop, i.e., threads running in
+ * parallel call <tt>func</tt> with different row clusters.
+ *
+ * @remark In contrast to @ref iterate_byrow_block, there is no
+ * hierarchical ordering: block rows of fathers and sons may be handled
+ * in any order or at the same time, only the list <tt>blk</tt> of one
+ * block row is sorted by level.
+ * Algorithms that pass information from fathers to sons, e.g., the
+ * forward transformation of cluster bases, have to use the tree-based
+ * iterators or @ref iterate_level_flatblock instead.
+ *
+ * @param fb Flat block cluster tree.
+ * @param pardepth Parallelization depth.
+ * @param func Function called for each non-empty block row.
+ * @param data Auxiliary data for the callback function. */
+HEADER_PREFIX void
+iterate_rowlist_flatblock(pcflatblock fb, uint pardepth,
+    void (*func)(pcflatblock fb, uint rname, const uint *blk, uint n,
+        void *data), void *data);
+
+/** @brief Iterate through all block columns of a @ref flatblock object.
+ *
+ * Counterpart of @ref iterate_rowlist_flatblock for column clusters.
+ *
+ * @param fb Flat block cluster tree.
+ * @param pardepth Parallelization depth.
+ * @param func Function called for each non-empty block column.
+ * @param data Auxiliary data for the callback function. */
+HEADER_PREFIX void
+iterate_collist_flatblock(pcflatblock fb, uint pardepth,
+    void (*func)(pcflatblock fb, uint cname, const uint *blk, uint n,
+        void *data), void *data);
+
 /* ------------------------------------------------------------
  Utility functions
  ------------------------------------------------------------ */
@@ -34,6 +34,8 @@ init_raw_clusterbasis(pclusterbasis cb, pccluster t)
 
   cb->Z = NULL;
 
+  cb->arena = NULL;
+
 #ifdef USE_OPENMP
 #pragma omp atomic
 #endif
@@ -100,7 +102,8 @@ uninit_clusterbasis(pclusterbasis cb)
   if (cb->sons > 0) {
     for (i = 0; i < cb->sons; i++)
       unref_clusterbasis(cb->son[i]);
-    freemem(cb->son);
+    if (cb->arena == NULL || !contains_arena(cb->arena, cb->son))
+      freemem(cb->son);
   }
 
   uninit_amatrix(&cb->V);
@@ -141,9 +144,14 @@ new_leaf_clusterbasis(pccluster t)
 void
 del_clusterbasis(pclusterbasis cb)
 {
+  parena    pa = cb->arena;
+
   uninit_clusterbasis(cb);
 
-  freemem(cb);
+  if (pa)
+    unref_arena(pa);
+  else
+    freemem(cb);
 }
 
 /* ------------------------------------------------------------
@@ -253,6 +261,66 @@ build_from_cluster_clusterbasis(pccluster t)
   return cb;
 }
 
+static size_t
+arenasize_cluster(pccluster t)
+{
+  size_t    sz;
+  uint      i;
+
+  /* Leave room for padding of every object */
+  sz = sizeof(clusterbasis) + 16;
+
+  if (t->sons > 0) {
+    sz += sizeof(pclusterbasis) * t->sons + 16;
+
+    for (i = 0; i < t->sons; i++)
+      sz += arenasize_cluster(t->son[i]);
+  }
+
+  return sz;
+}
+
+static pclusterbasis
+build_from_cluster_arena(pccluster t, parena pa)
+{
+  pclusterbasis cb, cb1;
+  uint      i;
+
+  cb = (pclusterbasis) allocarena(pa, sizeof(clusterbasis));
+
+  (void) init_leaf_clusterbasis(cb, t);
+
+  ref_arena(&cb->arena, pa);
+
+  if (t->sons > 0) {
+    cb->sons = t->sons;
+    cb->son = (pclusterbasis *) allocarena(pa, (size_t) sizeof(pclusterbasis)
+					   * t->sons);
+
+    for (i = 0; i < t->sons; i++) {
+      cb->son[i] = NULL;
+
+      cb1 = build_from_cluster_arena(t->son[i], pa);
+
+      ref_clusterbasis(cb->son + i, cb1);
+    }
+  }
+
+  resize_clusterbasis(cb, 0);
+
+  return cb;
+}
+
+pclusterbasis
+build_from_cluster_arena_clusterbasis(pccluster t)
+{
+  parena    pa;
+
+  pa = new_arena(arenasize_cluster(t));
+
+  return build_from_cluster_arena(t, pa);
+}
+
 /* ------------------------------------------------------------
    Clone a cluster basis
    ------------------------------------------------------------ */
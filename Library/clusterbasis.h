@@ -68,6 +68,10 @@ struct _clusterbasis {
   puniform rlist;
   /** @brief List of matrices using this basis as column basis */
   puniform clist;
+
+  /** @brief @ref arena holding this object, <tt>NULL</tt> if it has
+   *  been allocated individually. */
+  parena arena;
 };
 
 /* ------------------------------------------------------------
@@ -245,6 +249,24 @@ resize_clusterbasis(pclusterbasis cb, int k);
 HEADER_PREFIX pclusterbasis
 build_from_cluster_clusterbasis(pccluster t);
 
+/** @brief Construct a @ref clusterbasis from a cluster tree,
+ *  allocating all nodes from one @ref arena.
+ *
+ *  The @ref clusterbasis objects and the arrays of sons are taken
+ *  from an @ref arena sized for the cluster tree. The matrices
+ *  <tt>V</tt> and <tt>E</tt> are still allocated individually, since
+ *  they are resized when the ranks are changed.
+ *  The arena is released automatically when the last of its nodes
+ *  is deleted.
+ *
+ *  All ranks will be set to zero.
+ *
+ *  @param t Root cluster.
+ *  @returns New root @ref clusterbasis object following the
+ *         structure of the cluster tree. */
+HEADER_PREFIX pclusterbasis
+build_from_cluster_arena_clusterbasis(pccluster t);
+
 /* ------------------------------------------------------------
  Clone a cluster basis
  ------------------------------------------------------------ */
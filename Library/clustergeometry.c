@@ -388,105 +388,119 @@ build_simsub_cluster(pclustergeometry cf, uint size, uint * idx, uint clf)
   return t;
 }
 
-pcluster
-build_pca_cluster(pclustergeometry cf, uint size, uint * idx, uint clf)
+/* auxiliary routine for build_pca_cluster, splits the index set along
+   the plane through the center of mass orthogonal to the principal
+   direction and returns the size of the first part */
+static uint
+split_pca_clustergeometry(pclustergeometry cf, uint size, uint * idx)
 {
   const uint dim = cf->dim;
 
+  avector   vtmp;
   pamatrix  C, Q;
   pavector  lambda, v;
   real     *x, *y;
   real      w;
   uint      i, j, k, size0, size1;
 
-  pcluster  t;
-
   size0 = 0;
   size1 = 0;
 
-  if (size > clf) {
-    x = allocreal(dim);
-    y = allocreal(dim);
+  x = allocreal(dim);
+  y = allocreal(dim);
 
-    /* determine weight of current cluster */
-    w = 0.0;
-    for (i = 0; i < size; ++i) {
-      w += cf->w[idx[i]];
-    }
-    w = 1.0 / w;
+  /* determine weight of current cluster */
+  w = 0.0;
+  for (i = 0; i < size; ++i) {
+    w += cf->w[idx[i]];
+  }
+  w = 1.0 / w;
+
+  for (j = 0; j < dim; ++j) {
+    x[j] = 0.0;
+  }
 
+  /* determine center of mass */
+  for (i = 0; i < size; ++i) {
     for (j = 0; j < dim; ++j) {
-      x[j] = 0.0;
+      x[j] += cf->w[idx[i]] * cf->x[idx[i]][j];
     }
+  }
+  for (j = 0; j < dim; ++j) {
+    x[j] *= w;
+  }
 
-    /* determine center of mass */
-    for (i = 0; i < size; ++i) {
-      for (j = 0; j < dim; ++j) {
-	x[j] += cf->w[idx[i]] * cf->x[idx[i]][j];
-      }
+  C = new_zero_amatrix(dim, dim);
+  Q = new_zero_amatrix(dim, dim);
+  lambda = new_avector(dim);
+  clear_avector(lambda);
+
+  /* setup covariance matrix */
+  for (i = 0; i < size; ++i) {
+
+    for (j = 0; j < dim; ++j) {
+      y[j] = cf->x[idx[i]][j] - x[j];
     }
+
     for (j = 0; j < dim; ++j) {
-      x[j] *= w;
+      for (k = 0; k < dim; ++k) {
+	C->a[j + k * C->ld] += cf->w[idx[i]] * y[j] * y[k];
+      }
     }
+  }
 
-    C = new_zero_amatrix(dim, dim);
-    Q = new_zero_amatrix(dim, dim);
-    lambda = new_avector(dim);
-    clear_avector(lambda);
+  /* get eigenvalues and eigenvectors of covariance matrix */
+  eig_amatrix(C, lambda, Q);
 
-    /* setup covariance matrix */
-    for (i = 0; i < size; ++i) {
+  /* get eigenvector from largest eigenvalue */
+  v = init_column_avector(&vtmp, Q, dim - 1);
 
-      for (j = 0; j < dim; ++j) {
-	y[j] = cf->x[idx[i]][j] - x[j];
-      }
+  /* separate cluster with v as separation-plane */
+  for (i = 0; i < size; ++i) {
+    /* x_i - X */
+    for (j = 0; j < dim; ++j) {
+      y[j] = cf->x[idx[i]][j] - x[j];
+    }
 
-      for (j = 0; j < dim; ++j) {
-	for (k = 0; k < dim; ++k) {
-	  C->a[j + k * C->ld] += cf->w[idx[i]] * y[j] * y[k];
-	}
-      }
+    /* <y,v> */
+    w = 0.0;
+    for (j = 0; j < dim; ++j) {
+      w += y[j] * v->v[j];
     }
 
-    /* get eigenvalues and eigenvectors of covariance matrix */
-    eig_amatrix(C, lambda, Q);
+    if (w >= 0.0) {
+      j = idx[i];
+      idx[i] = idx[size0];
+      idx[size0] = j;
+      size0++;
+    }
+    else {
+      size1++;
+    }
+  }
 
-    /* get eigenvector from largest eigenvalue */
-    v = new_avector(0);
-    init_column_avector(v, Q, dim - 1);
+  assert(size0 + size1 == size);
 
-    /* separate cluster with v as separation-plane */
-    for (i = 0; i < size; ++i) {
-      /* x_i - X */
-      for (j = 0; j < dim; ++j) {
-	y[j] = cf->x[idx[i]][j] - x[j];
-      }
+  del_amatrix(Q);
+  del_amatrix(C);
+  del_avector(lambda);
+  uninit_avector(v);
+  freemem(x);
+  freemem(y);
 
-      /* <y,v> */
-      w = 0.0;
-      for (j = 0; j < dim; ++j) {
-	w += y[j] * v->v[j];
-      }
+  return size0;
+}
 
-      if (w >= 0.0) {
-	j = idx[i];
-	idx[i] = idx[size0];
-	idx[size0] = j;
-	size0++;
-      }
-      else {
-	size1++;
-      }
-    }
+pcluster
+build_pca_cluster(pclustergeometry cf, uint size, uint * idx, uint clf)
+{
+  uint      size0, size1;
 
-    assert(size0 + size1 == size);
+  pcluster  t;
 
-    del_amatrix(Q);
-    del_amatrix(C);
-    del_avector(lambda);
-    del_avector(v);
-    freemem(x);
-    freemem(y);
+  if (size > clf) {
+    size0 = split_pca_clustergeometry(cf, size, idx);
+    size1 = size - size0;
 
     /* recursion */
     if (size0 > 0) {
@@ -524,6 +538,158 @@ build_pca_cluster(pclustergeometry cf, uint size, uint * idx, uint clf)
   return t;
 }
 
+/* number of bits per coordinate used for Morton ordering */
+#define MORTON_BITS 30
+
+/* auxiliary routine for build_morton_cluster, compares the Morton keys
+   of two quantized points without forming the interleaved keys:
+   the coordinate with the most significant differing bit decides */
+static    bool
+less_morton(const uint * qa, const uint * qb, uint dim)
+{
+  uint      d, k, y, ymax;
+
+  k = 0;
+  ymax = 0;
+  for (d = 0; d < dim; d++) {
+    y = qa[d] ^ qb[d];
+    if (ymax < y && ymax < (ymax ^ y)) {
+      k = d;
+      ymax = y;
+    }
+  }
+
+  return (qa[k] < qb[k]);
+}
+
+/* auxiliary routine for build_morton_cluster, stable merge sort of
+   the index set with respect to the Morton keys */
+static void
+sort_morton(const uint * q, uint dim, uint size, uint * idx, uint * tmp)
+{
+  uint      size0, i, j, k;
+
+  if (size < 2)
+    return;
+
+  size0 = size / 2;
+  sort_morton(q, dim, size0, idx, tmp);
+  sort_morton(q, dim, size - size0, idx + size0, tmp);
+
+  /* nothing to do if both halves are already in order */
+  if (!less_morton(q + (size_t) idx[size0] * dim,
+		   q + (size_t) idx[size0 - 1] * dim, dim))
+    return;
+
+  i = 0;
+  j = size0;
+  k = 0;
+  while (i < size0 && j < size) {
+    if (less_morton(q + (size_t) idx[j] * dim, q + (size_t) idx[i] * dim,
+		    dim))
+      tmp[k++] = idx[j++];
+    else
+      tmp[k++] = idx[i++];
+  }
+  while (i < size0)
+    tmp[k++] = idx[i++];
+  while (j < size)
+    tmp[k++] = idx[j++];
+
+  for (k = 0; k < size; k++)
+    idx[k] = tmp[k];
+}
+
+/* auxiliary routine for build_morton_cluster, derives the cluster tree
+   from the prefixes of the Morton keys of the sorted index set */
+static pcluster
+build_morton_help(pclustergeometry cf, const uint * q, uint size,
+		  uint * idx, uint clf, uint level)
+{
+  const uint dim = cf->dim;
+  pcluster  t;
+
+  uint      bit, d, lo, hi, mid;
+
+  /* skip prefixes shared by all indices */
+  lo = 0;
+  while (size > clf && level < MORTON_BITS * dim) {
+    bit = MORTON_BITS - 1 - level / dim;
+    d = level % dim;
+
+    /* find the first index with this bit set by binary search */
+    lo = 0;
+    hi = size;
+    while (lo < hi) {
+      mid = lo + (hi - lo) / 2;
+      if ((q[(size_t) idx[mid] * dim + d] >> bit) & 1)
+	hi = mid;
+      else
+	lo = mid + 1;
+    }
+
+    if (lo > 0 && lo < size)
+      break;
+
+    level++;
+  }
+
+  if (size > clf && level < MORTON_BITS * dim) {
+    t = new_cluster(size, idx, 2, dim);
+
+    t->son[0] = build_morton_help(cf, q, lo, idx, clf, level + 1);
+    t->son[1] = build_morton_help(cf, q, size - lo, idx + lo, clf,
+				  level + 1);
+
+    update_bbox_cluster(t);
+  }
+  else {
+    t = new_cluster(size, idx, 0, dim);
+    update_support_bbox_cluster(cf, t);
+  }
+
+  update_cluster(t);
+
+  return t;
+}
+
+pcluster
+build_morton_cluster(pclustergeometry cf, uint size, uint * idx, uint clf)
+{
+  const uint dim = cf->dim;
+  pcluster  t;
+  uint     *q, *tmp;
+  real      scale;
+  uint      i, j;
+
+  update_point_bbox_clustergeometry(cf, size, idx);
+
+  /* quantize the characteristic points with respect to the bounding box */
+  q = allocuint((size_t) cf->nidx * dim);
+  for (i = 0; i < size; i++) {
+    for (j = 0; j < dim; j++) {
+      scale = cf->hmax[j] - cf->hmin[j];
+      if (scale > 0.0) {
+	scale = (cf->x[idx[i]][j] - cf->hmin[j]) / scale
+	  * (1u << MORTON_BITS);
+      }
+      q[(size_t) idx[i] * dim + j] =
+	(scale < (1u << MORTON_BITS) ? (uint) scale :
+	 (1u << MORTON_BITS) - 1);
+    }
+  }
+
+  tmp = allocuint(size);
+  sort_morton(q, dim, size, idx, tmp);
+  freemem(tmp);
+
+  t = build_morton_help(cf, q, size, idx, clf, 0);
+
+  freemem(q);
+
+  return t;
+}
+
 pcluster
 build_cluster(pclustergeometry cf, uint size, uint * idx, uint clf,
 	      clustermode mode)
@@ -540,6 +706,9 @@ build_cluster(pclustergeometry cf, uint size, uint * idx, uint clf,
   else if (mode == H2_PCA) {
     t = build_pca_cluster(cf, size, idx, clf);
   }
+  else if (mode == H2_MORTON) {
+    t = build_morton_cluster(cf, size, idx, clf);
+  }
   else {
     assert(mode == H2_SIMSUB);
     update_point_bbox_clustergeometry(cf, size, idx);
@@ -549,6 +718,416 @@ build_cluster(pclustergeometry cf, uint size, uint * idx, uint clf,
   return t;
 }
 
+/* ------------------------------------------------------------
+ Parallel clustering
+ ------------------------------------------------------------ */
+
+#ifdef USE_OPENMP
+
+/* index sets of at least this size are partitioned by several tasks */
+#define PARALLEL_SIZE_CLUSTERGEOMETRY 65536
+
+/* number of chunks used for parallel partitioning */
+#define PARALLEL_CHUNKS_CLUSTERGEOMETRY 64
+
+/* auxiliary routine, creates a shallow copy of a clustergeometry object
+   that shares characteristic points, weights and support bounding boxes,
+   but has its own internal fields hmin and hmax */
+static pclustergeometry
+clone_clustergeometry(pclustergeometry cf)
+{
+  pclustergeometry cc;
+
+  uint      j;
+
+  cc = (pclustergeometry) allocmem((size_t) sizeof(clustergeometry));
+  *cc = *cf;
+  cc->hmin = allocreal(cf->dim);
+  cc->hmax = allocreal(cf->dim);
+
+  for (j = 0; j < cf->dim; j++) {
+    cc->hmin[j] = cf->hmin[j];
+    cc->hmax[j] = cf->hmax[j];
+  }
+
+  return cc;
+}
+
+static void
+del_clone_clustergeometry(pclustergeometry cc)
+{
+  freemem(cc->hmax);
+  freemem(cc->hmin);
+  freemem(cc);
+}
+
+/* auxiliary routine, computes the bounding box of the characteristic
+   points in cf->hmin and cf->hmax, using one task per chunk for large
+   index sets */
+static void
+update_point_bbox_task(pclustergeometry cf, uint size, uint * idx)
+{
+  const uint dim = cf->dim;
+  const uint chunks = PARALLEL_CHUNKS_CLUSTERGEOMETRY;
+  real     *cmin, *cmax;
+  uint      c, j;
+
+  if (size < PARALLEL_SIZE_CLUSTERGEOMETRY) {
+    update_point_bbox_clustergeometry(cf, size, idx);
+    return;
+  }
+
+  cmin = allocreal(chunks * dim);
+  cmax = allocreal(chunks * dim);
+
+  for (c = 0; c < chunks; c++) {
+#pragma omp task firstprivate(c)
+    {
+      uint      i, k, start, stop;
+
+      start = (uint) ((size_t) c * size / chunks);
+      stop = (uint) ((size_t) (c + 1) * size / chunks);
+
+      for (k = 0; k < dim; k++) {
+	cmin[k + c * dim] = cf->x[idx[start]][k];
+	cmax[k + c * dim] = cf->x[idx[start]][k];
+      }
+      for (i = start + 1; i < stop; i++) {
+	for (k = 0; k < dim; k++) {
+	  cmin[k + c * dim] = REAL_MIN(cmin[k + c * dim], cf->x[idx[i]][k]);
+	  cmax[k + c * dim] = REAL_MAX(cmax[k + c * dim], cf->x[idx[i]][k]);
+	}
+      }
+    }
+  }
+#pragma omp taskwait
+
+  for (j = 0; j < dim; j++) {
+    cf->hmin[j] = cmin[j];
+    cf->hmax[j] = cmax[j];
+  }
+  for (c = 1; c < chunks; c++) {
+    for (j = 0; j < dim; j++) {
+      cf->hmin[j] = REAL_MIN(cf->hmin[j], cmin[j + c * dim]);
+      cf->hmax[j] = REAL_MAX(cf->hmax[j], cmax[j + c * dim]);
+    }
+  }
+
+  freemem(cmax);
+  freemem(cmin);
+}
+
+/* auxiliary routine, moves all indices with x[direction] < m to the
+   front of idx and returns their number.
+   Large index sets are partitioned stably by one task per chunk. */
+static uint
+partition_task(pclustergeometry cf, uint size, uint * idx,
+	       uint direction, real m)
+{
+  const uint chunks = PARALLEL_CHUNKS_CLUSTERGEOMETRY;
+  uint     *tmp, *cnt;
+  uint      size0, c, i, j;
+
+  if (size < PARALLEL_SIZE_CLUSTERGEOMETRY) {
+    size0 = 0;
+    for (i = 0; i < size; i++) {
+      if (cf->x[idx[i]][direction] < m) {
+	j = idx[i];
+	idx[i] = idx[size0];
+	idx[size0] = j;
+	size0++;
+      }
+    }
+    return size0;
+  }
+
+  tmp = allocuint(size);
+  cnt = allocuint(chunks + 1);
+
+  /* count the indices of the first son in every chunk */
+  for (c = 0; c < chunks; c++) {
+#pragma omp task firstprivate(c)
+    {
+      uint      i, start, stop, n0;
+
+      start = (uint) ((size_t) c * size / chunks);
+      stop = (uint) ((size_t) (c + 1) * size / chunks);
+
+      n0 = 0;
+      for (i = start; i < stop; i++) {
+	if (cf->x[idx[i]][direction] < m) {
+	  n0++;
+	}
+      }
+      cnt[c + 1] = n0;
+    }
+  }
+#pragma omp taskwait
+
+  /* prefix sums give the starting positions of the chunks */
+  cnt[0] = 0;
+  for (c = 0; c < chunks; c++) {
+    cnt[c + 1] += cnt[c];
+  }
+  size0 = cnt[chunks];
+
+  /* scatter the indices into the auxiliary array */
+  for (c = 0; c < chunks; c++) {
+#pragma omp task firstprivate(c)
+    {
+      uint      i, start, stop, off0, off1;
+
+      start = (uint) ((size_t) c * size / chunks);
+      stop = (uint) ((size_t) (c + 1) * size / chunks);
+
+      off0 = cnt[c];
+      off1 = size0 + start - cnt[c];
+      for (i = start; i < stop; i++) {
+	if (cf->x[idx[i]][direction] < m) {
+	  tmp[off0++] = idx[i];
+	}
+	else {
+	  tmp[off1++] = idx[i];
+	}
+      }
+    }
+  }
+#pragma omp taskwait
+
+  for (c = 0; c < chunks; c++) {
+#pragma omp task firstprivate(c)
+    {
+      uint      i, start, stop;
+
+      start = (uint) ((size_t) c * size / chunks);
+      stop = (uint) ((size_t) (c + 1) * size / chunks);
+
+      for (i = start; i < stop; i++) {
+	idx[i] = tmp[i];
+      }
+    }
+  }
+#pragma omp taskwait
+
+  freemem(cnt);
+  freemem(tmp);
+
+  return size0;
+}
+
+static pcluster
+build_task_cluster(pclustergeometry cf, uint size, uint * idx, uint clf,
+		   clustermode mode, uint direction, uint pardepth);
+
+/* auxiliary routine, collects the leaves of the help cluster tree
+   and releases its inner nodes */
+static void
+collect_leaves_cluster(pcluster s, pcluster * leaf, uint * leaves)
+{
+  uint      i;
+
+  if (s->sons > 0) {
+    for (i = 0; i < s->sons; i++) {
+      collect_leaves_cluster(s->son[i], leaf, leaves);
+    }
+    freemem(s->son);
+    freemem(s->bmax);
+    freemem(s->bmin);
+    freemem(s);
+  }
+  else {
+    leaf[*leaves] = s;
+    (*leaves)++;
+  }
+}
+
+/* auxiliary routine, simultaneous subdivision with one task per son,
+   cf->hmin and cf->hmax have to contain the current box */
+static pcluster
+build_task_simsub_cluster(pclustergeometry cf, uint size, uint * idx,
+			  uint clf, uint pardepth)
+{
+  pcluster  t, s;
+  uint      leaves, i;
+
+  leaves = 0;
+  s = build_help_cluster(cf, idx, size, clf, 0, &leaves);
+  t = new_cluster(size, idx, leaves, cf->dim);
+
+  /* store the leaves of the help tree in t->son for the time being */
+  leaves = 0;
+  collect_leaves_cluster(s, t->son, &leaves);
+  assert(leaves == t->sons);
+
+  for (i = 0; i < t->sons; i++) {
+#pragma omp task firstprivate(i)
+    {
+      pclustergeometry cc;
+      pcluster  l;
+      uint      j;
+
+      l = t->son[i];
+      cc = clone_clustergeometry(cf);
+      for (j = 0; j < cc->dim; j++) {
+	cc->hmin[j] = l->bmin[j];
+	cc->hmax[j] = l->bmax[j];
+      }
+
+      t->son[i] = build_task_cluster(cc, l->size, l->idx, clf, H2_SIMSUB,
+				     0, pardepth - 1);
+
+      del_cluster(l);
+      del_clone_clustergeometry(cc);
+    }
+  }
+#pragma omp taskwait
+
+  update_bbox_cluster(t);
+  update_cluster(t);
+
+  return t;
+}
+
+/* auxiliary routine, splits the index set like the sequential strategy
+   and constructs the first son in a new task */
+static pcluster
+build_task_cluster(pclustergeometry cf, uint size, uint * idx, uint clf,
+		   clustermode mode, uint direction, uint pardepth)
+{
+  pclustergeometry cc;
+  pcluster  t;
+
+  uint      newd;
+  uint      size0, size1;
+  uint      j;
+  real      a, m;
+
+  if (pardepth == 0 || size <= clf) {
+    if (mode == H2_ADAPTIVE) {
+      t = build_adaptive_cluster(cf, size, idx, clf);
+    }
+    else if (mode == H2_REGULAR) {
+      t = build_regular_cluster(cf, size, idx, clf, direction);
+    }
+    else if (mode == H2_PCA) {
+      t = build_pca_cluster(cf, size, idx, clf);
+    }
+    else {
+      assert(mode == H2_SIMSUB);
+      t = build_simsub_cluster(cf, size, idx, clf);
+    }
+    return t;
+  }
+
+  if (mode == H2_SIMSUB) {
+    return build_task_simsub_cluster(cf, size, idx, clf, pardepth);
+  }
+
+  newd = 0;
+  if (mode == H2_PCA) {
+    size0 = split_pca_clustergeometry(cf, size, idx);
+  }
+  else {
+    assert(mode == H2_ADAPTIVE || mode == H2_REGULAR);
+
+    update_point_bbox_task(cf, size, idx);
+
+    /* compute the direction of partition */
+    if (mode == H2_ADAPTIVE) {
+      direction = 0;
+      a = cf->hmax[0] - cf->hmin[0];
+      for (j = 1; j < cf->dim; j++) {
+	m = cf->hmax[j] - cf->hmin[j];
+	if (a < m) {
+	  a = m;
+	  direction = j;
+	}
+      }
+    }
+    else {
+      a = cf->hmax[direction] - cf->hmin[direction];
+      newd = (direction < cf->dim - 1 ? direction + 1 : 0);
+    }
+
+    if (a > 0.0) {
+      m = (cf->hmax[direction] + cf->hmin[direction]) / 2.0;
+      size0 = partition_task(cf, size, idx, direction, m);
+    }
+    else if (mode == H2_ADAPTIVE) {
+      assert(a == 0.0);
+      t = new_cluster(size, idx, 0, cf->dim);
+      update_support_bbox_cluster(cf, t);
+      update_cluster(t);
+      return t;
+    }
+    else {
+      assert(a == 0.0);
+      size0 = size;
+    }
+  }
+  size1 = size - size0;
+
+  if (size0 > 0 && size1 > 0) {
+    t = new_cluster(size, idx, 2, cf->dim);
+
+    /* the first son gets its own copy of the internal fields */
+    cc = clone_clustergeometry(cf);
+
+#pragma omp task
+    {
+      t->son[0] = build_task_cluster(cc, size0, idx, clf, mode, newd,
+				     pardepth - 1);
+      del_clone_clustergeometry(cc);
+    }
+
+    t->son[1] = build_task_cluster(cf, size1, idx + size0, clf, mode, newd,
+				   pardepth - 1);
+
+#pragma omp taskwait
+  }
+  else {
+    /* only one son is not empty */
+    t = new_cluster(size, idx, 1, cf->dim);
+    t->son[0] = build_task_cluster(cf, size, idx, clf, mode, newd, pardepth);
+  }
+
+  update_bbox_cluster(t);
+  update_cluster(t);
+
+  return t;
+}
+
+#endif
+
+pcluster
+build_parallel_cluster(pclustergeometry cf, uint size, uint * idx,
+		       uint clf, clustermode mode, uint pardepth)
+{
+  pcluster  t;
+
+#ifdef USE_OPENMP
+  /* the Morton ordering is dominated by sorting and built sequentially */
+  if (pardepth > 0 && size > clf && mode != H2_MORTON) {
+#pragma omp parallel
+#pragma omp single
+    {
+      if (mode == H2_SIMSUB) {
+	update_point_bbox_task(cf, size, idx);
+      }
+      t = build_task_cluster(cf, size, idx, clf, mode, 0, pardepth);
+    }
+
+    return t;
+  }
+#else
+  (void) pardepth;
+#endif
+
+  t = build_cluster(cf, size, idx, clf, mode);
+
+  return t;
+}
+
 /* ------------------------------------------------------------
  Auxiliary routines
  ------------------------------------------------------------ */
@@ -111,7 +111,9 @@ typedef enum {
   /** @brief Simultaneous subdivision clustering. */
   H2_SIMSUB,
   /** @brief Geometrically clustering based principal component analysis (PCA).*/
-  H2_PCA
+  H2_PCA,
+  /** @brief Clustering based on a Morton space-filling curve.*/
+  H2_MORTON
 } clustermode;
 
 /**
@@ -192,6 +194,28 @@ build_simsub_cluster(pclustergeometry cf, uint size, uint *idx, uint clf);
 HEADER_PREFIX pcluster
 build_pca_cluster(pclustergeometry cf, uint size, uint* idx, uint clf);
 
+/**
+ * @brief Build a @ref cluster tree from a @ref clustergeometry object
+ *  based on a Morton space-filling curve.
+ *
+ *  The characteristic points are quantized with respect to their bounding
+ *  box and the index set is sorted once by the Morton keys, i.e., the
+ *  interleaved bits of the quantized coordinates.
+ *  Clusters correspond to common prefixes of these keys, prefixes shared
+ *  by all indices of a cluster are skipped, so every cluster has either
+ *  two sons or none.
+ *  The resulting permutation of the indices keeps geometrically close
+ *  indices close in memory.
+ *
+ * @param cf @ref clustergeometry object with geometrical information.
+ * @param size Number of indices.
+ * @param idx Index set, will be sorted by Morton keys.
+ * @param clf Maximal leaf size.
+ * @return Returns a @ref cluster tree object basing on Morton keys.
+ */
+HEADER_PREFIX pcluster
+build_morton_cluster(pclustergeometry cf, uint size, uint* idx, uint clf);
+
 /**
  * @brief Build a @ref cluster tree from a @ref clustergeometry object using
  * cluster strategy @ref clustermode.
@@ -211,6 +235,35 @@ HEADER_PREFIX pcluster
 build_cluster(pclustergeometry cf, uint size, uint *idx, uint clf,
     clustermode mode);
 
+/**
+ * @brief Build a @ref cluster tree from a @ref clustergeometry object using
+ * cluster strategy @ref clustermode and several threads.
+ *
+ * Subtrees are constructed by OpenMP tasks down to the depth
+ * <tt>pardepth</tt>, every task working on its own copy of the internal
+ * fields <tt>hmin</tt> and <tt>hmax</tt>.
+ * Near the root, large index sets are partitioned and their bounding
+ * boxes computed by several tasks, too.
+ * The resulting tree has the same structure as the one constructed by
+ * @ref build_cluster, but the order of the indices within a cluster may
+ * differ for the strategies @ref H2_ADAPTIVE and @ref H2_REGULAR, since
+ * the parallel partitioning is stable.
+ * Without OpenMP, for <tt>pardepth=0</tt> or for @ref H2_MORTON,
+ * @ref build_cluster is called.
+ *
+ * @param cf @ref clustergeometry object with geometrical information.
+ * @param size Number of indices.
+ * @param idx Index set.
+ * @param clf Maximal leaf size.
+ * @param mode Cluster strategy
+ * @param pardepth Depth of the tree up to which subtrees are constructed
+ *        in parallel, usually @ref max_pardepth.
+ * @return Returns a @ref cluster tree object.
+ */
+HEADER_PREFIX pcluster
+build_parallel_cluster(pclustergeometry cf, uint size, uint *idx, uint clf,
+    clustermode mode, uint pardepth);
+
 /* ------------------------------------------------------------
  Auxiliary routines
  ------------------------------------------------------------ */
@@ -533,6 +533,7 @@ uppersolve_amatrix(bool aunit, bool atrans, pcamatrix a,
 }
 #endif
 
+#ifdef USE_BLAS
 void
 triangularsolve_amatrix(bool alower, bool aunit, bool atrans, pcamatrix a,
 			bool xtrans, pamatrix x)
@@ -542,6 +543,77 @@ triangularsolve_amatrix(bool alower, bool aunit, bool atrans, pcamatrix a,
   else
     uppersolve_amatrix(aunit, atrans, a, xtrans, x);
 }
+#else
+/* Without BLAS, large triangular systems are split recursively, so
+   that most of the work is done by the blocked matrix multiplication
+   in addmul_amatrix and only small diagonal blocks are solved by
+   lowersolve_amatrix and uppersolve_amatrix. */
+
+#define TRSM_BLOCK 64
+
+void
+triangularsolve_amatrix(bool alower, bool aunit, bool atrans, pcamatrix a,
+			bool xtrans, pamatrix x)
+{
+  amatrix   tmp1, tmp2, tmp3, tmp4, tmp5;
+  pamatrix  a11, a22, aoff, x1, x2;
+  uint      n = UINT_MIN(a->rows, a->cols);
+  uint      n1;
+
+  if (n <= TRSM_BLOCK) {
+    if (alower)
+      lowersolve_amatrix(aunit, atrans, a, xtrans, x);
+    else
+      uppersolve_amatrix(aunit, atrans, a, xtrans, x);
+    return;
+  }
+
+  n1 = n / 2;
+
+  a11 = init_sub_amatrix(&tmp1, (pamatrix) a, n1, 0, n1, 0);
+  a22 = init_sub_amatrix(&tmp2, (pamatrix) a, n - n1, n1, n - n1, n1);
+  if (alower)
+    aoff = init_sub_amatrix(&tmp3, (pamatrix) a, n - n1, n1, n1, 0);
+  else
+    aoff = init_sub_amatrix(&tmp3, (pamatrix) a, n1, 0, n - n1, n1);
+
+  if (xtrans) {
+    assert(x->cols >= n);
+    x1 = init_sub_amatrix(&tmp4, x, x->rows, 0, n1, 0);
+    x2 = init_sub_amatrix(&tmp5, x, x->rows, 0, n - n1, n1);
+  }
+  else {
+    assert(x->rows >= n);
+    x1 = init_sub_amatrix(&tmp4, x, n1, 0, x->cols, 0);
+    x2 = init_sub_amatrix(&tmp5, x, n - n1, n1, x->cols, 0);
+  }
+
+  if (alower ? !atrans : atrans) {
+    /* op(A) is lower triangular, solve for the first block first */
+    triangularsolve_amatrix(alower, aunit, atrans, a11, xtrans, x1);
+    if (xtrans)
+      addmul_amatrix(-1.0, false, x1, !atrans, aoff, x2);
+    else
+      addmul_amatrix(-1.0, atrans, aoff, false, x1, x2);
+    triangularsolve_amatrix(alower, aunit, atrans, a22, xtrans, x2);
+  }
+  else {
+    /* op(A) is upper triangular, solve for the second block first */
+    triangularsolve_amatrix(alower, aunit, atrans, a22, xtrans, x2);
+    if (xtrans)
+      addmul_amatrix(-1.0, false, x2, !atrans, aoff, x1);
+    else
+      addmul_amatrix(-1.0, atrans, aoff, false, x2, x1);
+    triangularsolve_amatrix(alower, aunit, atrans, a11, xtrans, x1);
+  }
+
+  uninit_amatrix(x2);
+  uninit_amatrix(x1);
+  uninit_amatrix(aoff);
+  uninit_amatrix(a22);
+  uninit_amatrix(a11);
+}
+#endif
 
 #ifdef USE_BLAS
 IMPORT_PREFIX void
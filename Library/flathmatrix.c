@@ -0,0 +1,557 @@
+
+/* ------------------------------------------------------------
+   This is the file "flathmatrix.c" of the H2Lib package.
+   All rights reserved, Steffen Boerm 2015
+   ------------------------------------------------------------ */
+
+#include <float.h>
+
+#include "flathmatrix.h"
+
+#include "basic.h"
+
+/* ------------------------------------------------------------
+   Constructors and destructors
+   ------------------------------------------------------------ */
+
+static void
+count_leaves(pchmatrix hm, uint * leaves)
+{
+  uint      rsons, csons;
+  uint      i, j;
+
+  if (hm->son) {
+    rsons = hm->rsons;
+    csons = hm->csons;
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	count_leaves(hm->son[i + j * rsons], leaves);
+  }
+  else if (hm->r) {
+    if (hm->r->k > 0)
+      (*leaves)++;
+  }
+  else {
+    assert(hm->f);
+
+    (*leaves)++;
+  }
+}
+
+static void
+collect_leaves(pchmatrix hm, uint roff, uint coff, pflatleaf leaf,
+	       pchmatrix * src, uint * n)
+{
+  uint      rsons, csons;
+  uint      roff1, coff1;
+  uint      i, j;
+
+  if (hm->son) {
+    rsons = hm->rsons;
+    csons = hm->csons;
+
+    coff1 = coff;
+    for (j = 0; j < csons; j++) {
+      roff1 = roff;
+      for (i = 0; i < rsons; i++) {
+	collect_leaves(hm->son[i + j * rsons], roff1, coff1, leaf, src, n);
+
+	roff1 += hm->son[i]->rc->size;
+      }
+      assert(roff1 == roff + hm->rc->size);
+
+      coff1 += hm->son[j * rsons]->cc->size;
+    }
+    assert(coff1 == coff + hm->cc->size);
+  }
+  else if (hm->f || hm->r->k > 0) {
+    leaf[*n].roff = roff;
+    leaf[*n].coff = coff;
+    leaf[*n].rows = hm->rc->size;
+    leaf[*n].cols = hm->cc->size;
+    leaf[*n].k = (hm->r ? hm->r->k : 0);
+    leaf[*n].single = false;
+    leaf[*n].off = 0;
+    src[*n] = hm;
+    (*n)++;
+  }
+}
+
+struct _sortdata {
+  pflatleaf leaf;
+  pchmatrix *src;
+};
+
+static    uint
+leaf_leq(uint i, uint j, void *data)
+{
+  struct _sortdata *sd = (struct _sortdata *) data;
+
+  return (sd->leaf[i].roff < sd->leaf[j].roff ||
+	  (sd->leaf[i].roff == sd->leaf[j].roff &&
+	   sd->leaf[i].coff <= sd->leaf[j].coff));
+}
+
+static void
+leaf_swap(uint i, uint j, void *data)
+{
+  struct _sortdata *sd = (struct _sortdata *) data;
+  flatleaf  lt;
+  pchmatrix st;
+
+  lt = sd->leaf[i];
+  sd->leaf[i] = sd->leaf[j];
+  sd->leaf[j] = lt;
+
+  st = sd->src[i];
+  sd->src[i] = sd->src[j];
+  sd->src[j] = st;
+}
+
+static void
+copy_coeffs(pcamatrix a, pfield data)
+{
+  uint      i, j;
+
+  for (j = 0; j < a->cols; j++)
+    for (i = 0; i < a->rows; i++)
+      data[i + (size_t) j * a->rows] = a->a[i + (size_t) j * a->ld];
+}
+
+static void
+copy_single_coeffs(pcamatrix a, psfield data)
+{
+  uint      i, j;
+
+  for (j = 0; j < a->cols; j++)
+    for (i = 0; i < a->rows; i++)
+      data[i + (size_t) j * a->rows] = (sfield) a->a[i + (size_t) j * a->ld];
+}
+
+static    bool
+single_sufficient(pcrkmatrix r, real eps)
+{
+  amatrix   gtmp, htmp;
+  pamatrix  G, H;
+  real      norm, norma, normb;
+
+  /* |A B^*|_F^2 = trace((A^* A) (B^* B)) */
+  G = init_amatrix(&gtmp, r->k, r->k);
+  clear_amatrix(G);
+  addmul_amatrix(f_one, true, &r->A, false, &r->A, G);
+
+  H = init_amatrix(&htmp, r->k, r->k);
+  clear_amatrix(H);
+  addmul_amatrix(f_one, true, &r->B, false, &r->B, H);
+
+  norm = REAL_SQRT(REAL_ABS(dotprod_amatrix(G, H)));
+
+  uninit_amatrix(H);
+  uninit_amatrix(G);
+
+  norma = normfrob_amatrix(&r->A);
+  normb = normfrob_amatrix(&r->B);
+
+  return (FLT_EPSILON * norma * normb <= eps * norm);
+}
+
+pflathmatrix
+build_from_hmatrix_flathmatrix(pchmatrix hm)
+{
+  return build_from_hmatrix_mixed_flathmatrix(hm, 0.0);
+}
+
+pflathmatrix
+build_from_hmatrix_mixed_flathmatrix(pchmatrix hm, real eps)
+{
+  struct _sortdata sd;
+  pflathmatrix fh;
+  pchmatrix *src;
+  pflatleaf leaf;
+  size_t    sz;
+  uint      n;
+
+  fh = (pflathmatrix) allocmem(sizeof(flathmatrix));
+
+  fh->rc = hm->rc;
+  fh->cc = hm->cc;
+
+  fh->leaves = 0;
+  count_leaves(hm, &fh->leaves);
+
+  fh->leaf = (pflatleaf) allocmem((size_t) sizeof(flatleaf) * fh->leaves);
+  src = (pchmatrix *) allocmem((size_t) sizeof(pchmatrix) * fh->leaves);
+
+  n = 0;
+  collect_leaves(hm, 0, 0, fh->leaf, src, &n);
+  assert(n == fh->leaves);
+
+  /* Sort by row offset, then by column offset */
+  sd.leaf = fh->leaf;
+  sd.src = src;
+  heapsort(fh->leaves, leaf_leq, leaf_swap, &sd);
+
+  /* Choose the precision of every leaf and compute offsets */
+  fh->size = 0;
+  fh->ssize = 0;
+  fh->maxk = 0;
+  for (n = 0; n < fh->leaves; n++) {
+    leaf = fh->leaf + n;
+
+    if (leaf->k > 0) {
+      leaf->single = (eps > 0.0 && single_sufficient(src[n]->r, eps));
+      sz = (size_t) (leaf->rows + leaf->cols) * leaf->k;
+
+      if (leaf->k > fh->maxk)
+	fh->maxk = leaf->k;
+    }
+    else
+      sz = (size_t) leaf->rows * leaf->cols;
+
+    if (leaf->single) {
+      leaf->off = fh->ssize;
+      fh->ssize += sz;
+    }
+    else {
+      leaf->off = fh->size;
+      fh->size += sz;
+    }
+  }
+
+  /* Copy coefficients in the order of the sorted leaf list */
+  fh->data = allocfield(fh->size);
+  fh->sdata = (psfield) allocmem((size_t) sizeof(sfield) * fh->ssize);
+  for (n = 0; n < fh->leaves; n++) {
+    leaf = fh->leaf + n;
+
+    if (leaf->single) {
+      copy_single_coeffs(&src[n]->r->A, fh->sdata + leaf->off);
+      copy_single_coeffs(&src[n]->r->B, fh->sdata + leaf->off
+			 + (size_t) leaf->rows * leaf->k);
+    }
+    else if (leaf->k > 0) {
+      copy_coeffs(&src[n]->r->A, fh->data + leaf->off);
+      copy_coeffs(&src[n]->r->B, fh->data + leaf->off
+		  + (size_t) leaf->rows * leaf->k);
+    }
+    else
+      copy_coeffs(src[n]->f, fh->data + leaf->off);
+  }
+
+  freemem(src);
+
+  return fh;
+}
+
+void
+del_flathmatrix(pflathmatrix fh)
+{
+  freemem(fh->sdata);
+  freemem(fh->data);
+  freemem(fh->leaf);
+  freemem(fh);
+}
+
+/* ------------------------------------------------------------
+   Statistics
+   ------------------------------------------------------------ */
+
+size_t
+getsize_flathmatrix(pcflathmatrix fh)
+{
+  size_t    sz;
+
+  sz = (size_t) sizeof(flathmatrix);
+  sz += (size_t) sizeof(flatleaf) * fh->leaves;
+  sz += (size_t) sizeof(field) * fh->size;
+  sz += (size_t) sizeof(sfield) * fh->ssize;
+
+  return sz;
+}
+
+/* ------------------------------------------------------------
+   Matrix-vector multiplication
+   ------------------------------------------------------------ */
+
+#ifdef USE_BLAS
+IMPORT_PREFIX void
+dgemv_(const char *trans,
+       const LAPACK_INT * m,
+       const LAPACK_INT * n,
+       const double *alpha,
+       const double *a,
+       const LAPACK_INT * lda,
+       const double *x,
+       const LAPACK_INT * incx, const double *beta, double *y,
+       const LAPACK_INT * incy);
+
+static void
+eval_leaf(uint rows, uint cols, field alpha, pcfield a, pcfield x, pfield y)
+{
+  LAPACK_INT a_rows = rows;
+  LAPACK_INT a_cols = cols;
+
+  if (rows > 0 && cols > 0)
+    dgemv_("Not Transposed", &a_rows, &a_cols, &alpha, a, &a_rows,
+	   x, &l_one, &f_one, y, &l_one);
+}
+
+static void
+evaltrans_leaf(uint rows, uint cols, field alpha, pcfield a, pcfield x,
+	       pfield y)
+{
+  LAPACK_INT a_rows = rows;
+  LAPACK_INT a_cols = cols;
+
+  if (rows > 0 && cols > 0)
+    dgemv_("Transposed", &a_rows, &a_cols, &alpha, a, &a_rows,
+	   x, &l_one, &f_one, y, &l_one);
+}
+#else
+static void
+eval_leaf(uint rows, uint cols, field alpha, pcfield a, pcfield x, pfield y)
+{
+  field     xj;
+  uint      i, j;
+
+  for (j = 0; j < cols; j++) {
+    xj = alpha * x[j];
+    for (i = 0; i < rows; i++)
+      y[i] += a[i + (size_t) j * rows] * xj;
+  }
+}
+
+static void
+evaltrans_leaf(uint rows, uint cols, field alpha, pcfield a, pcfield x,
+	       pfield y)
+{
+  field     sum;
+  uint      i, j;
+
+  for (j = 0; j < cols; j++) {
+    sum = f_zero;
+    for (i = 0; i < rows; i++)
+      sum += CONJ(a[i + (size_t) j * rows]) * x[i];
+    y[j] += alpha * sum;
+  }
+}
+#endif
+
+/* Single-precision coefficients are converted to field while they
+   are used, so all computations are carried out in full precision */
+
+static void
+eval_single_leaf(uint rows, uint cols, field alpha, pcsfield a, pcfield x,
+		 pfield y)
+{
+  field     xj;
+  uint      i, j;
+
+  for (j = 0; j < cols; j++) {
+    xj = alpha * x[j];
+    for (i = 0; i < rows; i++)
+      y[i] += (field) a[i + (size_t) j * rows] * xj;
+  }
+}
+
+static void
+evaltrans_single_leaf(uint rows, uint cols, field alpha, pcsfield a,
+		      pcfield x, pfield y)
+{
+  field     sum;
+  uint      i, j;
+
+  for (j = 0; j < cols; j++) {
+    sum = f_zero;
+    for (i = 0; i < rows; i++)
+      sum += CONJ((field) a[i + (size_t) j * rows]) * x[i];
+    y[j] += alpha * sum;
+  }
+}
+
+void
+fastaddeval_flathmatrix_avector(field alpha, pcflathmatrix fh,
+				pcavector xp, pavector yp)
+{
+  pcflatleaf leaf;
+  pcfield   a, b;
+  pcsfield  sa, sb;
+  pfield    t;
+  uint      i, n;
+
+  assert(xp->dim == fh->cc->size);
+  assert(yp->dim == fh->rc->size);
+
+  t = allocfield(fh->maxk);
+
+  for (n = 0; n < fh->leaves; n++) {
+    leaf = fh->leaf + n;
+
+    if (leaf->single) {
+      sa = fh->sdata + leaf->off;
+      sb = sa + (size_t) leaf->rows * leaf->k;
+
+      for (i = 0; i < leaf->k; i++)
+	t[i] = f_zero;
+      evaltrans_single_leaf(leaf->cols, leaf->k, f_one, sb,
+			    xp->v + leaf->coff, t);
+      eval_single_leaf(leaf->rows, leaf->k, alpha, sa, t,
+		       yp->v + leaf->roff);
+    }
+    else if (leaf->k > 0) {
+      a = fh->data + leaf->off;
+      b = a + (size_t) leaf->rows * leaf->k;
+
+      /* t = B^* x, y = y + alpha A t */
+      for (i = 0; i < leaf->k; i++)
+	t[i] = f_zero;
+      evaltrans_leaf(leaf->cols, leaf->k, f_one, b, xp->v + leaf->coff, t);
+      eval_leaf(leaf->rows, leaf->k, alpha, a, t, yp->v + leaf->roff);
+    }
+    else
+      eval_leaf(leaf->rows, leaf->cols, alpha, fh->data + leaf->off,
+		xp->v + leaf->coff, yp->v + leaf->roff);
+  }
+
+  freemem(t);
+}
+
+void
+addeval_flathmatrix_avector(field alpha, pcflathmatrix fh,
+			    pcavector x, pavector y)
+{
+  pavector  xp, yp;
+  avector   xtmp, ytmp;
+  uint      i, ip;
+
+  assert(x->dim == fh->cc->size);
+  assert(y->dim == fh->rc->size);
+
+  /* Permutation of x */
+  xp = init_avector(&xtmp, x->dim);
+  for (i = 0; i < xp->dim; i++) {
+    ip = fh->cc->idx[i];
+    assert(ip < x->dim);
+    xp->v[i] = x->v[ip];
+  }
+
+  /* Permutation of y */
+  yp = init_avector(&ytmp, y->dim);
+  for (i = 0; i < yp->dim; i++) {
+    ip = fh->rc->idx[i];
+    assert(ip < y->dim);
+    yp->v[i] = y->v[ip];
+  }
+
+  /* Matrix-vector multiplication */
+  fastaddeval_flathmatrix_avector(alpha, fh, xp, yp);
+
+  /* Reverse permutation of y */
+  for (i = 0; i < yp->dim; i++) {
+    ip = fh->rc->idx[i];
+    assert(ip < y->dim);
+    y->v[ip] = yp->v[i];
+  }
+
+  uninit_avector(yp);
+  uninit_avector(xp);
+}
+
+void
+fastaddevaltrans_flathmatrix_avector(field alpha, pcflathmatrix fh,
+				     pcavector xp, pavector yp)
+{
+  pcflatleaf leaf;
+  pcfield   a, b;
+  pcsfield  sa, sb;
+  pfield    t;
+  uint      i, n;
+
+  assert(xp->dim == fh->rc->size);
+  assert(yp->dim == fh->cc->size);
+
+  t = allocfield(fh->maxk);
+
+  for (n = 0; n < fh->leaves; n++) {
+    leaf = fh->leaf + n;
+
+    if (leaf->single) {
+      sa = fh->sdata + leaf->off;
+      sb = sa + (size_t) leaf->rows * leaf->k;
+
+      for (i = 0; i < leaf->k; i++)
+	t[i] = f_zero;
+      evaltrans_single_leaf(leaf->rows, leaf->k, f_one, sa,
+			    xp->v + leaf->roff, t);
+      eval_single_leaf(leaf->cols, leaf->k, alpha, sb, t,
+		       yp->v + leaf->coff);
+    }
+    else if (leaf->k > 0) {
+      a = fh->data + leaf->off;
+      b = a + (size_t) leaf->rows * leaf->k;
+
+      /* t = A^* x, y = y + alpha B t */
+      for (i = 0; i < leaf->k; i++)
+	t[i] = f_zero;
+      evaltrans_leaf(leaf->rows, leaf->k, f_one, a, xp->v + leaf->roff, t);
+      eval_leaf(leaf->cols, leaf->k, alpha, b, t, yp->v + leaf->coff);
+    }
+    else
+      evaltrans_leaf(leaf->rows, leaf->cols, alpha, fh->data + leaf->off,
+		     xp->v + leaf->roff, yp->v + leaf->coff);
+  }
+
+  freemem(t);
+}
+
+void
+addevaltrans_flathmatrix_avector(field alpha, pcflathmatrix fh,
+				 pcavector x, pavector y)
+{
+  pavector  xp, yp;
+  avector   xtmp, ytmp;
+  uint      i, ip;
+
+  assert(x->dim == fh->rc->size);
+  assert(y->dim == fh->cc->size);
+
+  /* Permutation of x */
+  xp = init_avector(&xtmp, x->dim);
+  for (i = 0; i < xp->dim; i++) {
+    ip = fh->rc->idx[i];
+    assert(ip < x->dim);
+    xp->v[i] = x->v[ip];
+  }
+
+  /* Permutation of y */
+  yp = init_avector(&ytmp, y->dim);
+  for (i = 0; i < yp->dim; i++) {
+    ip = fh->cc->idx[i];
+    assert(ip < y->dim);
+    yp->v[i] = y->v[ip];
+  }
+
+  /* Matrix-vector multiplication */
+  fastaddevaltrans_flathmatrix_avector(alpha, fh, xp, yp);
+
+  /* Reverse permutation of y */
+  for (i = 0; i < yp->dim; i++) {
+    ip = fh->cc->idx[i];
+    assert(ip < y->dim);
+    y->v[ip] = yp->v[i];
+  }
+
+  uninit_avector(yp);
+  uninit_avector(xp);
+}
+
+void
+mvm_flathmatrix_avector(field alpha, bool atrans, pcflathmatrix fh,
+			pcavector x, pavector y)
+{
+  if (atrans)
+    addevaltrans_flathmatrix_avector(alpha, fh, x, y);
+  else
+    addeval_flathmatrix_avector(alpha, fh, x, y);
+}
@@ -0,0 +1,222 @@
+
+/* ------------------------------------------------------------
+   This is the file "flathmatrix.h" of the H2Lib package.
+   All rights reserved, Steffen Boerm 2015
+   ------------------------------------------------------------ */
+
+/** @file flathmatrix.h
+ *  @author Steffen B&ouml;rm
+ */
+
+#ifndef FLATHMATRIX_H
+#define FLATHMATRIX_H
+
+/** @defgroup flathmatrix flathmatrix
+ *  @brief Read-only flat representation of a hierarchical matrix.
+ *
+ *  The @ref flathmatrix class stores the leaves of an @ref hmatrix
+ *  in a single list sorted by row offset, and all nearfield and
+ *  farfield coefficients in one contiguous array.
+ *  Matrix-vector multiplications can then be carried out by
+ *  running once through this array, without following the
+ *  pointers of the block tree.
+ *
+ *  Low-rank leaves can optionally be stored in single precision
+ *  if this is sufficient for a given accuracy, halving their storage
+ *  requirements. Their coefficients are converted back to double
+ *  precision during the matrix-vector multiplication.
+ *  @{ */
+
+/** @brief Flat representation of a hierarchical matrix. */
+typedef struct _flathmatrix flathmatrix;
+
+/** @brief Pointer to a @ref flathmatrix object. */
+typedef flathmatrix *pflathmatrix;
+
+/** @brief Pointer to a constant @ref flathmatrix object. */
+typedef const flathmatrix *pcflathmatrix;
+
+/** @brief Leaf of a @ref flathmatrix. */
+typedef struct _flatleaf flatleaf;
+
+/** @brief Pointer to a @ref flatleaf object. */
+typedef flatleaf *pflatleaf;
+
+/** @brief Pointer to a constant @ref flatleaf object. */
+typedef const flatleaf *pcflatleaf;
+
+#include "hmatrix.h"
+#include "settings.h"
+
+/** @brief Description of a leaf of a @ref flathmatrix.
+ *
+ *  Dense leaves are stored column by column with leading dimension
+ *  <tt>rows</tt>.
+ *  Low-rank leaves @f$A B^*@f$ are stored as the factor @f$A@f$ with
+ *  leading dimension <tt>rows</tt>, followed by @f$B@f$ with leading
+ *  dimension <tt>cols</tt>. */
+struct _flatleaf {
+  /** @brief Offset of the row cluster in the numbering of the root. */
+  uint roff;
+  /** @brief Offset of the column cluster in the numbering of the root. */
+  uint coff;
+  /** @brief Number of rows. */
+  uint rows;
+  /** @brief Number of columns. */
+  uint cols;
+  /** @brief Rank of a low-rank leaf, zero for a dense leaf. */
+  uint k;
+  /** @brief Set if the coefficients are stored in <tt>sdata</tt>
+   *  instead of <tt>data</tt>. */
+  bool single;
+  /** @brief Offset of the coefficients in <tt>data</tt> or
+   *  <tt>sdata</tt>. */
+  size_t off;
+};
+
+/** @brief Flat representation of a hierarchical matrix. */
+struct _flathmatrix {
+  /** @brief Row cluster of the original matrix. */
+  pccluster rc;
+  /** @brief Column cluster of the original matrix. */
+  pccluster cc;
+
+  /** @brief Number of leaves. */
+  uint leaves;
+  /** @brief Leaves, sorted by row offset and then column offset. */
+  pflatleaf leaf;
+
+  /** @brief Maximal rank of all low-rank leaves. */
+  uint maxk;
+
+  /** @brief Number of coefficients in <tt>data</tt>. */
+  size_t size;
+  /** @brief Coefficients of all leaves stored in double precision. */
+  pfield data;
+
+  /** @brief Number of coefficients in <tt>sdata</tt>. */
+  size_t ssize;
+  /** @brief Coefficients of all leaves stored in single precision. */
+  psfield sdata;
+};
+
+/* ------------------------------------------------------------
+   Constructors and destructors
+   ------------------------------------------------------------ */
+
+/** @brief Create a flat copy of an @ref hmatrix.
+ *
+ *  The coefficients of all leaves of <tt>hm</tt> are copied into one
+ *  contiguous array, so the original matrix can be changed or deleted
+ *  afterwards. The cluster trees <tt>hm->rc</tt> and <tt>hm->cc</tt>
+ *  are only referenced and have to stay alive.
+ *
+ *  @remark Should always be matched by a call to @ref del_flathmatrix.
+ *
+ *  @param hm Source matrix.
+ *  @returns New @ref flathmatrix object. */
+HEADER_PREFIX pflathmatrix
+build_from_hmatrix_flathmatrix(pchmatrix hm);
+
+/** @brief Create a flat copy of an @ref hmatrix, storing low-rank
+ *  leaves in single precision where possible.
+ *
+ *  A low-rank leaf @f$A B^*@f$ is stored in single precision if
+ *  the resulting rounding error, estimated by
+ *  @f$\epsilon_{\rm single} \|A\|_F \|B\|_F@f$, is bounded by
+ *  @f$\epsilon \|A B^*\|_F@f$.
+ *  Dense leaves are always stored in double precision.
+ *
+ *  @remark Should always be matched by a call to @ref del_flathmatrix.
+ *
+ *  @param hm Source matrix.
+ *  @param eps Relative accuracy required for every low-rank leaf,
+ *         zero to store all leaves in double precision.
+ *  @returns New @ref flathmatrix object. */
+HEADER_PREFIX pflathmatrix
+build_from_hmatrix_mixed_flathmatrix(pchmatrix hm, real eps);
+
+/** @brief Delete a @ref flathmatrix object.
+ *
+ *  @param fh Object to be deleted. */
+HEADER_PREFIX void
+del_flathmatrix(pflathmatrix fh);
+
+/* ------------------------------------------------------------
+   Statistics
+   ------------------------------------------------------------ */
+
+/** @brief Get size of a given @ref flathmatrix object.
+ *
+ *  @param fh Flat matrix.
+ *  @returns Size of allocated storage in bytes. */
+HEADER_PREFIX size_t
+getsize_flathmatrix(pcflathmatrix fh);
+
+/* ------------------------------------------------------------
+   Matrix-vector multiplication
+   ------------------------------------------------------------ */
+
+/** @brief Matrix-vector multiplication
+ *  @f$y \gets y + \alpha A x@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param fh Matrix @f$A@f$.
+ *  @param xp Source vector @f$x@f$ in cluster numbering
+ *            with respect to <tt>fh->cc</tt>.
+ *  @param yp Target vector @f$y@f$ in cluster numbering
+ *            with respect to <tt>fh->rc</tt>. */
+HEADER_PREFIX void
+fastaddeval_flathmatrix_avector(field alpha, pcflathmatrix fh,
+				pcavector xp, pavector yp);
+
+/** @brief Matrix-vector multiplication
+ *  @f$y \gets y + \alpha A x@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param fh Matrix @f$A@f$.
+ *  @param x Source vector @f$x@f$.
+ *  @param y Target vector @f$y@f$. */
+HEADER_PREFIX void
+addeval_flathmatrix_avector(field alpha, pcflathmatrix fh,
+			    pcavector x, pavector y);
+
+/** @brief Adjoint matrix-vector multiplication
+ *  @f$y \gets y + \alpha A^* x@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param fh Matrix @f$A@f$.
+ *  @param xp Source vector @f$x@f$ in cluster numbering
+ *            with respect to <tt>fh->rc</tt>.
+ *  @param yp Target vector @f$y@f$ in cluster numbering
+ *            with respect to <tt>fh->cc</tt>. */
+HEADER_PREFIX void
+fastaddevaltrans_flathmatrix_avector(field alpha, pcflathmatrix fh,
+				     pcavector xp, pavector yp);
+
+/** @brief Adjoint matrix-vector multiplication
+ *  @f$y \gets y + \alpha A^* x@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param fh Matrix @f$A@f$.
+ *  @param x Source vector @f$x@f$.
+ *  @param y Target vector @f$y@f$. */
+HEADER_PREFIX void
+addevaltrans_flathmatrix_avector(field alpha, pcflathmatrix fh,
+				 pcavector x, pavector y);
+
+/** @brief Matrix-vector multiplication
+ *  @f$y \gets y + \alpha A x@f$ or @f$y \gets y + \alpha A^* x@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param atrans Set if @f$A^*@f$ is to be used instead of @f$A@f$.
+ *  @param fh Matrix @f$A@f$.
+ *  @param x Source vector @f$x@f$.
+ *  @param y Target vector @f$y@f$. */
+HEADER_PREFIX void
+mvm_flathmatrix_avector(field alpha, bool atrans, pcflathmatrix fh,
+			pcavector x, pavector y);
+
+/** @} */
+
+#endif
@@ -7,6 +7,7 @@
 #include "h2compression.h"
 
 #include "h2update.h"
+#include "harith.h"
 #include "eigensolvers.h"
 #include "factorizations.h"
 #include "basic.h"
@@ -3035,6 +3036,74 @@ convert_rkmatrix_uniform(pcrkmatrix r, puniform u, pctruncmode tm,
    H-matrix blocks
    ------------------------------------------------------------ */
 
+/* Sample Y = Ahat Omega for the randomized range finder */
+static void
+sample_comp(void *data, pcamatrix omega, pamatrix y)
+{
+  addmul_amatrix(1.0, false, (pcamatrix) data, false, omega, y);
+}
+
+/* Find the leading left singular vectors of the combined matrix Ahat
+ * and store them in the first columns of Q, Ahat is overwritten.
+ * If tm->randomized is set, an orthonormal basis P of the approximate
+ * range is found by random sampling, so that only the small matrix
+ * P^* Ahat has to be treated by a singular value decomposition.
+ * Returns the rank chosen by the truncation strategy. */
+static    uint
+leftsingular_comp(pamatrix Ahat, pctruncmode tm, real eps, pamatrix Q)
+{
+  amatrix   tmp1, tmp2, tmp3, tmp4;
+  avector   tmp5;
+  pamatrix  P, B, U, Q1;
+  pavector  sigma;
+  uint      m, n, k, l;
+
+  m = Ahat->rows;
+  n = Ahat->cols;
+  k = UINT_MIN(m, n);
+
+  /* Sampling does not pay off for small matrices */
+  if (tm && tm->randomized && k > 32) {
+    l = findrange_randomized(tm, eps, m, n, sample_comp, Ahat, Q);
+
+    P = init_amatrix(&tmp1, m, l);
+    Q1 = init_sub_amatrix(&tmp2, Q, m, 0, l, 0);
+    copy_amatrix(false, Q1, P);
+    uninit_amatrix(Q1);
+
+    B = init_amatrix(&tmp2, l, n);
+    clear_amatrix(B);
+    addmul_amatrix(1.0, true, P, false, Ahat, B);
+
+    U = init_amatrix(&tmp3, l, l);
+    sigma = init_avector(&tmp5, l);
+    svd_amatrix(B, sigma, U, 0);
+    uninit_amatrix(B);
+
+    k = findrank_truncmode(tm, eps, sigma);
+    uninit_avector(sigma);
+
+    /* Left singular vectors of Ahat are given by P U */
+    B = init_sub_amatrix(&tmp2, U, l, 0, k, 0);
+    Q1 = init_sub_amatrix(&tmp4, Q, m, 0, k, 0);
+    clear_amatrix(Q1);
+    addmul_amatrix(1.0, false, P, false, B, Q1);
+    uninit_amatrix(Q1);
+    uninit_amatrix(B);
+    uninit_amatrix(U);
+    uninit_amatrix(P);
+  }
+  else {
+    sigma = init_avector(&tmp5, k);
+    svd_amatrix(Ahat, sigma, Q, 0);
+
+    k = findrank_truncmode(tm, eps, sigma);
+    uninit_avector(sigma);
+  }
+
+  return k;
+}
+
 typedef struct _hcompactive hcompactive;
 typedef hcompactive *phcompactive;
 
@@ -3251,10 +3320,8 @@ buildbasis_hcomp(pccluster t, bool colbasis,
 {
   pclusterbasis cb, cb1;
   amatrix   tmp1, tmp2, tmp3, tmp4;
-  avector   tmp5;
   pamatrix  Ahat, Ahat0, Ahat1;
   pamatrix  Q, Q1;
-  pavector  sigma;
   phcompactive active1, ha, ha1;
   phcomppassive passive1, hp;
   real      zeta_age, zeta_level;
@@ -3369,17 +3436,11 @@ buildbasis_hcomp(pccluster t, bool colbasis,
   }
   assert(n == Ahat->cols);
 
-  /* Compute singular value decomposition */
-  k = UINT_MIN(m, n);
+  /* Compute singular value decomposition and find appropriate rank */
   Q = init_amatrix(&tmp2, m, n);
-  sigma = init_avector(&tmp5, k);
-  svd_amatrix(Ahat, sigma, Q, 0);
+  k = leftsingular_comp(Ahat, tm, eps, Q);
   uninit_amatrix(Ahat);
 
-  /* Find appropriate rank */
-  k = findrank_truncmode(tm, eps, sigma);
-  uninit_avector(sigma);
-
   /* Set rank of new cluster basis */
   resize_clusterbasis(cb, k);
 
@@ -3728,10 +3789,8 @@ buildbasis_comp(pccluster t, bool colbasis,
 {
   pclusterbasis cb, cb1;
   amatrix   tmp1, tmp2, tmp3, tmp4;
-  avector   tmp5;
   pamatrix  Ahat, Ahat0, Ahat1;
   pamatrix  Q, Q1;
-  pavector  sigma;
   pcompactive active1, ca, ca1;
   pcomppassive passive1, cp;
   real      zeta_age, zeta_level;
@@ -3847,17 +3906,11 @@ buildbasis_comp(pccluster t, bool colbasis,
   }
   assert(n == Ahat->cols);
 
-  /* Compute singular value decomposition */
-  k = UINT_MIN(m, n);
+  /* Compute singular value decomposition and find appropriate rank */
   Q = init_amatrix(&tmp2, m, n);
-  sigma = init_avector(&tmp5, k);
-  svd_amatrix(Ahat, sigma, Q, 0);
+  k = leftsingular_comp(Ahat, tm, eps, Q);
   uninit_amatrix(Ahat);
 
-  /* Find appropriate rank */
-  k = findrank_truncmode(tm, eps, sigma);
-  uninit_avector(sigma);
-
   /* Set rank of new cluster basis */
   resize_clusterbasis(cb, k);
 
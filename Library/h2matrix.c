@@ -12,13 +12,9 @@
  Constructors and destructors
  ------------------------------------------------------------ */
 
-ph2matrix
-new_h2matrix(pclusterbasis rb, pclusterbasis cb)
+static ph2matrix
+init_h2matrix(ph2matrix h2, pclusterbasis rb, pclusterbasis cb)
 {
-  ph2matrix h2;
-
-  h2 = allocmem(sizeof(h2matrix));
-
   h2->rb = h2->cb = NULL;
 
   ref_clusterbasis(&h2->rb, rb);
@@ -33,9 +29,21 @@ new_h2matrix(pclusterbasis rb, pclusterbasis cb)
   h2->refs = 0;
   h2->desc = 0;
 
+  h2->arena = NULL;
+
   return h2;
 }
 
+ph2matrix
+new_h2matrix(pclusterbasis rb, pclusterbasis cb)
+{
+  ph2matrix h2;
+
+  h2 = allocmem(sizeof(h2matrix));
+
+  return init_h2matrix(h2, rb, cb);
+}
+
 ph2matrix
 new_uniform_h2matrix(pclusterbasis rb, pclusterbasis cb)
 {
@@ -241,19 +249,33 @@ del_h2matrix(ph2matrix h2)
     for (j = 0; j < csons; j++)
       for (i = 0; i < rsons; i++)
 	unref_h2matrix(h2->son[i + j * rsons]);
-    freemem(h2->son);
+    if (h2->arena == NULL || !contains_arena(h2->arena, h2->son))
+      freemem(h2->son);
   }
 
-  if (h2->f)
-    del_amatrix(h2->f);
+  /* Objects taken from the arena are released together with it,
+     objects attached later, e.g., by h2update, are released here */
+  if (h2->f) {
+    if (h2->arena && contains_arena(h2->arena, h2->f))
+      uninit_amatrix(h2->f);
+    else
+      del_amatrix(h2->f);
+  }
 
-  if (h2->u)
-    del_uniform(h2->u);
+  if (h2->u) {
+    if (h2->arena && contains_arena(h2->arena, h2->u))
+      uninit_uniform(h2->u);
+    else
+      del_uniform(h2->u);
+  }
 
   unref_clusterbasis(h2->cb);
   unref_clusterbasis(h2->rb);
 
-  freemem(h2);
+  if (h2->arena)
+    unref_arena(h2->arena);
+  else
+    freemem(h2);
 }
 
 /* ------------------------------------------------------------
@@ -287,6 +309,20 @@ unref_h2matrix(ph2matrix h2)
  Statistics
  ------------------------------------------------------------ */
 
+/* Coefficients of nearfield leaves taken from an arena are not owned
+   by their amatrix, but still belong to the h2matrix */
+static size_t
+getsize_nearfield(pch2matrix h2)
+{
+  size_t    sz;
+
+  sz = getsize_amatrix(h2->f);
+  if (h2->f->owner && h2->arena && contains_arena(h2->arena, h2->f->a))
+    sz += (size_t) sizeof(field) * h2->f->rows * h2->f->cols;
+
+  return sz;
+}
+
 size_t
 getsize_h2matrix(pch2matrix h2)
 {
@@ -301,7 +337,7 @@ getsize_h2matrix(pch2matrix h2)
     sz += getsize_uniform(h2->u);
 
   if (h2->f)
-    sz += getsize_amatrix(h2->f);
+    sz += getsize_nearfield(h2);
 
   for (j = 0; j < csons; j++)
     for (i = 0; i < rsons; i++)
@@ -321,7 +357,7 @@ getnearsize_h2matrix(pch2matrix h2)
   sz = 0;
 
   if (h2->f)
-    sz += getsize_amatrix(h2->f);
+    sz += getsize_nearfield(h2);
 
   for (j = 0; j < csons; j++)
     for (i = 0; i < rsons; i++)
@@ -426,6 +462,114 @@ build_from_block_h2matrix(pcblock b, pclusterbasis rb, pclusterbasis cb)
   return h;
 }
 
+static size_t
+arenasize_block(pcblock b)
+{
+  size_t    sz;
+  uint      i;
+
+  /* Leave room for padding of every object */
+  sz = sizeof(h2matrix) + 16;
+
+  if (b->son) {
+    sz += sizeof(ph2matrix) * b->rsons * b->csons + 16;
+
+    for (i = 0; i < b->rsons * b->csons; i++)
+      sz += arenasize_block(b->son[i]);
+  }
+  else if (b->a > 0)
+    sz += sizeof(uniform) + 16;
+  else
+    sz += sizeof(amatrix) + 16
+      + (size_t) sizeof(field) * b->rc->size * b->cc->size + 16;
+
+  return sz;
+}
+
+static ph2matrix
+new_arena_h2matrix(parena pa, pclusterbasis rb, pclusterbasis cb)
+{
+  ph2matrix h2;
+
+  h2 = (ph2matrix) allocarena(pa, sizeof(h2matrix));
+
+  init_h2matrix(h2, rb, cb);
+
+  ref_arena(&h2->arena, pa);
+
+  return h2;
+}
+
+static ph2matrix
+build_from_block_arena(pcblock b, pclusterbasis rb, pclusterbasis cb,
+		       parena pa)
+{
+  ph2matrix h, h1;
+  pcblock   b1;
+  pclusterbasis rb1, cb1;
+  uint      rsons, csons;
+  uint      i, j;
+
+  h = new_arena_h2matrix(pa, rb, cb);
+
+  if (b->son) {
+    rsons = b->rsons;
+    csons = b->csons;
+
+    h->rsons = rsons;
+    h->csons = csons;
+
+    h->son = (ph2matrix *) allocarena(pa, (size_t) sizeof(ph2matrix)
+				      * rsons * csons);
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++) {
+	b1 = b->son[i + j * rsons];
+
+	rb1 = rb;
+	if (b1->rc != b->rc) {
+	  assert(rb->sons == rsons);
+	  rb1 = rb->son[i];
+	}
+
+	cb1 = cb;
+	if (b1->cc != b->cc) {
+	  assert(cb->sons == csons);
+	  cb1 = cb->son[j];
+	}
+
+	h->son[i + j * rsons] = NULL;
+
+	h1 = build_from_block_arena(b1, rb1, cb1, pa);
+
+	ref_h2matrix(h->son + i + j * rsons, h1);
+      }
+  }
+  else if (b->a > 0)
+    h->u = init_uniform((puniform) allocarena(pa, sizeof(uniform)), rb, cb);
+  else
+    h->f = init_pointer_amatrix((pamatrix) allocarena(pa, sizeof(amatrix)),
+				(pfield) allocarena(pa, (size_t) sizeof(field)
+						    * rb->t->size
+						    * cb->t->size),
+				rb->t->size, cb->t->size);
+
+  update_h2matrix(h);
+
+  return h;
+}
+
+ph2matrix
+build_from_block_arena_h2matrix(pcblock b, pclusterbasis rb,
+				pclusterbasis cb)
+{
+  parena    pa;
+
+  pa = new_arena(arenasize_block(b));
+
+  return build_from_block_arena(b, rb, cb, pa);
+}
+
 /* ------------------------------------------------------------
  Build block tree from H^2-matrix
  ------------------------------------------------------------ */
@@ -1223,6 +1367,74 @@ fastaddeval_h2matrix_avector(field alpha, pch2matrix h2, pavector xt,
   }
 }
 
+void
+fastaddeval_parallel_h2matrix_avector(field alpha, pch2matrix h2,
+				      pavector xt, pavector yt,
+				      uint pardepth)
+{
+  pavector *xt1, *yt1;
+  pcclusterbasis rb = h2->rb;
+  pcclusterbasis cb = h2->cb;
+  uint      rsons = h2->rsons;
+  uint      csons = h2->csons;
+#ifdef USE_OPENMP
+  uint      nthreads;		/* HACK: Solaris workaround */
+#endif
+  uint      xtoff, ytoff;
+  uint      i, j;
+
+  if (pardepth == 0 || h2->son == NULL) {
+    fastaddeval_h2matrix_avector(alpha, h2, xt, yt);
+    return;
+  }
+
+  /* Coefficients of the column sons are only read */
+  xt1 = (pavector *) allocmem((size_t) sizeof(pavector) * csons);
+  xtoff = cb->k;
+  for (j = 0; j < csons; j++) {
+    assert(csons == 1 || cb->sons > 0);
+    xt1[j] = (cb->sons > 0 ?
+	      new_sub_avector(xt, cb->son[j]->ktree, xtoff) :
+	      new_sub_avector(xt, cb->ktree, 0));
+
+    xtoff += (cb->sons > 0 ? cb->son[j]->ktree : cb->t->size);
+  }
+  assert(xtoff == cb->ktree);
+
+  /* Each row son owns the coefficients of its subtree */
+  yt1 = (pavector *) allocmem((size_t) sizeof(pavector) * rsons);
+  ytoff = rb->k;
+  for (i = 0; i < rsons; i++) {
+    assert(rsons == 1 || rb->sons > 0);
+    yt1[i] = (rb->sons > 0 ?
+	      new_sub_avector(yt, rb->son[i]->ktree, ytoff) :
+	      new_sub_avector(yt, rb->ktree, 0));
+
+    ytoff += (rb->sons > 0 ? rb->son[i]->ktree : rb->t->size);
+  }
+  assert(ytoff == rb->ktree);
+
+  /* Row sons are handled in parallel, blocks within a row in the
+     same order as in fastaddeval_h2matrix_avector */
+#ifdef USE_OPENMP
+  nthreads = rsons;
+  (void) nthreads;
+#pragma omp parallel for if(pardepth > 0), num_threads(nthreads), private(j)
+#endif
+  for (i = 0; i < rsons; i++)
+    for (j = 0; j < csons; j++)
+      fastaddeval_parallel_h2matrix_avector(alpha, h2->son[i + j * rsons],
+					    xt1[j], yt1[i], pardepth - 1);
+
+  for (i = 0; i < rsons; i++)
+    del_avector(yt1[i]);
+  freemem(yt1);
+
+  for (j = 0; j < csons; j++)
+    del_avector(xt1[j]);
+  freemem(xt1);
+}
+
 void
 addeval_h2matrix_avector(field alpha, pch2matrix h2, pcavector x, pavector y)
 {
@@ -1235,7 +1447,11 @@ addeval_h2matrix_avector(field alpha, pch2matrix h2, pcavector x, pavector y)
 
   forward_clusterbasis_avector(h2->cb, x, xt);
 
+#ifdef USE_OPENMP
+  fastaddeval_parallel_h2matrix_avector(alpha, h2, xt, yt, max_pardepth);
+#else
   fastaddeval_h2matrix_avector(alpha, h2, xt, yt);
+#endif
 
   backward_clusterbasis_avector(h2->rb, yt, y);
 
@@ -1243,6 +1459,27 @@ addeval_h2matrix_avector(field alpha, pch2matrix h2, pcavector x, pavector y)
   del_avector(xt);
 }
 
+void
+addeval_parallel_h2matrix_avector(field alpha, pch2matrix h2, pcavector x,
+				  pavector y, uint pardepth)
+{
+  pavector  xt, yt;
+
+  xt = new_coeffs_clusterbasis_avector(h2->cb);
+  yt = new_coeffs_clusterbasis_avector(h2->rb);
+
+  clear_avector(yt);
+
+  forward_parallel_clusterbasis_avector(h2->cb, x, xt, pardepth);
+
+  fastaddeval_parallel_h2matrix_avector(alpha, h2, xt, yt, pardepth);
+
+  backward_parallel_clusterbasis_avector(h2->rb, yt, y, pardepth);
+
+  del_avector(yt);
+  del_avector(xt);
+}
+
 void
 fastaddevaltrans_h2matrix_avector(field alpha, pch2matrix h2, pavector xt,
 				  pavector yt)
@@ -1300,6 +1537,76 @@ fastaddevaltrans_h2matrix_avector(field alpha, pch2matrix h2, pavector xt,
   }
 }
 
+void
+fastaddevaltrans_parallel_h2matrix_avector(field alpha, pch2matrix h2,
+					   pavector xt, pavector yt,
+					   uint pardepth)
+{
+  pavector *xt1, *yt1;
+  pcclusterbasis rb = h2->rb;
+  pcclusterbasis cb = h2->cb;
+  uint      rsons = h2->rsons;
+  uint      csons = h2->csons;
+#ifdef USE_OPENMP
+  uint      nthreads;		/* HACK: Solaris workaround */
+#endif
+  uint      xtoff, ytoff;
+  uint      i, j;
+
+  if (pardepth == 0 || h2->son == NULL) {
+    fastaddevaltrans_h2matrix_avector(alpha, h2, xt, yt);
+    return;
+  }
+
+  /* Coefficients of the row sons are only read */
+  xt1 = (pavector *) allocmem((size_t) sizeof(pavector) * rsons);
+  xtoff = rb->k;
+  for (i = 0; i < rsons; i++) {
+    assert(rsons == 1 || rb->sons > 0);
+    xt1[i] = (rb->sons > 0 ?
+	      new_sub_avector(xt, rb->son[i]->ktree, xtoff) :
+	      new_sub_avector(xt, rb->ktree, 0));
+
+    xtoff += (rb->sons > 0 ? rb->son[i]->ktree : rb->t->size);
+  }
+  assert(xtoff == rb->ktree);
+
+  /* Each column son owns the coefficients of its subtree */
+  yt1 = (pavector *) allocmem((size_t) sizeof(pavector) * csons);
+  ytoff = cb->k;
+  for (j = 0; j < csons; j++) {
+    assert(csons == 1 || cb->sons > 0);
+    yt1[j] = (cb->sons > 0 ?
+	      new_sub_avector(yt, cb->son[j]->ktree, ytoff) :
+	      new_sub_avector(yt, cb->ktree, 0));
+
+    ytoff += (cb->sons > 0 ? cb->son[j]->ktree : cb->t->size);
+  }
+  assert(ytoff == cb->ktree);
+
+  /* Column sons are handled in parallel, blocks within a column in the
+     same order as in fastaddevaltrans_h2matrix_avector */
+#ifdef USE_OPENMP
+  nthreads = csons;
+  (void) nthreads;
+#pragma omp parallel for if(pardepth > 0), num_threads(nthreads), private(i)
+#endif
+  for (j = 0; j < csons; j++)
+    for (i = 0; i < rsons; i++)
+      fastaddevaltrans_parallel_h2matrix_avector(alpha,
+						 h2->son[i + j * rsons],
+						 xt1[i], yt1[j],
+						 pardepth - 1);
+
+  for (j = 0; j < csons; j++)
+    del_avector(yt1[j]);
+  freemem(yt1);
+
+  for (i = 0; i < rsons; i++)
+    del_avector(xt1[i]);
+  freemem(xt1);
+}
+
 void
 addevaltrans_h2matrix_avector(field alpha, pch2matrix h2, pcavector x,
 			      pavector y)
@@ -1313,7 +1620,12 @@ addevaltrans_h2matrix_avector(field alpha, pch2matrix h2, pcavector x,
 
   forward_clusterbasis_avector(h2->rb, x, xt);
 
+#ifdef USE_OPENMP
+  fastaddevaltrans_parallel_h2matrix_avector(alpha, h2, xt, yt,
+					     max_pardepth);
+#else
   fastaddevaltrans_h2matrix_avector(alpha, h2, xt, yt);
+#endif
 
   backward_clusterbasis_avector(h2->cb, yt, y);
 
@@ -1321,6 +1633,28 @@ addevaltrans_h2matrix_avector(field alpha, pch2matrix h2, pcavector x,
   del_avector(xt);
 }
 
+void
+addevaltrans_parallel_h2matrix_avector(field alpha, pch2matrix h2,
+				       pcavector x, pavector y,
+				       uint pardepth)
+{
+  pavector  xt, yt;
+
+  xt = new_coeffs_clusterbasis_avector(h2->rb);
+  yt = new_coeffs_clusterbasis_avector(h2->cb);
+
+  clear_avector(yt);
+
+  forward_parallel_clusterbasis_avector(h2->rb, x, xt, pardepth);
+
+  fastaddevaltrans_parallel_h2matrix_avector(alpha, h2, xt, yt, pardepth);
+
+  backward_parallel_clusterbasis_avector(h2->cb, yt, y, pardepth);
+
+  del_avector(yt);
+  del_avector(xt);
+}
+
 static void
 addevalsymm_offdiag(field alpha, pch2matrix h2, pavector xt,
 		    pavector xta, pavector yt, pavector yta)
@@ -1768,6 +2102,68 @@ addmul_amatrix_h2matrix_amatrix(field alpha, bool xtrans, pcamatrix X,
   }
 }
 
+static void
+addeval_permuted(field alpha, bool h2trans, pch2matrix h2, pcamatrix X,
+		 pamatrix Y)
+{
+  amatrix   tmp1, tmp2;
+  pamatrix  Xp, Yp;
+  pcclusterbasis xb = (h2trans ? h2->rb : h2->cb);
+  pcclusterbasis yb = (h2trans ? h2->cb : h2->rb);
+  uint      i, j, ip;
+
+  assert(X->rows == xb->t->size);
+  assert(Y->rows == yb->t->size);
+  assert(X->cols == Y->cols);
+
+  /* Permutation of X */
+  Xp = init_amatrix(&tmp1, X->rows, X->cols);
+  for (j = 0; j < X->cols; j++)
+    for (i = 0; i < X->rows; i++) {
+      ip = xb->t->idx[i];
+      assert(ip < X->rows);
+      Xp->a[i + j * Xp->ld] = X->a[ip + j * X->ld];
+    }
+
+  Yp = init_zero_amatrix(&tmp2, Y->rows, Y->cols);
+
+  /* Matrix multiplication */
+  addmul_h2matrix_amatrix_amatrix(alpha, h2trans, h2, false, Xp, Yp);
+
+  /* Reverse permutation of Y */
+  for (j = 0; j < Y->cols; j++)
+    for (i = 0; i < Y->rows; i++) {
+      ip = yb->t->idx[i];
+      Y->a[ip + j * Y->ld] += Yp->a[i + j * Yp->ld];
+    }
+
+  uninit_amatrix(Yp);
+  uninit_amatrix(Xp);
+}
+
+void
+addeval_h2matrix_amatrix(field alpha, pch2matrix h2, pcamatrix X, pamatrix Y)
+{
+  addeval_permuted(alpha, false, h2, X, Y);
+}
+
+void
+addevaltrans_h2matrix_amatrix(field alpha, pch2matrix h2, pcamatrix X,
+			      pamatrix Y)
+{
+  addeval_permuted(alpha, true, h2, X, Y);
+}
+
+void
+mvm_h2matrix_amatrix(field alpha, bool h2trans, pch2matrix h2, pcamatrix X,
+		     pamatrix Y)
+{
+  if (h2trans)
+    addevaltrans_h2matrix_amatrix(alpha, h2, X, Y);
+  else
+    addeval_h2matrix_amatrix(alpha, h2, X, Y);
+}
+
 /* ------------------------------------------------------------
  Orthogonal projection
  ------------------------------------------------------------ */
@@ -67,6 +67,10 @@ struct _h2matrix {
   uint refs;
   /** @brief Number of descendants in matrix tree. */
   uint desc;
+
+  /** @brief @ref arena holding this object, <tt>NULL</tt> if it has
+   *  been allocated individually. */
+  parena arena;
 };
 
 /* ------------------------------------------------------------
@@ -282,6 +286,28 @@ clear_h2matrix(ph2matrix h2);
 HEADER_PREFIX ph2matrix
 build_from_block_h2matrix(pcblock b, pclusterbasis rb, pclusterbasis cb);
 
+/** @brief Build an @ref h2matrix object from a @ref block tree using
+ *  given cluster bases, allocating all nodes from one @ref arena.
+ *
+ *  The @ref h2matrix, @ref uniform and @ref amatrix objects, the
+ *  arrays of sons and the coefficients of nearfield leaves are taken
+ *  from an @ref arena sized for the block tree. The coupling matrices
+ *  are still allocated individually, since they are resized when the
+ *  cluster bases change.
+ *  The arena is released automatically when the last of its nodes
+ *  is deleted.
+ *
+ *  @remark Submatrices for far- and nearfield leaves are created,
+ *  but their coefficients are not initialized.
+ *
+ *  @param b Block tree.
+ *  @param rb Row cluster basis.
+ *  @param cb Column cluster basis.
+ *  @returns New @ref h2matrix object. */
+HEADER_PREFIX ph2matrix
+build_from_block_arena_h2matrix(pcblock b, pclusterbasis rb,
+				pclusterbasis cb);
+
 /* ------------------------------------------------------------
  Build block tree from H^2-matrix
  ------------------------------------------------------------ */
@@ -511,6 +537,27 @@ HEADER_PREFIX void
 fastaddeval_h2matrix_avector(field alpha, pch2matrix h2, pavector xt,
     pavector yt);
 
+/** @brief Parallel interaction phase of the matrix-vector multiplication.
+ *
+ *  Parallel version of @ref fastaddeval_h2matrix_avector.
+ *  Row sons are handled by different threads, so every thread writes
+ *  only to the coefficients of its own row subtree, and the blocks
+ *  within a row are processed in the same order as in the sequential
+ *  version. The result does not depend on the number of threads.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param h2 Matrix @f$A@f$.
+ *  @param xt Coefficients @f$(\hat x_s)_{s\in\mathcal{T}_{\mathcal J}}@f$
+ *            of the source vector with respect to the
+ *            column basis <tt>h2->cb</tt>.
+ *  @param yt Coefficients @f$(\hat y_t)_{t\in\mathcal{T}_{\mathcal I}}@f$
+ *            of the target vector with respect to the
+ *            row basis <tt>h2->rb</tt>.
+ *  @param pardepth Parallelization depth. */
+HEADER_PREFIX void
+fastaddeval_parallel_h2matrix_avector(field alpha, pch2matrix h2,
+    pavector xt, pavector yt, uint pardepth);
+
 /** @brief Matrix-vector multiplication
  *  @f$y \gets y + \alpha A x@f$.
  *
@@ -524,6 +571,22 @@ fastaddeval_h2matrix_avector(field alpha, pch2matrix h2, pavector xt,
 HEADER_PREFIX void
 addeval_h2matrix_avector(field alpha, pch2matrix h2, pcavector x, pavector y);
 
+/** @brief Parallel matrix-vector multiplication
+ *  @f$y \gets y + \alpha A x@f$.
+ *
+ *  Combines @ref forward_parallel_clusterbasis_avector,
+ *  @ref fastaddeval_parallel_h2matrix_avector and
+ *  @ref backward_parallel_clusterbasis_avector.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param h2 Matrix @f$A@f$.
+ *  @param x Source vector @f$x@f$.
+ *  @param y Target vector @f$y@f$.
+ *  @param pardepth Parallelization depth. */
+HEADER_PREFIX void
+addeval_parallel_h2matrix_avector(field alpha, pch2matrix h2, pcavector x,
+    pavector y, uint pardepth);
+
 /** @brief Interaction phase of the adjoint matrix-vector multiplication.
  *
  *  Nearfield blocks are added directly
@@ -548,6 +611,26 @@ HEADER_PREFIX void
 fastaddevaltrans_h2matrix_avector(field alpha, pch2matrix h2, pavector xt,
     pavector yt);
 
+/** @brief Parallel interaction phase of the adjoint matrix-vector
+ *  multiplication.
+ *
+ *  Parallel version of @ref fastaddevaltrans_h2matrix_avector.
+ *  Column sons are handled by different threads, and the result does
+ *  not depend on the number of threads.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param h2 Matrix @f$A@f$.
+ *  @param xt Coefficients @f$(\hat x_t)_{t\in\mathcal{T}_{\mathcal I}}@f$
+ *            of the source vector with respect to the
+ *            row basis <tt>h2->rb</tt>.
+ *  @param yt Coefficients @f$(\hat y_s)_{s\in\mathcal{T}_{\mathcal J}}@f$
+ *            of the target vector with respect to the
+ *            column basis <tt>h2->cb</tt>.
+ *  @param pardepth Parallelization depth. */
+HEADER_PREFIX void
+fastaddevaltrans_parallel_h2matrix_avector(field alpha, pch2matrix h2,
+    pavector xt, pavector yt, uint pardepth);
+
 /** @brief Adjoint matrix-vector multiplication
  *  @f$y \gets y + \alpha A^* x@f$.
  *
@@ -562,6 +645,22 @@ HEADER_PREFIX void
 addevaltrans_h2matrix_avector(field alpha, pch2matrix h2, pcavector x,
     pavector y);
 
+/** @brief Parallel adjoint matrix-vector multiplication
+ *  @f$y \gets y + \alpha A^* x@f$.
+ *
+ *  Combines @ref forward_parallel_clusterbasis_avector,
+ *  @ref fastaddevaltrans_parallel_h2matrix_avector and
+ *  @ref backward_parallel_clusterbasis_avector.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param h2 Matrix @f$A@f$.
+ *  @param x Source vector @f$x@f$.
+ *  @param y Target vector @f$y@f$.
+ *  @param pardepth Parallelization depth. */
+HEADER_PREFIX void
+addevaltrans_parallel_h2matrix_avector(field alpha, pch2matrix h2,
+    pcavector x, pavector y, uint pardepth);
+
 /** @brief Symmetric matrix-vector multiplication,
  *  @f$y \gets y + \alpha A x@f$, where @f$A@f$ is assumed to be
  *  self-adjoint and only its lower triangular part is used.
@@ -653,6 +752,47 @@ HEADER_PREFIX void
 addmul_amatrix_h2matrix_amatrix(field alpha, bool atrans, pcamatrix A,
     bool btrans, pch2matrix B, pamatrix C);
 
+/** @brief Matrix multiplication
+ *  @f$Y \gets Y + \alpha A X@f$.
+ *
+ *  Each column of @f$X@f$ is treated like a source vector in
+ *  @ref addeval_h2matrix_avector, but the forward transformation,
+ *  the interaction phase and the backward transformation handle all
+ *  columns simultaneously.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param h2 Matrix @f$A@f$.
+ *  @param X Source matrix @f$X@f$.
+ *  @param Y Target matrix @f$Y@f$. */
+HEADER_PREFIX void
+addeval_h2matrix_amatrix(field alpha, pch2matrix h2, pcamatrix X, pamatrix Y);
+
+/** @brief Adjoint matrix multiplication
+ *  @f$Y \gets Y + \alpha A^* X@f$.
+ *
+ *  Each column of @f$X@f$ is treated like a source vector in
+ *  @ref addevaltrans_h2matrix_avector.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param h2 Matrix @f$A@f$.
+ *  @param X Source matrix @f$X@f$.
+ *  @param Y Target matrix @f$Y@f$. */
+HEADER_PREFIX void
+addevaltrans_h2matrix_amatrix(field alpha, pch2matrix h2, pcamatrix X,
+    pamatrix Y);
+
+/** @brief Matrix multiplication
+ *  @f$Y \gets Y + \alpha A X@f$ or @f$Y \gets Y + \alpha A^* X@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param h2trans Set if @f$A^*@f$ is to be used instead of @f$A@f$.
+ *  @param h2 Matrix @f$A@f$.
+ *  @param X Source matrix @f$X@f$.
+ *  @param Y Target matrix @f$Y@f$. */
+HEADER_PREFIX void
+mvm_h2matrix_amatrix(field alpha, bool h2trans, pch2matrix h2, pcamatrix X,
+    pamatrix Y);
+
 /* ------------------------------------------------------------
  Orthogonal projection
  ------------------------------------------------------------ */
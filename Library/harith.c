@@ -304,8 +304,10 @@ trunc_qq_rkmatrix(pctruncmode tm, real eps, prkmatrix r)
   uninit_amatrix(a);
 }
 
-void
-trunc_rkmatrix(pctruncmode tm, real eps, prkmatrix r)
+/* Choose the most efficient SVD-based truncation algorithm by
+ * considering the rank, number of rows and number of columns. */
+static void
+trunc_svd_rkmatrix(pctruncmode tm, real eps, prkmatrix r)
 {
   uint      rows, cols, k;
 
@@ -335,6 +337,222 @@ trunc_rkmatrix(pctruncmode tm, real eps, prkmatrix r)
   }
 }
 
+/* Number of random vectors added in each step of the randomized
+ * range finder */
+#define RANDOMIZED_BLOCK_RKMATRIX 8
+
+/* Fill a matrix with pseudo-random entries uniformly distributed in
+ * [-1,1] using a local xorshift generator, so that concurrent truncations
+ * neither share the state of rand() nor depend on each other's order */
+static void
+random_rand_rkmatrix(unsigned long *state, pamatrix a)
+{
+  unsigned long x = *state;
+  uint      i, j;
+
+  for (j = 0; j < a->cols; j++)
+    for (i = 0; i < a->rows; i++) {
+      x ^= (x << 13) & 0xffffffffUL;
+      x ^= x >> 17;
+      x ^= (x << 5) & 0xffffffffUL;
+      a->a[i + j * a->ld] = 2.0 * x / 4294967295.0 - 1.0;
+    }
+
+  *state = x;
+}
+
+uint
+findrange_randomized(pctruncmode tm, real eps, uint rows, uint cols,
+		     rangesample_t sample, void *data, pamatrix q)
+{
+  amatrix   tmp1, tmp2, tmp3, tmp4, tmp5;
+  avector   tmp6, tmp7;
+  pamatrix  q1, y, omega, p, w;
+  pavector  tau, yc;
+  real      norm, est, nrm, tol;
+  unsigned long state;
+  uint      kmax, l, s;
+  uint      i, ii, j, pass;
+
+  assert(q->rows == rows);
+
+  kmax = UINT_MIN3(rows, cols, q->cols);
+
+  /* Seed the generator from the dimensions, the state has to be
+   * non-zero */
+  state = (2654435761UL * rows + 40503UL * cols + q->cols) & 0xffffffffUL;
+  if (state == 0)
+    state = 1;
+
+  l = 0;
+  nrm = 0.0;
+  while (l < kmax) {
+    s = UINT_MIN(RANDOMIZED_BLOCK_RKMATRIX, kmax - l);
+
+    /* Sample Y = M Omega with a random matrix Omega */
+    omega = init_amatrix(&tmp1, cols, s);
+    random_rand_rkmatrix(&state, omega);
+    y = init_sub_amatrix(&tmp2, q, rows, 0, s, l);
+    clear_amatrix(y);
+    sample(data, omega, y);
+    uninit_amatrix(omega);
+
+    /* Estimate the norm of M from the first sample */
+    if (l == 0) {
+      for (i = 0; i < s; i++) {
+	yc = init_column_avector(&tmp6, y, i);
+	norm = norm2_avector(yc);
+	nrm = REAL_MAX(nrm, norm);
+	uninit_avector(yc);
+      }
+    }
+
+    /* Project out the basis found so far, twice for stability */
+    if (l > 0) {
+      q1 = init_sub_amatrix(&tmp3, q, rows, 0, l, 0);
+      p = init_amatrix(&tmp4, l, s);
+      for (pass = 0; pass < 2; pass++) {
+	clear_amatrix(p);
+	addmul_amatrix(1.0, true, q1, false, y, p);
+	addmul_amatrix(-1.0, false, q1, false, p, y);
+      }
+      uninit_amatrix(p);
+      uninit_amatrix(q1);
+    }
+
+    /* The remaining part of the sample estimates the error.
+     * Stop if the probabilistic error bound
+     * 10 sqrt(2/pi) max ||(I - Q Q^*) M omega_i|| is one order of
+     * magnitude below the tolerance, leaving the remaining error to
+     * the final SVD truncation.
+     * Since the entries of omega are uniformly distributed in [-1,1],
+     * absolute errors are scaled by sqrt(3). Relative errors refer to
+     * the first sample, which carries the same scaling. */
+    tol = (tm && tm->absolute ? eps / 138.0 : eps * nrm / 80.0);
+
+    /* Columns below the tolerance carry no new information, and
+     * a zero column would make the QR decomposition produce basis
+     * vectors that are not orthogonal to Q, so they are dropped */
+    est = 0.0;
+    j = 0;
+    for (i = 0; i < s; i++) {
+      yc = init_column_avector(&tmp6, y, i);
+      norm = norm2_avector(yc);
+      uninit_avector(yc);
+
+      est = REAL_MAX(est, norm);
+      if (norm > tol) {
+	if (j < i)
+	  for (ii = 0; ii < rows; ii++)
+	    y->a[ii + j * y->ld] = y->a[ii + i * y->ld];
+	j++;
+      }
+    }
+    uninit_amatrix(y);
+
+    if (j == 0)
+      break;
+
+    /* Add an orthonormal basis of the remaining columns */
+    y = init_sub_amatrix(&tmp2, q, rows, 0, j, l);
+    w = init_amatrix(&tmp5, rows, j);
+    copy_amatrix(false, y, w);
+    tau = init_avector(&tmp7, j);
+    qrdecomp_amatrix(w, tau);
+    clear_amatrix(y);
+    for (i = 0; i < j; i++)
+      y->a[i + i * y->ld] = 1.0;
+    qreval_amatrix(false, w, tau, y);
+    uninit_avector(tau);
+    uninit_amatrix(w);
+    uninit_amatrix(y);
+
+    l += j;
+
+    if (est <= tol)
+      break;
+  }
+
+  return l;
+}
+
+/* Sample Y = A B^* Omega for the range finder */
+static void
+sample_rkmatrix(void *data, pcamatrix omega, pamatrix y)
+{
+  prkmatrix r = (prkmatrix) data;
+  amatrix   tmp;
+  pamatrix  z;
+
+  z = init_amatrix(&tmp, r->k, omega->cols);
+  clear_amatrix(z);
+  addmul_amatrix(1.0, true, &r->B, false, omega, z);
+  addmul_amatrix(1.0, false, &r->A, false, z, y);
+  uninit_amatrix(z);
+}
+
+/* Randomized version: find an orthonormal basis Q of the approximate
+ * range of A B^* by adaptive sampling with random vectors, then
+ * represent A B^* by Q (B A^* Q)^* and truncate this low-rank
+ * factorization by a small SVD.
+ * Advisable if the rank is significantly larger than the rank of the
+ * result. */
+static void
+trunc_rand_rkmatrix(pctruncmode tm, real eps, prkmatrix r)
+{
+  amatrix   tmp1, tmp2, tmp3, tmp4;
+  pamatrix  q, q1, p, w;
+  uint      rows, cols, k, kmax, l;
+
+  assert(r->A.cols == r->k);
+  assert(r->B.cols == r->k);
+
+  rows = r->A.rows;
+  cols = r->B.rows;
+  k = r->k;
+  kmax = UINT_MIN3(rows, cols, k);
+
+  /* Sampling does not pay off for small ranks */
+  if (kmax <= RANDOMIZED_BLOCK_RKMATRIX) {
+    trunc_svd_rkmatrix(tm, eps, r);
+    return;
+  }
+
+  q = init_amatrix(&tmp1, rows, kmax);
+  l = findrange_randomized(tm, eps, rows, cols, sample_rkmatrix, r, q);
+
+  /* Compute W = B A^* Q, so that Q Q^* A B^* = Q W^* */
+  q1 = init_sub_amatrix(&tmp2, q, rows, 0, l, 0);
+  p = init_amatrix(&tmp3, k, l);
+  clear_amatrix(p);
+  addmul_amatrix(1.0, true, &r->A, false, q1, p);
+  w = init_amatrix(&tmp4, cols, l);
+  clear_amatrix(w);
+  addmul_amatrix(1.0, false, &r->B, false, p, w);
+  uninit_amatrix(p);
+
+  /* Replace the factors and truncate the small factorization */
+  setrank_rkmatrix(r, l);
+  copy_amatrix(false, q1, &r->A);
+  copy_amatrix(false, w, &r->B);
+  uninit_amatrix(w);
+  uninit_amatrix(q1);
+  uninit_amatrix(q);
+
+  trunc_svd_rkmatrix(tm, eps, r);
+}
+
+/* User-visible function, uses randomized sampling if requested by
+ * the truncation strategy and an SVD otherwise. */
+void
+trunc_rkmatrix(pctruncmode tm, real eps, prkmatrix r)
+{
+  if (tm && tm->randomized)
+    trunc_rand_rkmatrix(tm, eps, r);
+  else
+    trunc_svd_rkmatrix(tm, eps, r);
+}
+
 /* ------------------------------------------------------------
  Truncated addition of an rkmatrix to another rkmatrix.
  ------------------------------------------------------------ */
@@ -711,6 +929,49 @@ add_qq_rkmatrix(field alpha, pcrkmatrix src, pctruncmode tm,
   uninit_amatrix(a);
 }
 
+/* Randomized version: Set up A and B and use the randomized range
+ * finder of trunc_rand_rkmatrix. */
+static void
+add_rand_rkmatrix(field alpha, pcrkmatrix src, pctruncmode tm,
+		  real eps, prkmatrix trg)
+{
+  rkmatrix  tmp1;
+  amatrix   tmp2;
+  prkmatrix r;
+  pamatrix  a1;
+  uint      rows, cols;
+
+  rows = trg->A.rows;
+  cols = trg->B.rows;
+
+  /* Create factors A = (alpha Asrc, Atrg) and B = (Bsrc, Btrg) */
+  r = init_rkmatrix(&tmp1, rows, cols, src->k + trg->k);
+
+  a1 = init_sub_amatrix(&tmp2, &r->A, rows, 0, src->k, 0);
+  copy_amatrix(false, &src->A, a1);
+  if (alpha != 1.0)
+    scale_amatrix(alpha, a1);
+  uninit_amatrix(a1);
+
+  a1 = init_sub_amatrix(&tmp2, &r->B, cols, 0, src->k, 0);
+  copy_amatrix(false, &src->B, a1);
+  uninit_amatrix(a1);
+
+  a1 = init_sub_amatrix(&tmp2, &r->A, rows, 0, trg->k, src->k);
+  copy_amatrix(false, &trg->A, a1);
+  uninit_amatrix(a1);
+
+  a1 = init_sub_amatrix(&tmp2, &r->B, cols, 0, trg->k, src->k);
+  copy_amatrix(false, &trg->B, a1);
+  uninit_amatrix(a1);
+
+  trunc_rand_rkmatrix(tm, eps, r);
+
+  copy_rkmatrix(false, r, trg);
+
+  uninit_rkmatrix(r);
+}
+
 /* User-visible function, chooses appropriate truncation function by
  * considering the rank, number of rows and number of columns. */
 void
@@ -723,6 +984,12 @@ add_rkmatrix(field alpha, pcrkmatrix src, pctruncmode tm, real eps,
   cols = trg->B.rows;
   k = src->k + trg->k;
 
+  /* Use randomized sampling if requested */
+  if (tm && tm->randomized && k > RANDOMIZED_BLOCK_RKMATRIX) {
+    add_rand_rkmatrix(alpha, src, tm, eps, trg);
+    return;
+  }
+
   /* Choose most efficient truncation algorithm */
   if (k < rows) {
     if (k < cols)
@@ -742,6 +1009,205 @@ add_rkmatrix(field alpha, pcrkmatrix src, pctruncmode tm, real eps,
   }
 }
 
+/* ------------------------------------------------------------
+ Accumulated updates of an rkmatrix.
+ ------------------------------------------------------------ */
+
+/* Reallocate the factors of a low-rank matrix with room for "cap"
+ * columns, keeping the current rank */
+static void
+reserve_rkmatrix(prkmatrix r, uint cap)
+{
+  pfield    a;
+  uint      rows = r->A.rows;
+  uint      cols = r->B.rows;
+  uint      k = r->k;
+  uint      i, j;
+
+  assert(cap >= k);
+
+  a = allocmatrix(rows, cap);
+  for (j = 0; j < k; j++)
+    for (i = 0; i < rows; i++)
+      a[i + (size_t) j * rows] = r->A.a[i + (size_t) j * r->A.ld];
+  freemem(r->A.a);
+  r->A.a = a;
+  r->A.ld = rows;
+
+  a = allocmatrix(cols, cap);
+  for (j = 0; j < k; j++)
+    for (i = 0; i < cols; i++)
+      a[i + (size_t) j * cols] = r->B.a[i + (size_t) j * r->B.ld];
+  freemem(r->B.a);
+  r->B.a = a;
+  r->B.ld = cols;
+}
+
+/* Add an rkmatrix to a submatrix of the low-rank leaf of an hmatrix
+ * starting in row roff and column coff. If the truncation strategy asks
+ * for accumulated updates, the factors of the update are appended to
+ * the factors of the leaf and truncated later by flush_hmatrix, so that
+ * several updates share one truncation. */
+static void
+accumulate_hmatrix(field alpha, pcrkmatrix src, uint roff, uint coff,
+		   pctruncmode tm, real eps, phmatrix z)
+{
+  amatrix   tmp1;
+  rkmatrix  tmp2;
+  pamatrix  a1, b1;
+  prkmatrix r, r1;
+  uint      rows, cols, k, cap;
+
+  r = z->r;
+  rows = r->A.rows;
+  cols = r->B.rows;
+  k = src->k + r->k;
+
+  assert(z->pending <= r->k);
+
+  /* Truncate immediately if the factors would require more storage
+   * than a dense matrix, or if the pending updates would exceed the
+   * rank k of the part that has already been truncated: an SVD
+   * truncation costs O((rows+cols) k^2), so deferring up to rank 2k
+   * never costs more than the separate truncations it replaces, while
+   * the randomized range finder, linear in the rank, saves work */
+  if (tm == NULL || !tm->accumulate
+      || z->pending + src->k > r->k - z->pending
+      || (size_t) k * (rows + cols) > (size_t) rows * cols) {
+    if (roff == 0 && coff == 0 && src->A.rows == rows && src->B.rows == cols)
+      add_rkmatrix(alpha, src, tm, eps, r);
+    else {
+      r1 = init_rkmatrix(&tmp2, rows, cols, src->k);
+      clear_amatrix(&r1->A);
+      clear_amatrix(&r1->B);
+
+      a1 = init_sub_amatrix(&tmp1, &r1->A, src->A.rows, roff, src->k, 0);
+      copy_amatrix(false, &src->A, a1);
+      uninit_amatrix(a1);
+
+      b1 = init_sub_amatrix(&tmp1, &r1->B, src->B.rows, coff, src->k, 0);
+      copy_amatrix(false, &src->B, b1);
+      uninit_amatrix(b1);
+
+      add_rkmatrix(alpha, r1, tm, eps, r);
+
+      uninit_rkmatrix(r1);
+    }
+    z->pending = 0;
+    return;
+  }
+
+  /* Reserve storage geometrically, so that appending updates does not
+   * copy the factors every time.  Since src->k <= r->k, doubling the
+   * current rank is always sufficient. */
+  assert(r->A.owner == NULL && r->B.owner == NULL);
+  if (z->pending == 0 || k > z->reserved) {
+    cap = 2 * r->k;
+    if ((size_t) cap * (rows + cols) > (size_t) rows * cols)
+      cap = UINT_MAX(k, (uint) ((size_t) rows * cols / (rows + cols)));
+    reserve_rkmatrix(r, cap);
+    z->reserved = cap;
+  }
+  r->A.cols = k;
+  r->B.cols = k;
+
+  /* Reserved columns are uninitialized, clear the rows not covered by
+   * the update */
+  if (src->A.rows < rows) {
+    a1 = init_sub_amatrix(&tmp1, &r->A, rows, 0, src->k, r->k);
+    clear_amatrix(a1);
+    uninit_amatrix(a1);
+  }
+  if (src->B.rows < cols) {
+    b1 = init_sub_amatrix(&tmp1, &r->B, cols, 0, src->k, r->k);
+    clear_amatrix(b1);
+    uninit_amatrix(b1);
+  }
+
+  a1 = init_sub_amatrix(&tmp1, &r->A, src->A.rows, roff, src->k, r->k);
+  copy_amatrix(false, &src->A, a1);
+  scale_amatrix(alpha, a1);
+  uninit_amatrix(a1);
+
+  b1 = init_sub_amatrix(&tmp1, &r->B, src->B.rows, coff, src->k, r->k);
+  copy_amatrix(false, &src->B, b1);
+  uninit_amatrix(b1);
+
+  r->k = k;
+  z->pending += src->k;
+}
+
+/* Add a temporary matrix created by split_hmatrix to the low-rank leaf
+ * it has been split from */
+static void
+accumulate_split_hmatrix(pchmatrix s, pctruncmode tm, real eps, phmatrix z)
+{
+  prkmatrix xy;
+  pchmatrix s1;
+  uint      rsons, csons;
+  uint      roff, coff;
+  uint      i, j;
+
+  if (tm && tm->accumulate) {
+    rsons = s->rsons;
+    csons = s->csons;
+
+    coff = 0;
+    for (j = 0; j < csons; j++) {
+      roff = 0;
+      for (i = 0; i < rsons; i++) {
+	s1 = s->son[i + j * rsons];
+	assert(s1->r != 0);
+
+	if (s1->r->k > 0)
+	  accumulate_hmatrix(1.0, s1->r, roff, coff, tm, eps, z);
+
+	roff += s1->rc->size;
+      }
+      assert(roff == s->rc->size);
+
+      coff += s->son[j * rsons]->cc->size;
+    }
+    assert(coff == s->cc->size);
+  }
+  else {
+    xy = merge_hmatrix_rkmatrix(s, tm, eps);
+    add_rkmatrix(1.0, xy, tm, eps, z->r);
+    del_rkmatrix(xy);
+  }
+}
+
+/* Truncate pending updates before a low-rank leaf is used */
+static void
+flush_hmatrix(pctruncmode tm, real eps, phmatrix z)
+{
+  if (z->pending > 0) {
+    /* Release the storage reserved for further updates */
+    if (z->reserved > z->r->k)
+      reserve_rkmatrix(z->r, z->r->k);
+    trunc_rkmatrix(tm, eps, z->r);
+    z->pending = 0;
+  }
+}
+
+void
+trunc_hmatrix(pctruncmode tm, real eps, phmatrix a)
+{
+  uint      rsons, csons;
+  uint      i, j;
+
+  if (a->r)
+    flush_hmatrix(tm, eps, a);
+  else if (a->son) {
+    rsons = a->rsons;
+    csons = a->csons;
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	trunc_hmatrix(tm, eps, a->son[i + j * rsons]);
+  }
+}
+
 /* ------------------------------------------------------------
  Add rkmatrix to an hmatrix.
  ------------------------------------------------------------ */
@@ -758,7 +1224,7 @@ add_rkmatrix_hmatrix(field alpha, pcrkmatrix r, pctruncmode tm, real eps,
   uint      i, j;
 
   if (a->r)
-    add_rkmatrix(alpha, r, tm, eps, a->r);
+    accumulate_hmatrix(alpha, r, 0, 0, tm, eps, a);
   else if (a->f)
     addmul_amatrix(alpha, false, &r->A, true, &r->B, a->f);
   else {
@@ -1434,11 +1900,92 @@ merge_aq_rkmatrix(bool colmerge, pcrkmatrix src, pctruncmode tm,
   }
 }
 
+/* Randomized version: Set up the block factors of the merged matrix
+ * and use the randomized range finder of trunc_rand_rkmatrix. */
+static void
+merge_rand_rkmatrix(bool colmerge, pcrkmatrix src, pctruncmode tm,
+		    real eps, prkmatrix trg)
+{
+  rkmatrix  tmp1;
+  amatrix   tmp2;
+  prkmatrix r;
+  pamatrix  a1;
+  uint      rows, cols, k;
+
+  k = trg->k + src->k;
+
+  if (colmerge) {
+    assert(src->B.rows == trg->B.rows);
+
+    rows = trg->A.rows + src->A.rows;
+    cols = trg->B.rows;
+
+    /* Create factors A = (A1 0; 0 A2) and B = (B1 B2) */
+    r = init_rkmatrix(&tmp1, rows, cols, k);
+    clear_amatrix(&r->A);
+
+    a1 = init_sub_amatrix(&tmp2, &r->A, trg->A.rows, 0, trg->k, 0);
+    copy_amatrix(false, &trg->A, a1);
+    uninit_amatrix(a1);
+
+    a1 = init_sub_amatrix(&tmp2, &r->A, src->A.rows, trg->A.rows, src->k,
+			  trg->k);
+    copy_amatrix(false, &src->A, a1);
+    uninit_amatrix(a1);
+
+    a1 = init_sub_amatrix(&tmp2, &r->B, cols, 0, trg->k, 0);
+    copy_amatrix(false, &trg->B, a1);
+    uninit_amatrix(a1);
+
+    a1 = init_sub_amatrix(&tmp2, &r->B, cols, 0, src->k, trg->k);
+    copy_amatrix(false, &src->B, a1);
+    uninit_amatrix(a1);
+  }
+  else {
+    assert(src->A.rows == trg->A.rows);
+
+    rows = trg->A.rows;
+    cols = trg->B.rows + src->B.rows;
+
+    /* Create factors A = (A1 A2) and B = (B1 0; 0 B2) */
+    r = init_rkmatrix(&tmp1, rows, cols, k);
+    clear_amatrix(&r->B);
+
+    a1 = init_sub_amatrix(&tmp2, &r->A, rows, 0, trg->k, 0);
+    copy_amatrix(false, &trg->A, a1);
+    uninit_amatrix(a1);
+
+    a1 = init_sub_amatrix(&tmp2, &r->A, rows, 0, src->k, trg->k);
+    copy_amatrix(false, &src->A, a1);
+    uninit_amatrix(a1);
+
+    a1 = init_sub_amatrix(&tmp2, &r->B, trg->B.rows, 0, trg->k, 0);
+    copy_amatrix(false, &trg->B, a1);
+    uninit_amatrix(a1);
+
+    a1 = init_sub_amatrix(&tmp2, &r->B, src->B.rows, trg->B.rows, src->k,
+			  trg->k);
+    copy_amatrix(false, &src->B, a1);
+    uninit_amatrix(a1);
+  }
+
+  trunc_rand_rkmatrix(tm, eps, r);
+
+  resize_rkmatrix(trg, rows, cols, r->k);
+  copy_amatrix(false, &r->A, &trg->A);
+  copy_amatrix(false, &r->B, &trg->B);
+
+  uninit_rkmatrix(r);
+}
+
 void
 merge_rkmatrix(bool colmerge, pcrkmatrix src, pctruncmode tm, real eps,
 	       prkmatrix trg)
 {
-  merge_aq_rkmatrix(colmerge, src, tm, eps, trg);
+  if (tm && tm->randomized && trg->k + src->k > RANDOMIZED_BLOCK_RKMATRIX)
+    merge_rand_rkmatrix(colmerge, src, tm, eps, trg);
+  else
+    merge_aq_rkmatrix(colmerge, src, tm, eps, trg);
 }
 
 /* ------------------------------------------------------------
@@ -2039,10 +2586,8 @@ addmul_nn_hmatrix(field alpha, pchmatrix x, pchmatrix y,
 				y->son[j + k * msons], tm, eps,
 				ztmp->son[i + k * rsons]);
 
-	xy = merge_hmatrix_rkmatrix(ztmp, tm, eps);
-	add_rkmatrix(1.0, xy, tm, eps, z->r);
+	accumulate_split_hmatrix(ztmp, tm, eps, z);
 
-	del_rkmatrix(xy);
 	del_hmatrix(ztmp);
       }
       else {
@@ -2307,10 +2852,8 @@ addmul_nt_hmatrix(field alpha, pchmatrix x, pchmatrix y,
 				y->son[k + j * csons], tm, eps,
 				ztmp->son[i + k * rsons]);
 
-	xy = merge_hmatrix_rkmatrix(ztmp, tm, eps);
-	add_rkmatrix(1.0, xy, tm, eps, z->r);
+	accumulate_split_hmatrix(ztmp, tm, eps, z);
 
-	del_rkmatrix(xy);
 	del_hmatrix(ztmp);
       }
       else {
@@ -2575,10 +3118,8 @@ addmul_tn_hmatrix(field alpha, pchmatrix x, pchmatrix y,
 				y->son[j + k * msons], tm, eps,
 				ztmp->son[i + k * rsons]);
 
-	xy = merge_hmatrix_rkmatrix(ztmp, tm, eps);
-	add_rkmatrix(1.0, xy, tm, eps, z->r);
+	accumulate_split_hmatrix(ztmp, tm, eps, z);
 
-	del_rkmatrix(xy);
 	del_hmatrix(ztmp);
       }
       else {
@@ -2842,10 +3383,8 @@ addmul_tt_hmatrix(field alpha, pchmatrix x, pchmatrix y,
 				y->son[k + j * csons], tm, eps,
 				ztmp->son[i + k * rsons]);
 
-	xy = merge_hmatrix_rkmatrix(ztmp, tm, eps);
-	add_rkmatrix(1.0, xy, tm, eps, z->r);
+	accumulate_split_hmatrix(ztmp, tm, eps, z);
 
-	del_rkmatrix(xy);
 	del_hmatrix(ztmp);
       }
       else {
@@ -3743,8 +4282,10 @@ lowersolve_nn_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     lowersolve_nn_hmatrix_amatrix(aunit, a, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     lowersolve_nn_hmatrix_amatrix(aunit, a, &xp->r->A);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->rc != xp->rc),
@@ -3800,8 +4341,10 @@ lowersolve_nt_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     lowersolve_nt_hmatrix_amatrix(aunit, a, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     lowersolve_nn_hmatrix_amatrix(aunit, a, &xp->r->B);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->cc != xp->cc),
@@ -3857,8 +4400,10 @@ lowersolve_tn_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     lowersolve_tn_hmatrix_amatrix(aunit, a, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     lowersolve_tn_hmatrix_amatrix(aunit, a, &xp->r->A);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->rc != xp->rc),
@@ -3914,8 +4459,10 @@ lowersolve_tt_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     lowersolve_tt_hmatrix_amatrix(aunit, a, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     lowersolve_tn_hmatrix_amatrix(aunit, a, &xp->r->B);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->cc != xp->cc),
@@ -3989,8 +4536,10 @@ uppersolve_nn_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     uppersolve_nn_hmatrix_amatrix(aunit, a, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     uppersolve_nn_hmatrix_amatrix(aunit, a, &xp->r->A);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->rc != xp->rc),
@@ -4046,8 +4595,10 @@ uppersolve_nt_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     uppersolve_nt_hmatrix_amatrix(aunit, a, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     uppersolve_nn_hmatrix_amatrix(aunit, a, &xp->r->B);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->cc != xp->cc),
@@ -4103,8 +4654,10 @@ uppersolve_tn_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     uppersolve_tn_hmatrix_amatrix(aunit, a, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     uppersolve_tn_hmatrix_amatrix(aunit, a, &xp->r->A);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->rc != xp->rc),
@@ -4160,8 +4713,10 @@ uppersolve_tt_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     uppersolve_tt_hmatrix_amatrix(aunit, a, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     uppersolve_tn_hmatrix_amatrix(aunit, a, &xp->r->B);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->cc != xp->cc),
@@ -4895,8 +5450,10 @@ lowereval_nn_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     lowereval_n_hmatrix_amatrix(aunit, a, false, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     lowereval_n_hmatrix_amatrix(aunit, a, false, &xp->r->A);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->rc != xp->rc),
@@ -4952,8 +5509,10 @@ lowereval_nt_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     lowereval_n_hmatrix_amatrix(aunit, a, true, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     lowereval_n_hmatrix_amatrix(aunit, a, false, &xp->r->B);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->cc != xp->cc),
@@ -5009,8 +5568,10 @@ lowereval_tn_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     lowereval_t_hmatrix_amatrix(aunit, a, false, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     lowereval_t_hmatrix_amatrix(aunit, a, false, &xp->r->A);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->rc != xp->rc),
@@ -5066,8 +5627,10 @@ lowereval_tt_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     lowereval_t_hmatrix_amatrix(aunit, a, true, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     lowereval_t_hmatrix_amatrix(aunit, a, false, &xp->r->B);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->cc != xp->cc),
@@ -5141,8 +5704,10 @@ uppereval_nn_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     uppereval_n_hmatrix_amatrix(aunit, a, false, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     uppereval_n_hmatrix_amatrix(aunit, a, false, &xp->r->A);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->rc != xp->rc),
@@ -5198,8 +5763,10 @@ uppereval_nt_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     uppereval_n_hmatrix_amatrix(aunit, a, true, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     uppereval_n_hmatrix_amatrix(aunit, a, false, &xp->r->B);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->cc != xp->cc),
@@ -5255,8 +5822,10 @@ uppereval_tn_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     uppereval_t_hmatrix_amatrix(aunit, a, false, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     uppereval_t_hmatrix_amatrix(aunit, a, false, &xp->r->A);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->rc != xp->rc),
@@ -5312,8 +5881,10 @@ uppereval_tt_hmatrix(bool aunit, pchmatrix a, pctruncmode tm,
 
   if (xp->f)
     uppereval_t_hmatrix_amatrix(aunit, a, true, xp->f);
-  else if (xp->r)
+  else if (xp->r) {
+    flush_hmatrix(tm, eps, xp);
     uppereval_t_hmatrix_amatrix(aunit, a, false, &xp->r->B);
+  }
   else {
     if (a->f) {
       atmp = split_sub_hmatrix((phmatrix) a, (xp->son[0]->cc != xp->cc),
@@ -5388,8 +5959,8 @@ triangularmul_hmatrix(bool alower, bool aunit, bool atrans, pchmatrix a,
  * Triangular factorizations
  * ------------------------------------------------------------ */
 
-void
-lrdecomp_hmatrix(phmatrix a, pctruncmode tm, real eps)
+static void
+lrdecomp_sequential(phmatrix a, pctruncmode tm, real eps)
 {
   uint      sons;
   uint      i, j, k;
@@ -5408,7 +5979,7 @@ lrdecomp_hmatrix(phmatrix a, pctruncmode tm, real eps)
     sons = a->rsons;
 
     for (k = 0; k < sons; k++) {
-      lrdecomp_hmatrix(a->son[k + k * sons], tm, eps);
+      lrdecomp_sequential(a->son[k + k * sons], tm, eps);
 
       for (j = k + 1; j < sons; j++)
 	lowersolve_hmatrix(true, false, a->son[k + k * sons], tm, eps, false,
@@ -5426,6 +5997,84 @@ lrdecomp_hmatrix(phmatrix a, pctruncmode tm, real eps)
   }
 }
 
+#ifdef USE_OPENMP
+/* Create one task for every step of the block algorithm.
+   The dependencies refer to the entries of a->son, so every submatrix
+   is only modified by one task at a time, and all updates of a
+   submatrix are applied in the same order as in the sequential
+   algorithm. */
+static void
+lrdecomp_tasks(phmatrix a, pctruncmode tm, real eps, uint pardepth)
+{
+  phmatrix *s;
+  uint      sons;
+  uint      i, j, k;
+
+  if (pardepth == 0 || a->son == 0) {
+    lrdecomp_sequential(a, tm, eps);
+    return;
+  }
+
+  assert(a->rc == a->cc);
+  assert(a->rsons == a->csons);
+
+  sons = a->rsons;
+  s = a->son;
+
+  for (k = 0; k < sons; k++) {
+#pragma omp task depend(inout: s[k + k * sons])
+    lrdecomp_tasks(s[k + k * sons], tm, eps, pardepth - 1);
+
+    for (j = k + 1; j < sons; j++) {
+#pragma omp task depend(in: s[k + k * sons]) depend(inout: s[k + j * sons])
+      lowersolve_hmatrix(true, false, s[k + k * sons], tm, eps, false,
+			 s[k + j * sons]);
+    }
+
+    for (i = k + 1; i < sons; i++) {
+#pragma omp task depend(in: s[k + k * sons]) depend(inout: s[i + k * sons])
+      uppersolve_hmatrix(false, true, s[k + k * sons], tm, eps, true,
+			 s[i + k * sons]);
+    }
+
+    for (j = k + 1; j < sons; j++)
+      for (i = k + 1; i < sons; i++) {
+#pragma omp task depend(in: s[i + k * sons], s[k + j * sons]) \
+  depend(inout: s[i + j * sons])
+	addmul_hmatrix(-1.0, false, s[i + k * sons], false, s[k + j * sons],
+		       tm, eps, s[i + j * sons]);
+      }
+  }
+
+#pragma omp taskwait
+}
+#endif
+
+void
+lrdecomp_parallel_hmatrix(phmatrix a, pctruncmode tm, real eps,
+			  uint pardepth)
+{
+#ifdef USE_OPENMP
+  if (pardepth > 0 && a->son) {
+#pragma omp parallel
+#pragma omp single
+    lrdecomp_tasks(a, tm, eps, pardepth);
+  }
+  else
+    lrdecomp_sequential(a, tm, eps);
+#else
+  (void) pardepth;
+
+  lrdecomp_sequential(a, tm, eps);
+#endif
+}
+
+void
+lrdecomp_hmatrix(phmatrix a, pctruncmode tm, real eps)
+{
+  lrdecomp_sequential(a, tm, eps);
+}
+
 void
 lrsolve_hmatrix_avector(bool atrans, pchmatrix a, pavector x)
 {
@@ -5457,8 +6106,8 @@ lrsolve_hmatrix_avector(bool atrans, pchmatrix a, pavector x)
   uninit_avector(xp);
 }
 
-void
-choldecomp_hmatrix(phmatrix a, pctruncmode tm, real eps)
+static void
+choldecomp_sequential(phmatrix a, pctruncmode tm, real eps)
 {
   uint      sons;
   uint      i, j, k;
@@ -5477,7 +6126,7 @@ choldecomp_hmatrix(phmatrix a, pctruncmode tm, real eps)
     sons = a->rsons;
 
     for (k = 0; k < sons; k++) {
-      choldecomp_hmatrix(a->son[k + k * sons], tm, eps);
+      choldecomp_sequential(a->son[k + k * sons], tm, eps);
 
       for (i = k + 1; i < sons; i++)
 	lowersolve_hmatrix(false, false, a->son[k + k * sons], tm, eps, true,
@@ -5491,6 +6140,74 @@ choldecomp_hmatrix(phmatrix a, pctruncmode tm, real eps)
   }
 }
 
+#ifdef USE_OPENMP
+/* Same approach as in lrdecomp_tasks */
+static void
+choldecomp_tasks(phmatrix a, pctruncmode tm, real eps, uint pardepth)
+{
+  phmatrix *s;
+  uint      sons;
+  uint      i, j, k;
+
+  if (pardepth == 0 || a->son == 0) {
+    choldecomp_sequential(a, tm, eps);
+    return;
+  }
+
+  assert(a->rc == a->cc);
+  assert(a->rsons == a->csons);
+
+  sons = a->rsons;
+  s = a->son;
+
+  for (k = 0; k < sons; k++) {
+#pragma omp task depend(inout: s[k + k * sons])
+    choldecomp_tasks(s[k + k * sons], tm, eps, pardepth - 1);
+
+    for (i = k + 1; i < sons; i++) {
+#pragma omp task depend(in: s[k + k * sons]) depend(inout: s[i + k * sons])
+      lowersolve_hmatrix(false, false, s[k + k * sons], tm, eps, true,
+			 s[i + k * sons]);
+    }
+
+    for (j = k + 1; j < sons; j++)
+      for (i = j; i < sons; i++) {
+#pragma omp task depend(in: s[i + k * sons], s[j + k * sons]) \
+  depend(inout: s[i + j * sons])
+	addmul_hmatrix(-1.0, false, s[i + k * sons], true, s[j + k * sons],
+		       tm, eps, s[i + j * sons]);
+      }
+  }
+
+#pragma omp taskwait
+}
+#endif
+
+void
+choldecomp_parallel_hmatrix(phmatrix a, pctruncmode tm, real eps,
+			    uint pardepth)
+{
+#ifdef USE_OPENMP
+  if (pardepth > 0 && a->son) {
+#pragma omp parallel
+#pragma omp single
+    choldecomp_tasks(a, tm, eps, pardepth);
+  }
+  else
+    choldecomp_sequential(a, tm, eps);
+#else
+  (void) pardepth;
+
+  choldecomp_sequential(a, tm, eps);
+#endif
+}
+
+void
+choldecomp_hmatrix(phmatrix a, pctruncmode tm, real eps)
+{
+  choldecomp_sequential(a, tm, eps);
+}
+
 void
 cholsolve_hmatrix_avector(pchmatrix a, pavector x)
 {
@@ -24,12 +24,64 @@
 /** @brief Truncate an rkmatrix,
  *  @f$A \gets \operatorname{trunc}(A,\epsilon)@f$.
  *
+ *  If <tt>tm->randomized</tt> is set, an orthonormal basis of the range
+ *  is constructed by adaptive random sampling until the estimated error
+ *  is below the tolerance, and only the resulting small factorization
+ *  is truncated by an SVD. The same holds for @ref add_rkmatrix and
+ *  @ref merge_rkmatrix.
+ *
  *  @param tm Truncation mode.
  *  @param eps Truncation accuracy @f$\epsilon@f$.
  *  @param r Source matrix, will be overwritten by truncated matrix. */
 HEADER_PREFIX void
 trunc_rkmatrix(pctruncmode tm, real eps, prkmatrix r);
 
+/** @brief Sampling callback for @ref findrange_randomized.
+ *
+ *  Computes @f$Y \gets Y + M \Omega@f$ for the matrix @f$M@f$
+ *  whose range is approximated.
+ *
+ *  @param data Data describing @f$M@f$.
+ *  @param omega Random matrix @f$\Omega@f$.
+ *  @param y Target matrix @f$Y@f$. */
+typedef void (*rangesample_t)(void *data, pcamatrix omega, pamatrix y);
+
+/** @brief Find an orthonormal basis of the approximate range of
+ *  a matrix by adaptive random sampling.
+ *
+ *  Blocks of random vectors are multiplied by @f$M@f$ and
+ *  orthogonalized against the basis found so far until the
+ *  probabilistic error estimate is sufficiently below the tolerance.
+ *  Sample columns below the tolerance are dropped.
+ *
+ *  @param tm Truncation mode, determines whether <tt>eps</tt> is
+ *    relative or absolute.
+ *  @param eps Truncation accuracy @f$\epsilon@f$.
+ *  @param rows Number of rows of @f$M@f$.
+ *  @param cols Number of columns of @f$M@f$.
+ *  @param sample Callback computing products with @f$M@f$.
+ *  @param data Data passed to <tt>sample</tt>.
+ *  @param q Matrix with <tt>rows</tt> rows, the first @f$l@f$ columns
+ *    will be overwritten by the orthonormal basis.
+ *  @returns Number @f$l@f$ of basis vectors. */
+HEADER_PREFIX uint
+findrange_randomized(pctruncmode tm, real eps, uint rows, uint cols,
+		     rangesample_t sample, void *data, pamatrix q);
+
+/** @brief Truncate all low-rank leaves of an hmatrix.
+ *
+ *  If <tt>tm->accumulate</tt> is set, low-rank updates computed by
+ *  @ref add_rkmatrix_hmatrix and @ref addmul_hmatrix are only
+ *  collected in the leaves. This function completes all pending
+ *  truncations, e.g., before the matrix is used for matrix-vector
+ *  multiplications.
+ *
+ *  @param tm Truncation mode.
+ *  @param eps Truncation accuracy @f$\epsilon@f$.
+ *  @param a Target matrix. */
+HEADER_PREFIX void
+trunc_hmatrix(pctruncmode tm, real eps, phmatrix a);
+
 /* ------------------------------------------------------------
  * Truncated addition
  * ------------------------------------------------------------ */
@@ -51,6 +103,10 @@ add_rkmatrix(field alpha, pcrkmatrix src, pctruncmode tm, real eps,
  *  representation to a hierarchical matrix in @ref hmatrix representation,
  *  @f$A \gets \operatorname{blocktrunc}(A + \alpha B,\epsilon)@f$.
  *
+ *  If <tt>tm->accumulate</tt> is set, the truncation of low-rank leaves
+ *  is postponed until they are used by a triangular solve or
+ *  multiplication or by @ref trunc_hmatrix.
+ *
  *  @param alpha Scaling factor @f$\alpha@f$.
  *  @param r Low-rank matrix @f$B@f$.
  *  @param tm Truncation mode.
@@ -159,6 +215,11 @@ addmul_hmatrix_amatrix_amatrix(field alpha, bool atrans, pchmatrix a,
 /** @brief Multiply two H-matrices,
  *  @f$Z \gets \operatorname{succtrunc}(Z + \alpha X Y,\epsilon)@f$.
  *
+ *  If <tt>tm->accumulate</tt> is set, the low-rank updates of each
+ *  leaf of @f$Z@f$ are collected and truncated only once, either when
+ *  the leaf is used by a triangular solve or multiplication, e.g.,
+ *  during @ref lrdecomp_hmatrix, or by @ref trunc_hmatrix.
+ *
  *  @param alpha Scaling factor @f$\alpha@f$.
  *  @param xtrans Set if @f$X^*@f$ is to be used instead of @f$X@f$.
  *  @param x Hierarchical matrix @f$X@f$.
@@ -387,6 +448,9 @@ triangularmul_hmatrix(bool alower, bool aunit, bool atrans, pchmatrix a,
  *  The upper triangular part is stored in the upper triangular part
  *  of the source matrix.
  *
+ *  @remark The factorization is computed sequentially, see
+ *  @ref lrdecomp_parallel_hmatrix for a task-parallel version.
+ *
  *  @param a Source matrix @f$A@f$, will be overwritten
  *     by @f$L@f$ and @f$R@f$.
  *  @param tm Truncation mode.
@@ -394,6 +458,25 @@ triangularmul_hmatrix(bool alower, bool aunit, bool atrans, pchmatrix a,
 HEADER_PREFIX void
 lrdecomp_hmatrix(phmatrix a, pctruncmode tm, real eps);
 
+/** @brief Compute the LR factorization,
+ *  @f$A \approx L R@f$, using OpenMP tasks.
+ *
+ *  On the upper <tt>pardepth</tt> levels of the matrix tree, the
+ *  factorization of diagonal blocks, the triangular solves and the
+ *  updates of the block algorithm are expressed as tasks whose
+ *  dependencies are given by the submatrices they read and write.
+ *  The updates of every submatrix are carried out in the same order
+ *  as by @ref lrdecomp_hmatrix, so the results coincide.
+ *
+ *  @param a Source matrix @f$A@f$, will be overwritten
+ *     by @f$L@f$ and @f$R@f$.
+ *  @param tm Truncation mode.
+ *  @param eps Truncation accuracy.
+ *  @param pardepth Parallelization depth. */
+HEADER_PREFIX void
+lrdecomp_parallel_hmatrix(phmatrix a, pctruncmode tm, real eps,
+			  uint pardepth);
+
 /** @brief Solve the linear systems @f$A x = b@f$ or @f$A^* x = b@f$
  *  using the LR factorization provided by @ref lrdecomp_hmatrix.
  *
@@ -414,6 +497,9 @@ lrsolve_hmatrix_avector(bool atrans, pchmatrix a, pavector x);
  *  The strictly upper triangular part of the source matrix is
  *  not used.
  *
+ *  @remark The factorization is computed sequentially, see
+ *  @ref choldecomp_parallel_hmatrix for a task-parallel version.
+ *
  *  @param a Source matrix @f$A@f$, lower triangular part will be overwritten
  *    by @f$L@f$.
  *  @param tm Truncation mode.
@@ -421,6 +507,21 @@ lrsolve_hmatrix_avector(bool atrans, pchmatrix a, pavector x);
 HEADER_PREFIX void
 choldecomp_hmatrix(phmatrix a, pctruncmode tm, real eps);
 
+/** @brief Compute the Cholesky factorization,
+ *  @f$A \approx L L^*@f$, using OpenMP tasks.
+ *
+ *  Works like @ref lrdecomp_parallel_hmatrix, the results coincide
+ *  with those of @ref choldecomp_hmatrix.
+ *
+ *  @param a Source matrix @f$A@f$, lower triangular part will be overwritten
+ *    by @f$L@f$.
+ *  @param tm Truncation mode.
+ *  @param eps Truncation accuracy.
+ *  @param pardepth Parallelization depth. */
+HEADER_PREFIX void
+choldecomp_parallel_hmatrix(phmatrix a, pctruncmode tm, real eps,
+			    uint pardepth);
+
 /** @brief Solve the linear system @f$A x = b@f$ using the Cholesky
  *  factorization provided by @ref choldecomp_hmatrix.
  *
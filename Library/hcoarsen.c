@@ -14,6 +14,7 @@ coarsen_hmatrix(phmatrix G, real eps, bool recursive)
 
   phmatrix  son;
   prkmatrix R;
+  amatrix   Ttmp, Stmp;
   pamatrix  A, B, T, S;
   uint      i, j, leafs, ranksum, rankoffset, rowoffset, coloffset, rank;
   size_t    sizeold, sizenew;
@@ -70,8 +71,6 @@ coarsen_hmatrix(phmatrix G, real eps, bool recursive)
     B = &R->B;
     clear_amatrix(A);
     clear_amatrix(B);
-    T = new_amatrix(0, 0);
-    S = new_amatrix(0, 0);
 
     /* copy sons into a big rank-k-matrix */
     rankoffset = 0;
@@ -82,8 +81,10 @@ coarsen_hmatrix(phmatrix G, real eps, bool recursive)
 	son = G->son[i + j * rsons];
 	rank = son->r ? son->r->k : son->f->cols;
 
-	init_sub_amatrix(T, A, son->rc->size, rowoffset, rank, rankoffset);
-	init_sub_amatrix(S, B, son->cc->size, coloffset, rank, rankoffset);
+	T = init_sub_amatrix(&Ttmp, A, son->rc->size, rowoffset, rank,
+			     rankoffset);
+	S = init_sub_amatrix(&Stmp, B, son->cc->size, coloffset, rank,
+			     rankoffset);
 
 	if (son->r) {
 	  copy_amatrix(false, &(son->r->A), T);
@@ -115,6 +116,9 @@ coarsen_hmatrix(phmatrix G, real eps, bool recursive)
 	}
       }
 
+      if (G->arena == NULL || !contains_arena(G->arena, G->son))
+	freemem(G->son);
+
       G->rsons = 0;
       G->csons = 0;
       G->son = NULL;
@@ -7,6 +7,7 @@
 #include <stdio.h>
 
 #include "hmatrix.h"
+#include "harith.h"
 #include "basic.h"
 
 /* ------------------------------------------------------------
@@ -29,6 +30,11 @@ init_hmatrix(phmatrix hm, pccluster rc, pccluster cc)
   hm->refs = 0;
   hm->desc = 0;
 
+  hm->arena = NULL;
+
+  hm->pending = 0;
+  hm->reserved = 0;
+
   return hm;
 }
 
@@ -45,14 +51,25 @@ uninit_hmatrix(phmatrix hm)
     for (j = 0; j < csons; j++)
       for (i = 0; i < rsons; i++)
 	unref_hmatrix(hm->son[i + j * rsons]);
-    freemem(hm->son);
+    if (hm->arena == NULL || !contains_arena(hm->arena, hm->son))
+      freemem(hm->son);
   }
 
-  if (hm->f)
-    del_amatrix(hm->f);
+  /* Objects taken from the arena are released together with it,
+     objects attached later, e.g., by coarsening, are released here */
+  if (hm->f) {
+    if (hm->arena && contains_arena(hm->arena, hm->f))
+      uninit_amatrix(hm->f);
+    else
+      del_amatrix(hm->f);
+  }
 
-  if (hm->r)
-    del_rkmatrix(hm->r);
+  if (hm->r) {
+    if (hm->arena && contains_arena(hm->arena, hm->r))
+      uninit_rkmatrix(hm->r);
+    else
+      del_rkmatrix(hm->r);
+  }
 }
 
 phmatrix
@@ -172,6 +189,8 @@ clone_hmatrix(pchmatrix src)
     hm = new_rk_hmatrix(src->rc, src->cc, src->r->k);
     copy_amatrix(false, &src->r->A, &hm->r->A);
     copy_amatrix(false, &src->r->B, &hm->r->B);
+    hm->pending = src->pending;
+    hm->reserved = hm->r->k;
   }
   else {
     assert(src->f != NULL);
@@ -208,9 +227,14 @@ update_hmatrix(phmatrix hm)
 void
 del_hmatrix(phmatrix hm)
 {
+  parena    pa = hm->arena;
+
   uninit_hmatrix(hm);
 
-  freemem(hm);
+  if (pa)
+    unref_arena(pa);
+  else
+    freemem(hm);
 }
 
 /* ------------------------------------------------------------
@@ -244,6 +268,20 @@ unref_hmatrix(phmatrix hm)
  Statistics
  ------------------------------------------------------------ */
 
+/* Coefficients of nearfield leaves taken from an arena are not owned
+   by their amatrix, but still belong to the hmatrix */
+static size_t
+getsize_nearfield(pchmatrix hm)
+{
+  size_t    sz;
+
+  sz = getsize_amatrix(hm->f);
+  if (hm->f->owner && hm->arena && contains_arena(hm->arena, hm->f->a))
+    sz += (size_t) sizeof(field) * hm->f->rows * hm->f->cols;
+
+  return sz;
+}
+
 size_t
 getsize_hmatrix(pchmatrix hm)
 {
@@ -258,7 +296,7 @@ getsize_hmatrix(pchmatrix hm)
     sz += getsize_rkmatrix(hm->r);
 
   if (hm->f)
-    sz += getsize_amatrix(hm->f);
+    sz += getsize_nearfield(hm);
 
   for (j = 0; j < csons; j++)
     for (i = 0; i < rsons; i++)
@@ -278,7 +316,7 @@ getnearsize_hmatrix(pchmatrix hm)
   sz = 0;
 
   if (hm->f)
-    sz += getsize_amatrix(hm->f);
+    sz += getsize_nearfield(hm);
 
   for (j = 0; j < csons; j++)
     for (i = 0; i < rsons; i++)
@@ -364,6 +402,8 @@ copy_hmatrix(pchmatrix src, phmatrix trg)
     }
     copy_amatrix(false, &src->r->A, &trg->r->A);
     copy_amatrix(false, &src->r->B, &trg->r->B);
+    trg->pending = src->pending;
+    trg->reserved = trg->r->k;
   }
   else {
     assert(src->f != NULL);
@@ -411,6 +451,101 @@ build_from_block_hmatrix(pcblock b, uint k)
   return h;
 }
 
+static size_t
+arenasize_block(pcblock b)
+{
+  size_t    sz;
+  uint      i;
+
+  /* Leave room for padding of every object */
+  sz = sizeof(hmatrix) + 16;
+
+  if (b->son) {
+    sz += sizeof(phmatrix) * b->rsons * b->csons + 16;
+
+    for (i = 0; i < b->rsons * b->csons; i++)
+      sz += arenasize_block(b->son[i]);
+  }
+  else if (b->a > 0)
+    sz += sizeof(rkmatrix) + 16;
+  else
+    sz += sizeof(amatrix) + 16
+      + (size_t) sizeof(field) * b->rc->size * b->cc->size + 16;
+
+  return sz;
+}
+
+static phmatrix
+new_arena_hmatrix(parena pa, pccluster rc, pccluster cc)
+{
+  phmatrix  hm;
+
+  hm = (phmatrix) allocarena(pa, sizeof(hmatrix));
+
+  init_hmatrix(hm, rc, cc);
+
+  ref_arena(&hm->arena, pa);
+
+  return hm;
+}
+
+static phmatrix
+build_from_block_arena(pcblock b, uint k, parena pa)
+{
+  phmatrix  h, h1;
+  pcblock   b1;
+  uint      rsons, csons;
+  uint      i, j;
+
+  h = new_arena_hmatrix(pa, b->rc, b->cc);
+
+  if (b->son) {
+    rsons = b->rsons;
+    csons = b->csons;
+
+    h->rsons = rsons;
+    h->csons = csons;
+
+    h->son = (phmatrix *) allocarena(pa, (size_t) sizeof(phmatrix)
+				     * rsons * csons);
+
+    for (j = 0; j < csons; j++) {
+      for (i = 0; i < rsons; i++) {
+	b1 = b->son[i + j * rsons];
+
+	h->son[i + j * rsons] = NULL;
+
+	h1 = build_from_block_arena(b1, k, pa);
+
+	ref_hmatrix(h->son + i + j * rsons, h1);
+      }
+    }
+  }
+  else if (b->a > 0)
+    h->r = init_rkmatrix((prkmatrix) allocarena(pa, sizeof(rkmatrix)),
+			 b->rc->size, b->cc->size, k);
+  else
+    h->f = init_pointer_amatrix((pamatrix) allocarena(pa, sizeof(amatrix)),
+				(pfield) allocarena(pa, (size_t) sizeof(field)
+						    * b->rc->size
+						    * b->cc->size),
+				b->rc->size, b->cc->size);
+
+  update_hmatrix(h);
+
+  return h;
+}
+
+phmatrix
+build_from_block_arena_hmatrix(pcblock b, uint k)
+{
+  parena    pa;
+
+  pa = new_arena(arenasize_block(b));
+
+  return build_from_block_arena(b, k, pa);
+}
+
 /* ------------------------------------------------------------
  Matrix-vector multiplication
  ------------------------------------------------------------ */
@@ -472,6 +607,69 @@ fastaddeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
   }
 }
 
+void
+fastaddeval_parallel_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
+				     pavector y, uint pardepth)
+{
+  pavector *x1, *y1;
+  uint      rsons, csons;
+#ifdef USE_OPENMP
+  uint      nthreads;		/* HACK: Solaris workaround */
+#endif
+  uint      xoff, yoff, i, j;
+
+  assert(x->dim == hm->cc->size);
+  assert(y->dim == hm->rc->size);
+
+  if (pardepth == 0 || hm->son == NULL) {
+    fastaddeval_hmatrix_avector(alpha, hm, x, y);
+    return;
+  }
+
+  rsons = hm->rsons;
+  csons = hm->csons;
+
+  /* Subvectors of x are only read, so they can be shared by all threads */
+  x1 = (pavector *) allocmem((size_t) sizeof(pavector) * csons);
+  xoff = 0;
+  for (j = 0; j < csons; j++) {
+    x1[j] = new_sub_avector((pavector) x, hm->son[j * rsons]->cc->size,
+			    xoff);
+    xoff += hm->son[j * rsons]->cc->size;
+  }
+  assert(xoff == hm->cc->size);
+
+  /* Each block row writes to its own subvector of y */
+  y1 = (pavector *) allocmem((size_t) sizeof(pavector) * rsons);
+  yoff = 0;
+  for (i = 0; i < rsons; i++) {
+    y1[i] = new_sub_avector(y, hm->son[i]->rc->size, yoff);
+    yoff += hm->son[i]->rc->size;
+  }
+  assert(yoff == hm->rc->size);
+
+  /* Block rows are handled in parallel, the blocks within a row are
+     handled in the same order as in fastaddeval_hmatrix_avector, so
+     the result does not depend on the number of threads. */
+#ifdef USE_OPENMP
+  nthreads = rsons;
+  (void) nthreads;
+#pragma omp parallel for if(pardepth > 0), num_threads(nthreads), private(j)
+#endif
+  for (i = 0; i < rsons; i++)
+    for (j = 0; j < csons; j++)
+      fastaddeval_parallel_hmatrix_avector(alpha, hm->son[i + j * rsons],
+					   x1[j], y1[i], pardepth - 1);
+
+  for (i = 0; i < rsons; i++)
+    del_avector(y1[i]);
+  freemem(y1);
+
+  for (j = 0; j < csons; j++)
+    del_avector(x1[j]);
+  freemem(x1);
+}
+
 void
 addeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x, pavector y)
 {
@@ -499,7 +697,11 @@ addeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x, pavector y)
   }
 
   /* Matrix-vector multiplication */
+#ifdef USE_OPENMP
+  fastaddeval_parallel_hmatrix_avector(alpha, hm, xp, yp, max_pardepth);
+#else
   fastaddeval_hmatrix_avector(alpha, hm, xp, yp);
+#endif
 
   /* Reverse permutation of y */
   for (i = 0; i < yp->dim; i++) {
@@ -560,6 +762,70 @@ fastaddevaltrans_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
   }
 }
 
+void
+fastaddevaltrans_parallel_hmatrix_avector(field alpha, pchmatrix hm,
+					  pcavector x, pavector y,
+					  uint pardepth)
+{
+  pavector *x1, *y1;
+  uint      rsons, csons;
+#ifdef USE_OPENMP
+  uint      nthreads;		/* HACK: Solaris workaround */
+#endif
+  uint      xoff, yoff, i, j;
+
+  assert(x->dim == hm->rc->size);
+  assert(y->dim == hm->cc->size);
+
+  if (pardepth == 0 || hm->son == NULL) {
+    fastaddevaltrans_hmatrix_avector(alpha, hm, x, y);
+    return;
+  }
+
+  rsons = hm->rsons;
+  csons = hm->csons;
+
+  /* Subvectors of x are only read, so they can be shared by all threads */
+  x1 = (pavector *) allocmem((size_t) sizeof(pavector) * rsons);
+  xoff = 0;
+  for (i = 0; i < rsons; i++) {
+    x1[i] = new_sub_avector((pavector) x, hm->son[i]->rc->size, xoff);
+    xoff += hm->son[i]->rc->size;
+  }
+  assert(xoff == hm->rc->size);
+
+  /* Each block column writes to its own subvector of y */
+  y1 = (pavector *) allocmem((size_t) sizeof(pavector) * csons);
+  yoff = 0;
+  for (j = 0; j < csons; j++) {
+    y1[j] = new_sub_avector(y, hm->son[j * rsons]->cc->size, yoff);
+    yoff += hm->son[j * rsons]->cc->size;
+  }
+  assert(yoff == hm->cc->size);
+
+  /* Block columns are handled in parallel, the blocks within a column
+     are handled in the same order as in fastaddevaltrans_hmatrix_avector,
+     so the result does not depend on the number of threads. */
+#ifdef USE_OPENMP
+  nthreads = csons;
+  (void) nthreads;
+#pragma omp parallel for if(pardepth > 0), num_threads(nthreads), private(i)
+#endif
+  for (j = 0; j < csons; j++)
+    for (i = 0; i < rsons; i++)
+      fastaddevaltrans_parallel_hmatrix_avector(alpha,
+						hm->son[i + j * rsons],
+						x1[i], y1[j], pardepth - 1);
+
+  for (j = 0; j < csons; j++)
+    del_avector(y1[j]);
+  freemem(y1);
+
+  for (i = 0; i < rsons; i++)
+    del_avector(x1[i]);
+  freemem(x1);
+}
+
 void
 addevaltrans_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
 			     pavector y)
@@ -588,7 +854,11 @@ addevaltrans_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
   }
 
   /* Matrix-vector multiplication */
+#ifdef USE_OPENMP
+  fastaddevaltrans_parallel_hmatrix_avector(alpha, hm, xp, yp, max_pardepth);
+#else
   fastaddevaltrans_hmatrix_avector(alpha, hm, xp, yp);
+#endif
 
   /* Reverse permutation of y */
   for (i = 0; i < yp->dim; i++) {
@@ -788,6 +1058,93 @@ addevalsymm_hmatrix_avector(field alpha, pchmatrix hm,
   uninit_avector(xp);
 }
 
+/* ------------------------------------------------------------
+ Multiplication by blocks of vectors
+ ------------------------------------------------------------ */
+
+void
+mvm_hmatrix_amatrix(field alpha, bool atrans, pchmatrix a, pcamatrix X,
+		    pamatrix Y)
+{
+  if (atrans)
+    addevaltrans_hmatrix_amatrix(alpha, a, X, Y);
+  else
+    addeval_hmatrix_amatrix(alpha, a, X, Y);
+}
+
+void
+fastaddeval_hmatrix_amatrix(field alpha, pchmatrix hm, pcamatrix X,
+			    pamatrix Y)
+{
+  addmul_hmatrix_amatrix_amatrix(alpha, false, hm, false, X, false, Y);
+}
+
+void
+fastaddevaltrans_hmatrix_amatrix(field alpha, pchmatrix hm, pcamatrix X,
+				 pamatrix Y)
+{
+  addmul_hmatrix_amatrix_amatrix(alpha, true, hm, false, X, false, Y);
+}
+
+static void
+addeval_permuted(field alpha, bool atrans, pchmatrix hm, pcamatrix X,
+		 pamatrix Y)
+{
+  amatrix   tmp1, tmp2;
+  pamatrix  Xp, Yp;
+  pccluster xc = (atrans ? hm->rc : hm->cc);
+  pccluster yc = (atrans ? hm->cc : hm->rc);
+  uint      i, j, ip;
+
+  assert(X->rows == xc->size);
+  assert(Y->rows == yc->size);
+  assert(X->cols == Y->cols);
+
+  /* Permutation of X */
+  Xp = init_amatrix(&tmp1, X->rows, X->cols);
+  for (j = 0; j < X->cols; j++)
+    for (i = 0; i < X->rows; i++) {
+      ip = xc->idx[i];
+      assert(ip < X->rows);
+      Xp->a[i + j * Xp->ld] = X->a[ip + j * X->ld];
+    }
+
+  /* Permutation of Y */
+  Yp = init_amatrix(&tmp2, Y->rows, Y->cols);
+  for (j = 0; j < Y->cols; j++)
+    for (i = 0; i < Y->rows; i++) {
+      ip = yc->idx[i];
+      assert(ip < Y->rows);
+      Yp->a[i + j * Yp->ld] = Y->a[ip + j * Y->ld];
+    }
+
+  /* Matrix multiplication */
+  addmul_hmatrix_amatrix_amatrix(alpha, atrans, hm, false, Xp, false, Yp);
+
+  /* Reverse permutation of Y */
+  for (j = 0; j < Y->cols; j++)
+    for (i = 0; i < Y->rows; i++) {
+      ip = yc->idx[i];
+      Y->a[ip + j * Y->ld] = Yp->a[i + j * Yp->ld];
+    }
+
+  uninit_amatrix(Yp);
+  uninit_amatrix(Xp);
+}
+
+void
+addeval_hmatrix_amatrix(field alpha, pchmatrix hm, pcamatrix X, pamatrix Y)
+{
+  addeval_permuted(alpha, false, hm, X, Y);
+}
+
+void
+addevaltrans_hmatrix_amatrix(field alpha, pchmatrix hm, pcamatrix X,
+			     pamatrix Y)
+{
+  addeval_permuted(alpha, true, hm, X, Y);
+}
+
 /* ------------------------------------------------------------
  Enumeration
  ------------------------------------------------------------ */
@@ -67,6 +67,19 @@ struct _hmatrix {
   uint refs;
   /** @brief Number of descendants in matrix tree. */
   uint desc;
+
+  /** @brief @ref arena holding this object, <tt>NULL</tt> if it has
+   *  been allocated individually. */
+  parena arena;
+
+  /** @brief Rank of the low-rank updates accumulated in <tt>r</tt>
+   *  that have not been truncated yet, see @ref truncmode. */
+  uint pending;
+
+  /** @brief Number of columns allocated for the factors of <tt>r</tt>
+   *  while updates are pending, only meaningful if <tt>pending</tt>
+   *  is not zero. */
+  uint reserved;
 };
 
 /* ------------------------------------------------------------
@@ -282,6 +295,26 @@ copy_hmatrix(pchmatrix src, phmatrix trg);
 HEADER_PREFIX phmatrix
 build_from_block_hmatrix(pcblock b, uint k);
 
+/** @brief Build an @ref hmatrix object from a @ref block tree using
+ *  a given local rank, allocating all nodes from one @ref arena.
+ *
+ *  The @ref hmatrix, @ref rkmatrix and @ref amatrix objects, the
+ *  arrays of sons and the coefficients of nearfield leaves are taken
+ *  from an @ref arena sized for the block tree. The factors of
+ *  low-rank leaves are still allocated individually, so that ranks
+ *  can be changed later.
+ *  The arena is released automatically when the last of its nodes
+ *  is deleted.
+ *
+ *  @remark Submatrices for far- and nearfield leaves are created,
+ *  but their coefficients are not initialized.
+ *
+ *  @param b Block tree.
+ *  @param k Local rank.
+ *  @returns New @ref hmatrix object. */
+HEADER_PREFIX phmatrix
+build_from_block_arena_hmatrix(pcblock b, uint k);
+
 /* ------------------------------------------------------------
    Matrix-vector multiplication
    ------------------------------------------------------------ */
@@ -317,6 +350,26 @@ mvm_hmatrix_avector(field alpha, bool atrans, pchmatrix a,
 HEADER_PREFIX void
 fastaddeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector xp, pavector yp);
 
+/** @brief Parallel matrix-vector multiplication
+ *  @f$y \gets y + \alpha A x@f$.
+ *
+ *  Parallel version of @ref fastaddeval_hmatrix_avector.
+ *  Block rows are handled by different threads, so there are no write
+ *  conflicts, and the blocks within each row are processed in the same
+ *  order as in the sequential version. The result is therefore identical
+ *  to that of @ref fastaddeval_hmatrix_avector for any number of threads.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param hm Matrix @f$A@f$.
+ *  @param xp Source vector @f$x@f$ in cluster numbering
+ *            with respect to <tt>hm->cc</tt>.
+ *  @param yp Target vector @f$y@f$ in cluster numbering
+ *            with respect to <tt>hm->rc</tt>.
+ *  @param pardepth Parallelization depth. */
+HEADER_PREFIX void
+fastaddeval_parallel_hmatrix_avector(field alpha, pchmatrix hm,
+				     pcavector xp, pavector yp, uint pardepth);
+
 /** @brief Matrix-vector multiplication
  *  @f$y \gets y + \alpha A x@f$.
  *
@@ -347,6 +400,25 @@ HEADER_PREFIX void
 fastaddevaltrans_hmatrix_avector(field alpha, pchmatrix hm,
 			 pcavector xp, pavector yp);
 
+/** @brief Parallel adjoint matrix-vector multiplication
+ *  @f$y \gets y + \alpha A^* x@f$.
+ *
+ *  Parallel version of @ref fastaddevaltrans_hmatrix_avector.
+ *  Block columns are handled by different threads, and the result is
+ *  identical to that of the sequential version for any number of threads.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param hm Matrix @f$A@f$.
+ *  @param xp Source vector @f$x@f$ in cluster numbering
+ *            with respect to <tt>hm->rc</tt>.
+ *  @param yp Target vector @f$y@f$ in cluster numbering
+ *            with respect to <tt>hm->cc</tt>.
+ *  @param pardepth Parallelization depth. */
+HEADER_PREFIX void
+fastaddevaltrans_parallel_hmatrix_avector(field alpha, pchmatrix hm,
+					  pcavector xp, pavector yp,
+					  uint pardepth);
+
 /** @brief Adjoint matrix-vector multiplication
  *  @f$y \gets y + \alpha A^* x@f$.
  *
@@ -393,6 +465,80 @@ HEADER_PREFIX void
 addevalsymm_hmatrix_avector(field alpha, pchmatrix hm,
 			    pcavector x, pavector y);
 
+/* ------------------------------------------------------------
+   Multiplication by blocks of vectors
+   ------------------------------------------------------------ */
+
+/** @brief Matrix multiplication
+ *  @f$Y \gets Y + \alpha A X@f$ or @f$Y \gets Y + \alpha A^* X@f$.
+ *
+ *  Version of @ref mvm_hmatrix_avector that multiplies by all columns
+ *  of @f$X@f$ simultaneously, so the block tree is traversed only once
+ *  and every leaf is handled by matrix-matrix products.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param atrans Set if @f$A^*@f$ is to be used instead of @f$A@f$.
+ *  @param a Matrix @f$A@f$.
+ *  @param X Source matrix @f$X@f$.
+ *  @param Y Target matrix @f$Y@f$. */
+HEADER_PREFIX void
+mvm_hmatrix_amatrix(field alpha, bool atrans, pchmatrix a,
+		    pcamatrix X, pamatrix Y);
+
+/** @brief Matrix multiplication
+ *  @f$Y \gets Y + \alpha A X@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param hm Matrix @f$A@f$.
+ *  @param Xp Source matrix @f$X@f$, rows in cluster numbering
+ *            with respect to <tt>hm->cc</tt>.
+ *  @param Yp Target matrix @f$Y@f$, rows in cluster numbering
+ *            with respect to <tt>hm->rc</tt>. */
+HEADER_PREFIX void
+fastaddeval_hmatrix_amatrix(field alpha, pchmatrix hm,
+			    pcamatrix Xp, pamatrix Yp);
+
+/** @brief Matrix multiplication
+ *  @f$Y \gets Y + \alpha A X@f$.
+ *
+ *  Each column of @f$X@f$ is treated like a source vector in
+ *  @ref addeval_hmatrix_avector.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param hm Matrix @f$A@f$.
+ *  @param X Source matrix @f$X@f$.
+ *  @param Y Target matrix @f$Y@f$. */
+HEADER_PREFIX void
+addeval_hmatrix_amatrix(field alpha, pchmatrix hm,
+			pcamatrix X, pamatrix Y);
+
+/** @brief Adjoint matrix multiplication
+ *  @f$Y \gets Y + \alpha A^* X@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param hm Matrix @f$A@f$.
+ *  @param Xp Source matrix @f$X@f$, rows in cluster numbering
+ *            with respect to <tt>hm->rc</tt>.
+ *  @param Yp Target matrix @f$Y@f$, rows in cluster numbering
+ *            with respect to <tt>hm->cc</tt>. */
+HEADER_PREFIX void
+fastaddevaltrans_hmatrix_amatrix(field alpha, pchmatrix hm,
+				 pcamatrix Xp, pamatrix Yp);
+
+/** @brief Adjoint matrix multiplication
+ *  @f$Y \gets Y + \alpha A^* X@f$.
+ *
+ *  Each column of @f$X@f$ is treated like a source vector in
+ *  @ref addevaltrans_hmatrix_avector.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param hm Matrix @f$A@f$.
+ *  @param X Source matrix @f$X@f$.
+ *  @param Y Target matrix @f$Y@f$. */
+HEADER_PREFIX void
+addevaltrans_hmatrix_amatrix(field alpha, pchmatrix hm,
+			     pcamatrix X, pamatrix Y);
+
 /* ------------------------------------------------------------
    Enumeration by block number
    ------------------------------------------------------------ */
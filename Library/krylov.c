@@ -626,3 +626,918 @@ finish_pgmres(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata, pcavect
 
   init_pgmres(addeval, matrix, prcd, pdata, b, x, rhat, q, kk, qr, tau);
 }
+
+/* ------------------------------------------------------------
+   CGS2 GMRES method, i.e., GMRES with classical Gram-Schmidt
+   and reorthogonalization
+   ------------------------------------------------------------ */
+
+static void
+init_cgs2(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata,
+	  pcavector b, pavector x, pavector rhat, uint * kk,
+	  pamatrix qb, pamatrix hess)
+{
+  avector   tmp;
+  pavector  r;
+  real      beta;
+
+  assert(b->dim == x->dim);
+  assert(b->dim == qb->rows);
+  assert(qb->cols <= rhat->dim);
+  assert(qb->cols <= hess->rows);
+  assert(qb->cols <= hess->cols + 1);
+
+  *kk = 0;
+
+  if (qb->cols < 1)
+    return;
+
+  /* Normalized residual in the first column of qb */
+  r = init_column_avector(&tmp, qb, 0);
+  copy_avector(b, r);
+  addeval(-1.0, matrix, x, r);
+  if (prcd)
+    prcd(pdata, r);
+  beta = norm2_avector(r);
+  if (beta > 0.0)
+    scale_avector(1.0 / beta, r);
+  uninit_avector(r);
+
+  /* Set up transformed residual */
+  clear_avector(rhat);
+  rhat->v[0] = beta;
+}
+
+/* If sw is not null, the time spent in orthogonalization is added
+   to *t_ortho */
+static void
+step_cgs2(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata,
+	  pavector rhat, uint * kk, pamatrix qb, pamatrix hess,
+	  pstopwatch sw, real * t_ortho)
+{
+  avector   tmp1, tmp2, tmp3, tmp4, tmp5;
+  amatrix   tmp6;
+  pavector  q, a, hcol, h, s;
+  pamatrix  qb_k;
+  field     rho;
+  real      beta;
+  uint      k = *kk;
+  uint      ldh = hess->ld;
+  uint      i;
+
+  if (k + 1 >= qb->cols)
+    return;
+
+  /* (k+1)-th Krylov vector A q_k in the (k+1)-th column of qb */
+  q = init_column_avector(&tmp1, qb, k);
+  a = init_column_avector(&tmp2, qb, k + 1);
+  clear_avector(a);
+  addeval(1.0, matrix, q, a);
+  if (prcd)
+    prcd(pdata, a);
+  uninit_avector(q);
+
+  if (sw)
+    start_stopwatch(sw);
+
+  /* Classical Gram-Schmidt with one reorthogonalization step,
+     each pass requiring two matrix-vector products (gemv) with
+     the current basis instead of k+1 elementary reflections */
+  qb_k = init_sub_amatrix(&tmp6, qb, qb->rows, 0, k + 1, 0);
+  hcol = init_column_avector(&tmp3, hess, k);
+  h = init_sub_avector(&tmp4, hcol, k + 1, 0);
+  clear_avector(h);
+  addevaltrans_amatrix_avector(1.0, qb_k, a, h);
+  addeval_amatrix_avector(-1.0, qb_k, h, a);
+
+  s = init_avector(&tmp5, k + 1);
+  clear_avector(s);
+  addevaltrans_amatrix_avector(1.0, qb_k, a, s);
+  addeval_amatrix_avector(-1.0, qb_k, s, a);
+  add_avector(1.0, s, h);
+  uninit_avector(s);
+  uninit_avector(h);
+  uninit_avector(hcol);
+  uninit_amatrix(qb_k);
+
+  /* Normalize next basis vector */
+  beta = norm2_avector(a);
+  if (beta > 0.0)
+    scale_avector(1.0 / beta, a);
+  uninit_avector(a);
+  hess->a[(k + 1) + k * ldh] = beta;
+
+  if (sw)
+    *t_ortho += stop_stopwatch(sw);
+
+  /* Apply preceding Givens rotations */
+  for (i = 0; i < k; i++) {
+    rho = hess->a[(i + 1) + i * ldh];
+    apply_givens(rho, hess->a + i + k * ldh, hess->a + (i + 1) + k * ldh);
+  }
+
+  /* Eliminate subdiagonal, the rotation is stored in its place */
+  rho = findapply_givens(hess->a + k + k * ldh,
+			 hess->a + (k + 1) + k * ldh);
+  hess->a[(k + 1) + k * ldh] = rho;
+  apply_givens(rho, rhat->v + k, rhat->v + (k + 1));
+
+  /* Increase dimension */
+  *kk = k + 1;
+}
+
+static void
+update_cgs2(pavector x, pavector rhat, uint k, pamatrix qb,
+	    pamatrix hess)
+{
+  avector   tmp1;
+  amatrix   tmp2;
+  pavector  rhat_k;
+  pamatrix  sub;
+
+  if (k < 1)
+    return;
+
+  /* Solve the triangular least-squares system */
+  rhat_k = init_sub_avector(&tmp1, rhat, k, 0);
+  sub = init_sub_amatrix(&tmp2, hess, k, 0, k, 0);
+  triangularsolve_amatrix_avector(false, false, false, sub, rhat_k);
+  uninit_amatrix(sub);
+
+  /* Update the solution */
+  sub = init_sub_amatrix(&tmp2, qb, qb->rows, 0, k, 0);
+  addeval_amatrix_avector(1.0, sub, rhat_k, x);
+  uninit_amatrix(sub);
+  uninit_avector(rhat_k);
+}
+
+void
+init_cgs2gmres(addeval_t addeval, void *matrix, pcavector b, pavector x,
+	       pavector rhat, uint * kk, pamatrix qb, pamatrix hess)
+{
+  init_cgs2(addeval, matrix, NULL, NULL, b, x, rhat, kk, qb, hess);
+}
+
+void
+step_cgs2gmres(addeval_t addeval, void *matrix, pcavector b, pavector x,
+	       pavector rhat, uint * kk, pamatrix qb, pamatrix hess)
+{
+  (void) b;
+  (void) x;
+
+  step_cgs2(addeval, matrix, NULL, NULL, rhat, kk, qb, hess, NULL,
+	    NULL);
+}
+
+void
+finish_cgs2gmres(addeval_t addeval, void *matrix, pcavector b, pavector x,
+		 pavector rhat, uint * kk, pamatrix qb, pamatrix hess)
+{
+  update_cgs2(x, rhat, *kk, qb, hess);
+
+  init_cgs2(addeval, matrix, NULL, NULL, b, x, rhat, kk, qb, hess);
+}
+
+/* ------------------------------------------------------------
+   Preconditioned CGS2 GMRES method
+   ------------------------------------------------------------ */
+
+void
+init_pcgs2gmres(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata,
+		pcavector b, pavector x, pavector rhat, uint * kk,
+		pamatrix qb, pamatrix hess)
+{
+  init_cgs2(addeval, matrix, prcd, pdata, b, x, rhat, kk, qb, hess);
+}
+
+void
+step_pcgs2gmres(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata,
+		pcavector b, pavector x, pavector rhat, uint * kk,
+		pamatrix qb, pamatrix hess)
+{
+  (void) b;
+  (void) x;
+
+  step_cgs2(addeval, matrix, prcd, pdata, rhat, kk, qb, hess, NULL,
+	    NULL);
+}
+
+void
+finish_pcgs2gmres(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata,
+		  pcavector b, pavector x, pavector rhat, uint * kk,
+		  pamatrix qb, pamatrix hess)
+{
+  update_cgs2(x, rhat, *kk, qb, hess);
+
+  init_cgs2(addeval, matrix, prcd, pdata, b, x, rhat, kk, qb, hess);
+}
+
+/* ------------------------------------------------------------
+   Solver drivers with convergence history and timings
+   ------------------------------------------------------------ */
+
+pkrylovinfo
+new_krylovinfo(uint maxsteps)
+{
+  pkrylovinfo info;
+
+  info = (pkrylovinfo) allocmem(sizeof(krylovinfo));
+  info->res = allocreal(maxsteps + 1);
+  info->maxsteps = maxsteps;
+  info->steps = 0;
+  info->converged = false;
+  info->t_mvm = 0.0;
+  info->t_prcd = 0.0;
+  info->t_ortho = 0.0;
+  info->t_other = 0.0;
+  info->t_total = 0.0;
+
+  return info;
+}
+
+void
+del_krylovinfo(pkrylovinfo info)
+{
+  freemem(info->res);
+  freemem(info);
+}
+
+/* Wraps the matrix and preconditioner callbacks to measure the time
+   spent in them */
+struct _krylovtimer {
+  addeval_t addeval;
+  addevalmat_t addevalmat;
+  void     *matrix;
+  prcd_t    prcd;
+  void     *pdata;
+
+  pstopwatch sw;
+  real      t_mvm;
+  real      t_prcd;
+  real      t_ortho;
+};
+
+static void
+timed_addeval(field alpha, void *data, pcavector x, pavector y)
+{
+  struct _krylovtimer *kt = (struct _krylovtimer *) data;
+
+  start_stopwatch(kt->sw);
+  kt->addeval(alpha, kt->matrix, x, y);
+  kt->t_mvm += stop_stopwatch(kt->sw);
+}
+
+static void
+timed_addevalmat(field alpha, void *data, pcamatrix x, pamatrix y)
+{
+  struct _krylovtimer *kt = (struct _krylovtimer *) data;
+
+  start_stopwatch(kt->sw);
+  kt->addevalmat(alpha, kt->matrix, x, y);
+  kt->t_mvm += stop_stopwatch(kt->sw);
+}
+
+static void
+timed_prcd(void *data, pavector r)
+{
+  struct _krylovtimer *kt = (struct _krylovtimer *) data;
+
+  start_stopwatch(kt->sw);
+  kt->prcd(kt->pdata, r);
+  kt->t_prcd += stop_stopwatch(kt->sw);
+}
+
+static void
+init_krylovtimer(struct _krylovtimer *kt, addeval_t addeval, void *matrix,
+		 prcd_t prcd, void *pdata)
+{
+  kt->addeval = addeval;
+  kt->addevalmat = NULL;
+  kt->matrix = matrix;
+  kt->prcd = prcd;
+  kt->pdata = pdata;
+  kt->sw = new_stopwatch();
+  kt->t_mvm = 0.0;
+  kt->t_prcd = 0.0;
+  kt->t_ortho = 0.0;
+}
+
+static void
+finish_krylovtimer(struct _krylovtimer *kt, pstopwatch sw, uint steps,
+		   bool converged, pkrylovinfo info)
+{
+  real      t_total;
+
+  t_total = stop_stopwatch(sw);
+
+  if (info) {
+    info->steps = steps;
+    info->converged = converged;
+    info->t_mvm = kt->t_mvm;
+    info->t_prcd = kt->t_prcd;
+    info->t_ortho = kt->t_ortho;
+    info->t_other = t_total - kt->t_mvm - kt->t_prcd - kt->t_ortho;
+    info->t_total = t_total;
+  }
+
+  del_stopwatch(kt->sw);
+}
+
+uint
+solve_cg(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata,
+	 pcavector b, pavector x, real eps, uint maxsteps, pkrylovinfo info)
+{
+  struct _krylovtimer kt;
+  pstopwatch sw;
+  pavector  r, q, p, a;
+  prcd_t    tprcd;
+  real      res, res0;
+  uint      n = b->dim;
+  uint      steps;
+
+  assert(info == NULL || info->maxsteps >= maxsteps);
+
+  sw = new_stopwatch();
+  start_stopwatch(sw);
+  init_krylovtimer(&kt, addeval, matrix, prcd, pdata);
+  tprcd = (prcd ? timed_prcd : NULL);
+
+  r = new_avector(n);
+  q = new_avector(n);
+  p = new_avector(n);
+  a = new_avector(n);
+
+  init_pcg(timed_addeval, &kt, tprcd, &kt, b, x, r, q, p, a);
+  res0 = res = norm2_avector(r);
+  if (info)
+    info->res[0] = res;
+
+  steps = 0;
+  while (steps < maxsteps && res > eps * res0) {
+    step_pcg(timed_addeval, &kt, tprcd, &kt, b, x, r, q, p, a);
+    res = norm2_avector(r);
+    steps++;
+    if (info)
+      info->res[steps] = res;
+  }
+
+  del_avector(a);
+  del_avector(p);
+  del_avector(q);
+  del_avector(r);
+
+  finish_krylovtimer(&kt, sw, steps, res <= eps * res0, info);
+  del_stopwatch(sw);
+
+  return steps;
+}
+
+uint
+solve_gmres(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata,
+	    pcavector b, pavector x, real eps, uint maxsteps, uint restart,
+	    pkrylovinfo info)
+{
+  struct _krylovtimer kt;
+  pstopwatch sw;
+  pamatrix  qb, hess;
+  pavector  rhat;
+  prcd_t    tprcd;
+  real      res, res0;
+  uint      n = b->dim;
+  uint      steps, k;
+
+  assert(restart > 0);
+  assert(info == NULL || info->maxsteps >= maxsteps);
+
+  sw = new_stopwatch();
+  start_stopwatch(sw);
+  init_krylovtimer(&kt, addeval, matrix, prcd, pdata);
+  tprcd = (prcd ? timed_prcd : NULL);
+
+  qb = new_amatrix(n, restart + 1);
+  hess = new_amatrix(restart + 1, restart);
+  rhat = new_avector(restart + 1);
+
+  init_cgs2(timed_addeval, &kt, tprcd, &kt, b, x, rhat, &k, qb, hess);
+  res0 = res = ABS(rhat->v[0]);
+  if (info)
+    info->res[0] = res;
+
+  steps = 0;
+  while (steps < maxsteps && res > eps * res0) {
+    if (k + 1 >= qb->cols) {
+      update_cgs2(x, rhat, k, qb, hess);
+      init_cgs2(timed_addeval, &kt, tprcd, &kt, b, x, rhat, &k, qb,
+		hess);
+    }
+
+    step_cgs2(timed_addeval, &kt, tprcd, &kt, rhat, &k, qb, hess,
+	      kt.sw, &kt.t_ortho);
+    res = ABS(rhat->v[k]);
+    steps++;
+    if (info)
+      info->res[steps] = res;
+  }
+  update_cgs2(x, rhat, k, qb, hess);
+
+  del_avector(rhat);
+  del_amatrix(hess);
+  del_amatrix(qb);
+
+  finish_krylovtimer(&kt, sw, steps, res <= eps * res0, info);
+  del_stopwatch(sw);
+
+  return steps;
+}
+
+uint
+solve_bicgstab(addeval_t addeval, void *matrix, pcavector b, pavector x,
+	       real eps, uint maxsteps, pkrylovinfo info)
+{
+  struct _krylovtimer kt;
+  pstopwatch sw;
+  pavector  r, rt, p, a, as;
+  real      res, res0;
+  uint      n = b->dim;
+  uint      steps;
+
+  assert(info == NULL || info->maxsteps >= maxsteps);
+
+  sw = new_stopwatch();
+  start_stopwatch(sw);
+  init_krylovtimer(&kt, addeval, matrix, NULL, NULL);
+
+  r = new_avector(n);
+  rt = new_avector(n);
+  p = new_avector(n);
+  a = new_avector(n);
+  as = new_avector(n);
+
+  init_bicgstab(timed_addeval, &kt, b, x, r, rt, p, a, as);
+  res0 = res = norm2_avector(r);
+  if (info)
+    info->res[0] = res;
+
+  steps = 0;
+  while (steps < maxsteps && res > eps * res0) {
+    step_bicgstab(timed_addeval, &kt, b, x, r, rt, p, a, as);
+    res = norm2_avector(r);
+    steps++;
+    if (info)
+      info->res[steps] = res;
+  }
+
+  del_avector(as);
+  del_avector(a);
+  del_avector(p);
+  del_avector(rt);
+  del_avector(r);
+
+  finish_krylovtimer(&kt, sw, steps, res <= eps * res0, info);
+  del_stopwatch(sw);
+
+  return steps;
+}
+
+/* ------------------------------------------------------------
+   Block conjugate gradient method
+   ------------------------------------------------------------ */
+
+/* Solve g x = b for the Cholesky factor g computed by choldecomp_amatrix */
+static void
+cholsolve_blockkrylov(pcamatrix g, pamatrix b)
+{
+  triangularsolve_amatrix(true, false, false, g, false, b);
+  triangularsolve_amatrix(true, false, true, g, false, b);
+}
+
+void
+init_blockcg(addevalmat_t addevalmat, void *matrix, pcamatrix b,
+	     pamatrix x, pamatrix r, pamatrix p, pamatrix a)
+{
+  (void) a;
+
+  assert(b->rows == x->rows && b->cols == x->cols);
+
+  copy_amatrix(false, b, r);	/* R = B - A X */
+  addevalmat(-1.0, matrix, x, r);
+
+  copy_amatrix(false, r, p);	/* P = R */
+}
+
+/* If sw is not null, the time spent in orthonormalizing the search
+   directions is added to *t_ortho */
+static void
+step_timed_blockcg(addevalmat_t addevalmat, void *matrix, pcamatrix b,
+		   pamatrix x, pamatrix r, pamatrix p, pamatrix a,
+		   pstopwatch sw, real * t_ortho)
+{
+  amatrix   tmp1, tmp2, tmp3;
+  avector   tmp4;
+  pamatrix  gamma, lambda, mu;
+  pavector  tau;
+  uint      s = p->cols;
+  uint      info;
+
+  (void) b;
+
+  gamma = init_amatrix(&tmp1, s, s);
+  lambda = init_amatrix(&tmp2, s, s);
+  mu = init_amatrix(&tmp3, s, s);
+  tau = init_avector(&tmp4, s);
+
+  if (sw)
+    start_stopwatch(sw);
+
+  /* Orthonormalize search directions to keep P^* A P well-conditioned
+     even if some columns of R have already converged */
+  qrdecomp_amatrix(p, tau);
+  qrexpand_amatrix(p, tau, a);
+  copy_amatrix(false, a, p);
+
+  if (sw)
+    *t_ortho += stop_stopwatch(sw);
+
+  clear_amatrix(a);		/* A = A P */
+  addevalmat(1.0, matrix, p, a);
+
+  clear_amatrix(gamma);		/* Gamma = P^* A P */
+  addmul_amatrix(1.0, true, p, false, a, gamma);
+  info = choldecomp_amatrix(gamma);
+  assert(info == 0);
+  (void) info;
+
+  clear_amatrix(lambda);	/* Lambda = Gamma^{-1} P^* R */
+  addmul_amatrix(1.0, true, p, false, r, lambda);
+  cholsolve_blockkrylov(gamma, lambda);
+
+  addmul_amatrix(1.0, false, p, false, lambda, x);	/* X = X + P Lambda */
+  addmul_amatrix(-1.0, false, a, false, lambda, r);	/* R = R - A Lambda */
+
+  clear_amatrix(mu);		/* Mu = Gamma^{-1} (A P)^* R */
+  addmul_amatrix(1.0, true, a, false, r, mu);
+  cholsolve_blockkrylov(gamma, mu);
+
+  copy_amatrix(false, r, a);	/* P = R - P Mu */
+  addmul_amatrix(-1.0, false, p, false, mu, a);
+  copy_amatrix(false, a, p);
+
+  uninit_avector(tau);
+  uninit_amatrix(mu);
+  uninit_amatrix(lambda);
+  uninit_amatrix(gamma);
+}
+
+void
+step_blockcg(addevalmat_t addevalmat, void *matrix, pcamatrix b,
+	     pamatrix x, pamatrix r, pamatrix p, pamatrix a)
+{
+  step_timed_blockcg(addevalmat, matrix, b, x, r, p, a, NULL, NULL);
+}
+
+/* ------------------------------------------------------------
+   Block GMRES method
+   ------------------------------------------------------------ */
+
+void
+init_blockgmres(addevalmat_t addevalmat, void *matrix, pcamatrix b,
+		pamatrix x, pamatrix rhat, uint * kk, pamatrix qb,
+		pamatrix hess, pavector tau)
+{
+  amatrix   tmp1, tmp2, tmp3;
+  avector   tmp4;
+  pamatrix  r, q0, rhat0;
+  pavector  tau0;
+  uint      s = b->cols;
+
+  assert(b->rows == x->rows && b->cols == x->cols);
+  assert(b->rows == qb->rows);
+  assert(qb->cols % s == 0);
+  assert(qb->cols <= rhat->rows && s <= rhat->cols);
+  assert(qb->cols <= hess->rows && qb->cols <= hess->cols + s);
+  assert(qb->cols <= tau->dim + s);
+
+  *kk = 0;
+
+  if (qb->cols < s)
+    return;
+
+  /* Residual R = B - A X */
+  r = init_amatrix(&tmp1, b->rows, s);
+  copy_amatrix(false, b, r);
+  addevalmat(-1.0, matrix, x, r);
+
+  /* First block of the basis and transformed residual from R = Q_0 S_0 */
+  tau0 = init_avector(&tmp4, s);
+  qrdecomp_amatrix(r, tau0);
+  q0 = init_sub_amatrix(&tmp2, qb, qb->rows, 0, s, 0);
+  qrexpand_amatrix(r, tau0, q0);
+  uninit_amatrix(q0);
+
+  clear_amatrix(rhat);
+  rhat0 = init_sub_amatrix(&tmp3, rhat, s, 0, s, 0);
+  copy_upper_amatrix(r, false, rhat0);
+  uninit_amatrix(rhat0);
+
+  uninit_avector(tau0);
+  uninit_amatrix(r);
+
+  clear_amatrix(hess);
+}
+
+/* If sw is not null, the time spent in orthogonalization is added
+   to *t_ortho */
+static void
+step_timed_blockgmres(addevalmat_t addevalmat, void *matrix, pcamatrix b,
+		      pamatrix x, pamatrix rhat, uint * kk, pamatrix qb,
+		      pamatrix hess, pavector tau, pstopwatch sw,
+		      real * t_ortho)
+{
+  amatrix   tmp1, tmp2, tmp3, tmp4, tmp5, tmp6;
+  avector   tmp7, tmp8;
+  pamatrix  qj, w, qb_k, h, hs, wr, refl, trg;
+  pavector  tau_j, tau0;
+  uint      s = b->cols;
+  uint      k = *kk;
+  uint      j;
+
+  (void) x;
+
+  if ((k + 2) * s > qb->cols)
+    return;
+
+  /* Next block A Q_k of the Krylov space */
+  qj = init_sub_amatrix(&tmp1, qb, qb->rows, 0, s, k * s);
+  w = init_sub_amatrix(&tmp2, qb, qb->rows, 0, s, (k + 1) * s);
+  clear_amatrix(w);
+  addevalmat(1.0, matrix, qj, w);
+  uninit_amatrix(qj);
+
+  if (sw)
+    start_stopwatch(sw);
+
+  /* Block classical Gram-Schmidt with reorthogonalization */
+  qb_k = init_sub_amatrix(&tmp3, qb, qb->rows, 0, (k + 1) * s, 0);
+  h = init_sub_amatrix(&tmp4, hess, (k + 1) * s, 0, s, k * s);
+  addmul_amatrix(1.0, true, qb_k, false, w, h);
+  addmul_amatrix(-1.0, false, qb_k, false, h, w);
+
+  hs = init_amatrix(&tmp5, (k + 1) * s, s);
+  clear_amatrix(hs);
+  addmul_amatrix(1.0, true, qb_k, false, w, hs);
+  addmul_amatrix(-1.0, false, qb_k, false, hs, w);
+  add_amatrix(1.0, false, hs, h);
+  uninit_amatrix(hs);
+  uninit_amatrix(h);
+  uninit_amatrix(qb_k);
+
+  /* Orthonormalize the new block, W = Q_{k+1} H_{k+1,k} */
+  wr = init_amatrix(&tmp5, qb->rows, s);
+  copy_amatrix(false, w, wr);
+  tau0 = init_avector(&tmp8, s);
+  qrdecomp_amatrix(wr, tau0);
+  qrexpand_amatrix(wr, tau0, w);
+  h = init_sub_amatrix(&tmp4, hess, s, (k + 1) * s, s, k * s);
+  copy_upper_amatrix(wr, false, h);
+  uninit_amatrix(h);
+  uninit_avector(tau0);
+  uninit_amatrix(wr);
+  uninit_amatrix(w);
+
+  if (sw)
+    *t_ortho += stop_stopwatch(sw);
+
+  /* Apply preceding block reflections to the new block column */
+  for (j = 0; j < k; j++) {
+    refl = init_sub_amatrix(&tmp3, hess, 2 * s, j * s, s, j * s);
+    trg = init_sub_amatrix(&tmp4, hess, 2 * s, j * s, s, k * s);
+    tau_j = init_sub_avector(&tmp7, tau, s, j * s);
+    qreval_amatrix(true, refl, tau_j, trg);
+    uninit_avector(tau_j);
+    uninit_amatrix(trg);
+    uninit_amatrix(refl);
+  }
+
+  /* Eliminate the subdiagonal block and update transformed residual */
+  refl = init_sub_amatrix(&tmp3, hess, 2 * s, k * s, s, k * s);
+  tau_j = init_sub_avector(&tmp7, tau, s, k * s);
+  qrdecomp_amatrix(refl, tau_j);
+  trg = init_sub_amatrix(&tmp6, rhat, 2 * s, k * s, s, 0);
+  qreval_amatrix(true, refl, tau_j, trg);
+  uninit_amatrix(trg);
+  uninit_avector(tau_j);
+  uninit_amatrix(refl);
+
+  *kk = k + 1;
+}
+
+void
+step_blockgmres(addevalmat_t addevalmat, void *matrix, pcamatrix b,
+		pamatrix x, pamatrix rhat, uint * kk, pamatrix qb,
+		pamatrix hess, pavector tau)
+{
+  step_timed_blockgmres(addevalmat, matrix, b, x, rhat, kk, qb, hess, tau,
+			NULL, NULL);
+}
+
+static void
+update_blockgmres(pamatrix x, pamatrix rhat, uint kk, pamatrix qb,
+		  pamatrix hess)
+{
+  amatrix   tmp1, tmp2;
+  pamatrix  r, y;
+  uint      k = kk * x->cols;
+
+  if (k < 1)
+    return;
+
+  /* Solve the triangular least-squares systems */
+  r = init_sub_amatrix(&tmp1, hess, k, 0, k, 0);
+  y = init_sub_amatrix(&tmp2, rhat, k, 0, x->cols, 0);
+  triangularsolve_amatrix(false, false, false, r, false, y);
+  uninit_amatrix(r);
+
+  /* Update the solutions */
+  r = init_sub_amatrix(&tmp1, qb, qb->rows, 0, k, 0);
+  addmul_amatrix(1.0, false, r, false, y, x);
+  uninit_amatrix(r);
+  uninit_amatrix(y);
+}
+
+void
+finish_blockgmres(addevalmat_t addevalmat, void *matrix, pcamatrix b,
+		  pamatrix x, pamatrix rhat, uint * kk, pamatrix qb,
+		  pamatrix hess, pavector tau)
+{
+  update_blockgmres(x, rhat, *kk, qb, hess);
+
+  init_blockgmres(addevalmat, matrix, b, x, rhat, kk, qb, hess, tau);
+}
+
+void
+residualnorms_blockgmres(pcamatrix rhat, uint kk, preal norms)
+{
+  uint      s = rhat->cols;
+  uint      i, j;
+  real      sum;
+
+  for (j = 0; j < s; j++) {
+    sum = 0.0;
+    for (i = 0; i < s; i++)
+      sum += ABSSQR(rhat->a[(kk * s + i) + j * rhat->ld]);
+    norms[j] = REAL_SQRT(sum);
+  }
+}
+
+/* ------------------------------------------------------------
+   Block solver drivers
+   ------------------------------------------------------------ */
+
+/* Largest ratio norms[j] / norms0[j] of all right-hand sides */
+static real
+maxrelative_blockkrylov(uint s, pcreal norms, pcreal norms0)
+{
+  real      res;
+  uint      j;
+
+  res = 0.0;
+  for (j = 0; j < s; j++)
+    if (norms0[j] > 0.0 && norms[j] > res * norms0[j])
+      res = norms[j] / norms0[j];
+
+  return res;
+}
+
+static void
+colnorms_blockkrylov(pcamatrix r, preal norms)
+{
+  real      sum;
+  uint      i, j;
+
+  for (j = 0; j < r->cols; j++) {
+    sum = 0.0;
+    for (i = 0; i < r->rows; i++)
+      sum += ABSSQR(r->a[i + j * r->ld]);
+    norms[j] = REAL_SQRT(sum);
+  }
+}
+
+uint
+solve_blockcg(addevalmat_t addevalmat, void *matrix, pcamatrix b,
+	      pamatrix x, real eps, uint maxsteps, pkrylovinfo info)
+{
+  struct _krylovtimer kt;
+  pstopwatch sw;
+  pamatrix  r, p, a;
+  preal     norms, norms0;
+  real      res;
+  uint      n = b->rows;
+  uint      s = b->cols;
+  uint      steps;
+
+  assert(info == NULL || info->maxsteps >= maxsteps);
+
+  sw = new_stopwatch();
+  start_stopwatch(sw);
+  init_krylovtimer(&kt, NULL, matrix, NULL, NULL);
+  kt.addevalmat = addevalmat;
+
+  r = new_amatrix(n, s);
+  p = new_amatrix(n, s);
+  a = new_amatrix(n, s);
+  norms = allocreal(s);
+  norms0 = allocreal(s);
+
+  init_blockcg(timed_addevalmat, &kt, b, x, r, p, a);
+  colnorms_blockkrylov(r, norms0);
+  res = (s > 0 ? 1.0 : 0.0);
+  if (info)
+    info->res[0] = res;
+
+  steps = 0;
+  while (steps < maxsteps && res > eps) {
+    step_timed_blockcg(timed_addevalmat, &kt, b, x, r, p, a, kt.sw,
+		       &kt.t_ortho);
+    colnorms_blockkrylov(r, norms);
+    res = maxrelative_blockkrylov(s, norms, norms0);
+    steps++;
+    if (info)
+      info->res[steps] = res;
+  }
+
+  freemem(norms0);
+  freemem(norms);
+  del_amatrix(a);
+  del_amatrix(p);
+  del_amatrix(r);
+
+  finish_krylovtimer(&kt, sw, steps, res <= eps, info);
+  del_stopwatch(sw);
+
+  return steps;
+}
+
+uint
+solve_blockgmres(addevalmat_t addevalmat, void *matrix, pcamatrix b,
+		 pamatrix x, real eps, uint maxsteps, uint restart,
+		 pkrylovinfo info)
+{
+  struct _krylovtimer kt;
+  pstopwatch sw;
+  pamatrix  qb, hess, rhat;
+  pavector  tau;
+  preal     norms, norms0;
+  real      res;
+  uint      n = b->rows;
+  uint      s = b->cols;
+  uint      steps, k;
+
+  assert(restart > 0);
+  assert(info == NULL || info->maxsteps >= maxsteps);
+
+  sw = new_stopwatch();
+  start_stopwatch(sw);
+  init_krylovtimer(&kt, NULL, matrix, NULL, NULL);
+  kt.addevalmat = addevalmat;
+
+  qb = new_amatrix(n, (restart + 1) * s);
+  hess = new_amatrix((restart + 1) * s, restart * s);
+  rhat = new_amatrix((restart + 1) * s, s);
+  tau = new_avector(restart * s);
+  norms = allocreal(s);
+  norms0 = allocreal(s);
+
+  init_blockgmres(timed_addevalmat, &kt, b, x, rhat, &k, qb, hess, tau);
+  residualnorms_blockgmres(rhat, k, norms0);
+  res = (s > 0 ? 1.0 : 0.0);
+  if (info)
+    info->res[0] = res;
+
+  steps = 0;
+  while (steps < maxsteps && res > eps) {
+    if ((k + 2) * s > qb->cols)
+      finish_blockgmres(timed_addevalmat, &kt, b, x, rhat, &k, qb, hess,
+			tau);
+
+    step_timed_blockgmres(timed_addevalmat, &kt, b, x, rhat, &k, qb, hess,
+			  tau, kt.sw, &kt.t_ortho);
+    residualnorms_blockgmres(rhat, k, norms);
+    res = maxrelative_blockkrylov(s, norms, norms0);
+    steps++;
+    if (info)
+      info->res[steps] = res;
+  }
+  update_blockgmres(x, rhat, k, qb, hess);
+
+  freemem(norms0);
+  freemem(norms);
+  del_avector(tau);
+  del_amatrix(rhat);
+  del_amatrix(hess);
+  del_amatrix(qb);
+
+  finish_krylovtimer(&kt, sw, steps, res <= eps, info);
+  del_stopwatch(sw);
+
+  return steps;
+}
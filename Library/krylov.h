@@ -52,6 +52,65 @@ typedef void (*addeval_t)(field alpha, void *matrix,
  *  @param r Source vector, will be overwritten by result. */
 typedef void (*prcd_t)(void *pdata, pavector r);
 
+/** @brief Multi-vector matrix callback.
+ *
+ *  Used to evaluate the system matrix @f$A@f$ for several vectors
+ *  at once, i.e., to perform @f$Y \gets Y + \alpha A X@f$, so that
+ *  hierarchical matrices have to be traversed only once for all
+ *  columns. Thin wrappers around @ref addmul_amatrix,
+ *  @ref addmul_hmatrix_amatrix_amatrix or
+ *  @ref addmul_h2matrix_amatrix_amatrix can be used.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param matrix Matrix data describing @f$A@f$.
+ *  @param x Source matrix @f$X@f$.
+ *  @param y Target matrix @f$Y@f$. */
+typedef void (*addevalmat_t)(field alpha, void *matrix,
+			     pcamatrix x, pamatrix y);
+
+/** @brief Convergence history and timings of an iterative solver. */
+typedef struct _krylovinfo krylovinfo;
+
+/** @brief Pointer to a @ref krylovinfo object. */
+typedef krylovinfo *pkrylovinfo;
+
+/** @brief Pointer to a constant @ref krylovinfo object. */
+typedef const krylovinfo *pckrylovinfo;
+
+/** @brief Convergence history and timings of an iterative solver.
+ *
+ *  Filled by @ref solve_cg, @ref solve_gmres, @ref solve_bicgstab,
+ *  @ref solve_blockcg and @ref solve_blockgmres.
+ *  For the block methods, <tt>res</tt> contains the largest residual
+ *  norm of all right-hand sides relative to its initial value.
+ *  All times are wall-clock times in seconds. */
+struct _krylovinfo {
+  /** @brief Maximal number of steps that can be recorded. */
+  uint maxsteps;
+  /** @brief Number of steps performed. */
+  uint steps;
+  /** @brief Set if the requested accuracy has been reached. */
+  bool converged;
+  /** @brief Residual norms, <tt>res[0]</tt> is the initial residual,
+   *  <tt>res[i]</tt> the residual after the <tt>i</tt>-th step. */
+  preal res;
+
+  /** @brief Time spent in matrix-vector multiplications. */
+  real t_mvm;
+  /** @brief Time spent in the preconditioner. */
+  real t_prcd;
+  /** @brief Time spent in the orthogonalization of new Krylov
+   *  vectors or, for @ref solve_blockcg, of the search directions.
+   *  Zero for @ref solve_cg and @ref solve_bicgstab, which do not
+   *  orthogonalize explicitly. */
+  real t_ortho;
+  /** @brief Time spent in all other operations, e.g., vector updates
+   *  and the solution of the small least-squares problems. */
+  real t_other;
+  /** @brief Total time. */
+  real t_total;
+};
+
 /** @brief Initialize a standard conjugate gradient method to
  *  solve @f$A x = b@f$.
  *
@@ -484,6 +543,470 @@ finish_pgmres(addeval_t addeval,
 	      pavector rhat, pavector q,
 	      uint *kk, pamatrix qr, pavector tau);
 
+/* ------------------------------------------------------------
+   CGS2 GMRES method, i.e., GMRES with classical Gram-Schmidt
+   and reorthogonalization
+   ------------------------------------------------------------ */
+
+/** @brief Initialize the CGS2 GMRES method, i.e., GMRES with classical
+ *  Gram-Schmidt orthogonalization and reorthogonalization.
+ *
+ *  In contrast to @ref init_gmres, the Arnoldi basis is stored
+ *  explicitly in <tt>qb</tt>, and every step orthogonalizes the new
+ *  vector against the entire basis in two passes of classical
+ *  Gram-Schmidt. Each pass is one product with the adjoint of
+ *  @f$Q_k@f$ and one with @f$Q_k@f$, i.e., two matrix-vector
+ *  multiplications (BLAS level 2) instead of the sequence of @f$k@f$
+ *  elementary reflections of the Householder variant.
+ *  Basis vectors are still added one at a time, there is no block
+ *  or s-step variant, and the orthogonalization does not overlap
+ *  with the next multiplication by @f$A@f$.
+ *
+ *  The restart length is determined by the number of columns of
+ *  <tt>qb</tt>: for a <tt>k</tt>-dimensional subspace,
+ *  <tt>qb->cols==k+1</tt>, <tt>hess->rows>=k+1</tt>,
+ *  <tt>hess->cols>=k</tt> and <tt>rhat->dim>=k+1</tt> are required.
+ *
+ *  @param addeval Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addeval</tt> callback.
+ *  @param b Right-hand side vector @f$b@f$.
+ *  @param x Initial guess for the solution @f$x@f$, will eventually
+ *         be replaced by an improved approximation.
+ *  @param rhat Transformed residual. The absolute value of
+ *         <tt>rhat[*kk]</tt> is the Euclidean norm of the
+ *         residual.
+ *  @param kk Pointer to current dimension of the Krylov space.
+ *  @param qb Orthonormal Arnoldi basis @f$Q_{k+1}@f$, stored
+ *         explicitly column by column.
+ *  @param hess Upper triangular factor of the Hessenberg matrix
+ *         @f$Q_{k+1}^* A Q_k@f$, with the Givens rotations stored
+ *         in the subdiagonal. */
+void
+init_cgs2gmres(addeval_t addeval,
+	       void *matrix,
+	       pcavector b, pavector x,
+	       pavector rhat, uint *kk, pamatrix qb, pamatrix hess);
+
+/** @brief One step of the CGS2 GMRES method.
+ *
+ *  If <tt>*kk+1 >= qb->cols</tt>, there is no room for the next
+ *  Arnoldi basis vector and the function returns immediately.
+ *  It can be restarted using @ref finish_cgs2gmres.
+ *
+ *  @remark This function makes no use of <tt>b</tt> and does not
+ *  update <tt>x</tt>. The current residual can be tracked via
+ *  <tt>rhat[*kk]</tt>.
+ *
+ *  @param addeval Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addeval</tt> callback.
+ *  @param b Right-hand side vector @f$b@f$.
+ *  @param x Initial guess for the solution @f$x@f$, will eventually
+ *         be replaced by an improved approximation.
+ *  @param rhat Transformed residual. The absolute value of
+ *         <tt>rhat[*kk]</tt> is the Euclidean norm of the
+ *         residual.
+ *  @param kk Pointer to current dimension of the Krylov space.
+ *  @param qb Orthonormal Arnoldi basis @f$Q_{k+1}@f$, stored
+ *         explicitly column by column.
+ *  @param hess Upper triangular factor of the Hessenberg matrix
+ *         @f$Q_{k+1}^* A Q_k@f$, with the Givens rotations stored
+ *         in the subdiagonal. */
+void
+step_cgs2gmres(addeval_t addeval,
+	       void *matrix,
+	       pcavector b, pavector x,
+	       pavector rhat, uint *kk, pamatrix qb, pamatrix hess);
+
+/** @brief Completes or restarts the CGS2 GMRES method.
+ *
+ *  Performs the update @f$x \gets x + Q_k \widehat{x}@f$ with the
+ *  solution @f$\widehat{x}@f$ of the least-squares problem and calls
+ *  @ref init_cgs2gmres to prepare for a restart.
+ *
+ *  @param addeval Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addeval</tt> callback.
+ *  @param b Right-hand side vector @f$b@f$.
+ *  @param x Initial guess for the solution @f$x@f$, will eventually
+ *         be replaced by an improved approximation.
+ *  @param rhat Transformed residual. The absolute value of
+ *         <tt>rhat[*kk]</tt> is the Euclidean norm of the
+ *         residual.
+ *  @param kk Pointer to current dimension of the Krylov space.
+ *  @param qb Orthonormal Arnoldi basis @f$Q_{k+1}@f$, stored
+ *         explicitly column by column.
+ *  @param hess Upper triangular factor of the Hessenberg matrix
+ *         @f$Q_{k+1}^* A Q_k@f$, with the Givens rotations stored
+ *         in the subdiagonal. */
+void
+finish_cgs2gmres(addeval_t addeval,
+		 void *matrix,
+		 pcavector b, pavector x,
+		 pavector rhat, uint *kk, pamatrix qb, pamatrix hess);
+
+/* ------------------------------------------------------------
+   Preconditioned CGS2 GMRES method
+   ------------------------------------------------------------ */
+
+/** @brief Initialize the preconditioned CGS2 GMRES method.
+ *
+ *  The parameters are prepared for solving @f$N A x = N b@f$,
+ *  see @ref init_cgs2gmres.
+ *
+ *  @param addeval Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addeval</tt> callback.
+ *  @param prcd Callback function representing the preconditioner @f$N@f$.
+ *  @param pdata Data for the <tt>prcd</tt> callback.
+ *  @param b Right-hand side vector @f$b@f$.
+ *  @param x Initial guess for the solution @f$x@f$, will eventually
+ *         be replaced by an improved approximation.
+ *  @param rhat Transformed residual. The absolute value of
+ *         <tt>rhat[*kk]</tt> is the Euclidean norm of the preconditioned
+ *         residual.
+ *  @param kk Pointer to current dimension of the Krylov space.
+ *  @param qb Orthonormal Arnoldi basis @f$Q_{k+1}@f$, stored
+ *         explicitly column by column.
+ *  @param hess Upper triangular factor of the Hessenberg matrix
+ *         @f$Q_{k+1}^* N A Q_k@f$, with the Givens rotations stored
+ *         in the subdiagonal. */
+void
+init_pcgs2gmres(addeval_t addeval,
+		void *matrix,
+		prcd_t prcd,
+		void *pdata,
+		pcavector b, pavector x,
+		pavector rhat, uint *kk, pamatrix qb, pamatrix hess);
+
+/** @brief One step of the preconditioned CGS2 GMRES method.
+ *
+ *  If <tt>*kk+1 >= qb->cols</tt>, the function returns immediately.
+ *  It can be restarted using @ref finish_pcgs2gmres.
+ *
+ *  @param addeval Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addeval</tt> callback.
+ *  @param prcd Callback function representing the preconditioner @f$N@f$.
+ *  @param pdata Data for the <tt>prcd</tt> callback.
+ *  @param b Right-hand side vector @f$b@f$.
+ *  @param x Initial guess for the solution @f$x@f$, will eventually
+ *         be replaced by an improved approximation.
+ *  @param rhat Transformed residual. The absolute value of
+ *         <tt>rhat[*kk]</tt> is the Euclidean norm of the preconditioned
+ *         residual.
+ *  @param kk Pointer to current dimension of the Krylov space.
+ *  @param qb Orthonormal Arnoldi basis @f$Q_{k+1}@f$, stored
+ *         explicitly column by column.
+ *  @param hess Upper triangular factor of the Hessenberg matrix
+ *         @f$Q_{k+1}^* N A Q_k@f$, with the Givens rotations stored
+ *         in the subdiagonal. */
+void
+step_pcgs2gmres(addeval_t addeval,
+		void *matrix,
+		prcd_t prcd,
+		void *pdata,
+		pcavector b, pavector x,
+		pavector rhat, uint *kk, pamatrix qb, pamatrix hess);
+
+/** @brief Completes or restarts the preconditioned CGS2 GMRES
+ *  method.
+ *
+ *  The function calls @ref init_pcgs2gmres to prepare for a restart.
+ *
+ *  @param addeval Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addeval</tt> callback.
+ *  @param prcd Callback function representing the preconditioner @f$N@f$.
+ *  @param pdata Data for the <tt>prcd</tt> callback.
+ *  @param b Right-hand side vector @f$b@f$.
+ *  @param x Initial guess for the solution @f$x@f$, will eventually
+ *         be replaced by an improved approximation.
+ *  @param rhat Transformed residual. The absolute value of
+ *         <tt>rhat[*kk]</tt> is the Euclidean norm of the preconditioned
+ *         residual.
+ *  @param kk Pointer to current dimension of the Krylov space.
+ *  @param qb Orthonormal Arnoldi basis @f$Q_{k+1}@f$, stored
+ *         explicitly column by column.
+ *  @param hess Upper triangular factor of the Hessenberg matrix
+ *         @f$Q_{k+1}^* N A Q_k@f$, with the Givens rotations stored
+ *         in the subdiagonal. */
+void
+finish_pcgs2gmres(addeval_t addeval,
+		  void *matrix,
+		  prcd_t prcd,
+		  void *pdata,
+		  pcavector b, pavector x,
+		  pavector rhat, uint *kk, pamatrix qb, pamatrix hess);
+
+/* ------------------------------------------------------------
+   Block conjugate gradient method
+   ------------------------------------------------------------ */
+
+/** @brief Initialize the block conjugate gradient method to solve
+ *  @f$A X = B@f$ for several right-hand sides at once.
+ *
+ *  The matrix @f$A@f$ has to be self-adjoint and positive definite.
+ *
+ *  @param addevalmat Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addevalmat</tt> callback.
+ *  @param b Right-hand sides @f$B@f$.
+ *  @param x Initial guesses for the solutions @f$X@f$.
+ *  @param r Residuals @f$R = B - A X@f$.
+ *  @param p Search directions.
+ *  @param a Auxiliary matrix for the products @f$A P@f$. */
+void
+init_blockcg(addevalmat_t addevalmat,
+	     void *matrix,
+	     pcamatrix b, pamatrix x,
+	     pamatrix r, pamatrix p, pamatrix a);
+
+/** @brief One step of the block conjugate gradient method.
+ *
+ *  The search directions are orthonormalized before every step,
+ *  so the method remains stable if some of the right-hand sides
+ *  converge earlier than others.
+ *  The residual of the <tt>j</tt>-th right-hand side can be tracked
+ *  via the <tt>j</tt>-th column of <tt>r</tt>.
+ *
+ *  @param addevalmat Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addevalmat</tt> callback.
+ *  @param b Right-hand sides @f$B@f$.
+ *  @param x Approximate solutions @f$X@f$, will be updated.
+ *  @param r Residuals @f$R = B - A X@f$.
+ *  @param p Search directions.
+ *  @param a Auxiliary matrix for the products @f$A P@f$. */
+void
+step_blockcg(addevalmat_t addevalmat,
+	     void *matrix,
+	     pcamatrix b, pamatrix x,
+	     pamatrix r, pamatrix p, pamatrix a);
+
+/* ------------------------------------------------------------
+   Block generalized minimal residual method (GMRES)
+   ------------------------------------------------------------ */
+
+/** @brief Initialize the block GMRES method to solve @f$A X = B@f$
+ *  for @f$s@f$ right-hand sides at once.
+ *
+ *  All right-hand sides share one block Krylov space, its basis is
+ *  stored in <tt>qb</tt>. For a space of <tt>m</tt> blocks,
+ *  <tt>qb->cols==(m+1)*s</tt>, <tt>hess->rows>=(m+1)*s</tt>,
+ *  <tt>hess->cols>=m*s</tt>, <tt>rhat->rows>=(m+1)*s</tt>,
+ *  <tt>rhat->cols>=s</tt> and <tt>tau->dim>=m*s</tt> are required.
+ *
+ *  @param addevalmat Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addevalmat</tt> callback.
+ *  @param b Right-hand sides @f$B@f$.
+ *  @param x Initial guesses for the solutions @f$X@f$.
+ *  @param rhat Transformed residuals, see
+ *         @ref residualnorms_blockgmres.
+ *  @param kk Pointer to current number of blocks of the Krylov space.
+ *  @param qb Orthonormal block Arnoldi basis.
+ *  @param hess Triangular factor of the block Hessenberg matrix,
+ *         with the Householder vectors of the block reflections
+ *         stored below the diagonal.
+ *  @param tau Scaling factors of the block reflections. */
+void
+init_blockgmres(addevalmat_t addevalmat,
+		void *matrix,
+		pcamatrix b, pamatrix x,
+		pamatrix rhat, uint *kk,
+		pamatrix qb, pamatrix hess, pavector tau);
+
+/** @brief One step of the block GMRES method.
+ *
+ *  If there is no room for the next block of the Arnoldi basis,
+ *  the function returns immediately. It can be restarted using
+ *  @ref finish_blockgmres.
+ *
+ *  The new block is orthogonalized against the entire basis by
+ *  block classical Gram-Schmidt with reorthogonalization, using
+ *  only matrix-matrix products.
+ *
+ *  @param addevalmat Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addevalmat</tt> callback.
+ *  @param b Right-hand sides @f$B@f$.
+ *  @param x Approximate solutions @f$X@f$, not updated.
+ *  @param rhat Transformed residuals.
+ *  @param kk Pointer to current number of blocks of the Krylov space.
+ *  @param qb Orthonormal block Arnoldi basis.
+ *  @param hess Triangular factor of the block Hessenberg matrix.
+ *  @param tau Scaling factors of the block reflections. */
+void
+step_blockgmres(addevalmat_t addevalmat,
+		void *matrix,
+		pcamatrix b, pamatrix x,
+		pamatrix rhat, uint *kk,
+		pamatrix qb, pamatrix hess, pavector tau);
+
+/** @brief Completes or restarts the block GMRES method.
+ *
+ *  Solves the least-squares problems, updates the solutions
+ *  @f$X@f$ and calls @ref init_blockgmres to prepare for a restart.
+ *
+ *  @param addevalmat Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addevalmat</tt> callback.
+ *  @param b Right-hand sides @f$B@f$.
+ *  @param x Approximate solutions @f$X@f$, will be updated.
+ *  @param rhat Transformed residuals.
+ *  @param kk Pointer to current number of blocks of the Krylov space.
+ *  @param qb Orthonormal block Arnoldi basis.
+ *  @param hess Triangular factor of the block Hessenberg matrix.
+ *  @param tau Scaling factors of the block reflections. */
+void
+finish_blockgmres(addevalmat_t addevalmat,
+		  void *matrix,
+		  pcamatrix b, pamatrix x,
+		  pamatrix rhat, uint *kk,
+		  pamatrix qb, pamatrix hess, pavector tau);
+
+/** @brief Compute the residual norms of all right-hand sides in the
+ *  block GMRES method.
+ *
+ *  @param rhat Transformed residuals.
+ *  @param kk Current number of blocks of the Krylov space.
+ *  @param norms Array of length <tt>rhat->cols</tt>, receives the
+ *         Euclidean norms of the residuals. */
+void
+residualnorms_blockgmres(pcamatrix rhat, uint kk, preal norms);
+
+/* ------------------------------------------------------------
+   Solver drivers
+   ------------------------------------------------------------ */
+
+/** @brief Create a @ref krylovinfo object.
+ *
+ *  @remark Should always be matched by a call to @ref del_krylovinfo.
+ *
+ *  @param maxsteps Maximal number of steps that can be recorded.
+ *  @returns New @ref krylovinfo object. */
+pkrylovinfo
+new_krylovinfo(uint maxsteps);
+
+/** @brief Delete a @ref krylovinfo object.
+ *
+ *  @param info Object to be deleted. */
+void
+del_krylovinfo(pkrylovinfo info);
+
+/** @brief Solve @f$A x = b@f$ with the (preconditioned) conjugate
+ *  gradient method.
+ *
+ *  The iteration stops once the Euclidean norm of the residual
+ *  @f$b - A x@f$ has been reduced by the factor <tt>eps</tt> or
+ *  <tt>maxsteps</tt> steps have been performed.
+ *
+ *  @param addeval Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addeval</tt> callback.
+ *  @param prcd Callback function representing the preconditioner,
+ *         may be <tt>NULL</tt>.
+ *  @param pdata Data for the <tt>prcd</tt> callback.
+ *  @param b Right-hand side vector @f$b@f$.
+ *  @param x Initial guess for the solution @f$x@f$, will be replaced
+ *         by the final approximation.
+ *  @param eps Relative accuracy.
+ *  @param maxsteps Maximal number of steps.
+ *  @param info If not <tt>NULL</tt>, receives the residual norms and
+ *         timings. <tt>info->maxsteps>=maxsteps</tt> is required.
+ *  @returns Number of steps performed. */
+uint
+solve_cg(addeval_t addeval, void *matrix,
+	 prcd_t prcd, void *pdata,
+	 pcavector b, pavector x,
+	 real eps, uint maxsteps, pkrylovinfo info);
+
+/** @brief Solve @f$A x = b@f$ with the restarted (preconditioned)
+ *  CGS2 GMRES method, see @ref init_cgs2gmres.
+ *
+ *  The iteration stops once the Euclidean norm of the
+ *  (preconditioned) residual has been reduced by the factor
+ *  <tt>eps</tt> or <tt>maxsteps</tt> steps have been performed.
+ *  The Krylov space is restarted every <tt>restart</tt> steps,
+ *  see @ref init_cgs2gmres.
+ *
+ *  @param addeval Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addeval</tt> callback.
+ *  @param prcd Callback function representing the preconditioner,
+ *         may be <tt>NULL</tt>.
+ *  @param pdata Data for the <tt>prcd</tt> callback.
+ *  @param b Right-hand side vector @f$b@f$.
+ *  @param x Initial guess for the solution @f$x@f$, will be replaced
+ *         by the final approximation.
+ *  @param eps Relative accuracy.
+ *  @param maxsteps Maximal number of steps.
+ *  @param restart Maximal dimension of the Krylov space.
+ *  @param info If not <tt>NULL</tt>, receives the residual norms and
+ *         timings. <tt>info->maxsteps>=maxsteps</tt> is required.
+ *  @returns Number of steps performed. */
+uint
+solve_gmres(addeval_t addeval, void *matrix,
+	    prcd_t prcd, void *pdata,
+	    pcavector b, pavector x,
+	    real eps, uint maxsteps, uint restart, pkrylovinfo info);
+
+/** @brief Solve @f$A x = b@f$ with the stabilized biconjugate
+ *  gradient method.
+ *
+ *  The iteration stops once the Euclidean norm of the residual
+ *  @f$b - A x@f$ has been reduced by the factor <tt>eps</tt> or
+ *  <tt>maxsteps</tt> steps have been performed.
+ *
+ *  @param addeval Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addeval</tt> callback.
+ *  @param b Right-hand side vector @f$b@f$.
+ *  @param x Initial guess for the solution @f$x@f$, will be replaced
+ *         by the final approximation.
+ *  @param eps Relative accuracy.
+ *  @param maxsteps Maximal number of steps.
+ *  @param info If not <tt>NULL</tt>, receives the residual norms and
+ *         timings. <tt>info->maxsteps>=maxsteps</tt> is required.
+ *  @returns Number of steps performed. */
+uint
+solve_bicgstab(addeval_t addeval, void *matrix,
+	       pcavector b, pavector x,
+	       real eps, uint maxsteps, pkrylovinfo info);
+
+/** @brief Solve @f$A X = B@f$ for several right-hand sides with the
+ *  block conjugate gradient method.
+ *
+ *  The iteration stops once the residual norms of all right-hand
+ *  sides have been reduced by the factor <tt>eps</tt> or
+ *  <tt>maxsteps</tt> steps have been performed.
+ *
+ *  @param addevalmat Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addevalmat</tt> callback.
+ *  @param b Right-hand sides @f$B@f$.
+ *  @param x Initial guesses for the solutions @f$X@f$, will be
+ *         replaced by the final approximations.
+ *  @param eps Relative accuracy.
+ *  @param maxsteps Maximal number of steps.
+ *  @param info If not <tt>NULL</tt>, receives the residual norms and
+ *         timings. <tt>info->maxsteps>=maxsteps</tt> is required.
+ *  @returns Number of steps performed. */
+uint
+solve_blockcg(addevalmat_t addevalmat, void *matrix,
+	      pcamatrix b, pamatrix x,
+	      real eps, uint maxsteps, pkrylovinfo info);
+
+/** @brief Solve @f$A X = B@f$ for several right-hand sides with the
+ *  restarted block GMRES method.
+ *
+ *  The iteration stops once the residual norms of all right-hand
+ *  sides have been reduced by the factor <tt>eps</tt> or
+ *  <tt>maxsteps</tt> steps have been performed.
+ *
+ *  @param addevalmat Callback function representing the matrix @f$A@f$.
+ *  @param matrix Data for the <tt>addevalmat</tt> callback.
+ *  @param b Right-hand sides @f$B@f$.
+ *  @param x Initial guesses for the solutions @f$X@f$, will be
+ *         replaced by the final approximations.
+ *  @param eps Relative accuracy.
+ *  @param maxsteps Maximal number of steps.
+ *  @param restart Maximal number of blocks of the Krylov space.
+ *  @param info If not <tt>NULL</tt>, receives the residual norms and
+ *         timings. <tt>info->maxsteps>=maxsteps</tt> is required.
+ *  @returns Number of steps performed. */
+uint
+solve_blockgmres(addevalmat_t addevalmat, void *matrix,
+		 pcamatrix b, pamatrix x,
+		 real eps, uint maxsteps, uint restart, pkrylovinfo info);
+
 /** @} */
 
 #endif
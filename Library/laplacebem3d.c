@@ -27,6 +27,343 @@
  * */
 #define KERNEL_CONST_BEM3D 0.0795774715459476679
 
+/* The vectorized kernels use AVX2 or AVX-512 intrinsics, the processor
+ * is checked at runtime. */
+#if defined(USE_SIMD) && defined(__GNUC__) && defined(__x86_64__)
+#define USE_SIMD_LAPLACEBEM3D
+#include <immintrin.h>
+#endif
+
+/* ------------------------------------------------------------
+ Kernel values at quadrature points
+ ------------------------------------------------------------ */
+
+/* The singular quadrature rules map each quadrature point to a pair of
+ * points in the triangles A_t B_t C_t and A_s B_s C_s with barycentric
+ * coordinates (1-tx, tx-sx, sx) and (1-ty, ty-sy, sy). These functions
+ * evaluate the single and double layer kernels in all quadrature points
+ * of a rule at once, the AVX2 and AVX-512 versions handle four or eight
+ * quadrature points per step. */
+
+typedef void (*slpquad_laplacebem3d) (uint n, const real * tx,
+				      const real * sx, const real * ty,
+				      const real * sy, const real * A_t,
+				      const real * B_t, const real * C_t,
+				      const real * A_s, const real * B_s,
+				      const real * C_s, field * quad);
+
+typedef void (*dlpquad_laplacebem3d) (uint n, const real * tx,
+				      const real * sx, const real * ty,
+				      const real * sy, const real * A_t,
+				      const real * B_t, const real * C_t,
+				      const real * A_s, const real * B_s,
+				      const real * C_s, const real * ns,
+				      field * quad);
+
+static void
+slp_quadrature_laplacebem3d(uint n, const real * tx, const real * sx,
+			    const real * ty, const real * sy,
+			    const real * A_t, const real * B_t,
+			    const real * C_t, const real * A_s,
+			    const real * B_s, const real * C_s, field * quad)
+{
+  real      Ax, Bx, Cx, Ay, By, Cy, dx, dy, dz;
+  uint      q;
+
+  for (q = 0; q < n; ++q) {
+    Ax = 1.0 - tx[q];
+    Bx = tx[q] - sx[q];
+    Cx = sx[q];
+    Ay = 1.0 - ty[q];
+    By = ty[q] - sy[q];
+    Cy = sy[q];
+
+    dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
+      - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
+    dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
+      - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
+    dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
+      - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
+
+    quad[q] = 1.0 / REAL_SQRT(dx * dx + dy * dy + dz * dz);
+  }
+}
+
+static void
+dlp_quadrature_laplacebem3d(uint n, const real * tx, const real * sx,
+			    const real * ty, const real * sy,
+			    const real * A_t, const real * B_t,
+			    const real * C_t, const real * A_s,
+			    const real * B_s, const real * C_s,
+			    const real * ns, field * quad)
+{
+  real      Ax, Bx, Cx, Ay, By, Cy, dx, dy, dz, norm;
+  uint      q;
+
+  for (q = 0; q < n; ++q) {
+    Ax = 1.0 - tx[q];
+    Bx = tx[q] - sx[q];
+    Cx = sx[q];
+    Ay = 1.0 - ty[q];
+    By = ty[q] - sy[q];
+    Cy = sy[q];
+
+    dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
+      - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
+    dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
+      - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
+    dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
+      - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
+
+    norm = dx * dx + dy * dy + dz * dz;
+
+    quad[q] = (dx * ns[0] + dy * ns[1] + dz * ns[2])
+      / (norm * REAL_SQRT(norm));
+  }
+}
+
+#ifdef USE_SIMD_LAPLACEBEM3D
+__attribute__ ((target("avx2")))
+static void
+slp_quadrature_avx2_laplacebem3d(uint n, const real * tx, const real * sx,
+				 const real * ty, const real * sy,
+				 const real * A_t, const real * B_t,
+				 const real * C_t, const real * A_s,
+				 const real * B_s, const real * C_s,
+				 field * quad)
+{
+  __m256d   at[3], bt[3], ct[3], as[3], bs[3], cs[3], d[3];
+  __m256d   one, Ax, Bx, Cx, Ay, By, Cy, x, y, norm;
+  uint      q, k;
+
+  for (k = 0; k < 3; k++) {
+    at[k] = _mm256_set1_pd(A_t[k]);
+    bt[k] = _mm256_set1_pd(B_t[k]);
+    ct[k] = _mm256_set1_pd(C_t[k]);
+    as[k] = _mm256_set1_pd(A_s[k]);
+    bs[k] = _mm256_set1_pd(B_s[k]);
+    cs[k] = _mm256_set1_pd(C_s[k]);
+  }
+  one = _mm256_set1_pd(1.0);
+
+  for (q = 0; q + 4 <= n; q += 4) {
+    Cx = _mm256_loadu_pd(sx + q);
+    Bx = _mm256_sub_pd(_mm256_loadu_pd(tx + q), Cx);
+    Ax = _mm256_sub_pd(one, _mm256_loadu_pd(tx + q));
+    Cy = _mm256_loadu_pd(sy + q);
+    By = _mm256_sub_pd(_mm256_loadu_pd(ty + q), Cy);
+    Ay = _mm256_sub_pd(one, _mm256_loadu_pd(ty + q));
+
+    /* Difference of the points in both triangles */
+    for (k = 0; k < 3; k++) {
+      x = _mm256_add_pd(_mm256_mul_pd(at[k], Ax), _mm256_mul_pd(bt[k], Bx));
+      x = _mm256_add_pd(x, _mm256_mul_pd(ct[k], Cx));
+      y = _mm256_add_pd(_mm256_mul_pd(as[k], Ay), _mm256_mul_pd(bs[k], By));
+      y = _mm256_add_pd(y, _mm256_mul_pd(cs[k], Cy));
+      d[k] = _mm256_sub_pd(x, y);
+    }
+
+    norm = _mm256_mul_pd(d[0], d[0]);
+    norm = _mm256_add_pd(norm, _mm256_mul_pd(d[1], d[1]));
+    norm = _mm256_add_pd(norm, _mm256_mul_pd(d[2], d[2]));
+
+    _mm256_storeu_pd(quad + q, _mm256_div_pd(one, _mm256_sqrt_pd(norm)));
+  }
+
+  slp_quadrature_laplacebem3d(n - q, tx + q, sx + q, ty + q, sy + q, A_t,
+			      B_t, C_t, A_s, B_s, C_s, quad + q);
+}
+
+__attribute__ ((target("avx2")))
+static void
+dlp_quadrature_avx2_laplacebem3d(uint n, const real * tx, const real * sx,
+				 const real * ty, const real * sy,
+				 const real * A_t, const real * B_t,
+				 const real * C_t, const real * A_s,
+				 const real * B_s, const real * C_s,
+				 const real * ns, field * quad)
+{
+  __m256d   at[3], bt[3], ct[3], as[3], bs[3], cs[3], n_s[3], d[3];
+  __m256d   one, Ax, Bx, Cx, Ay, By, Cy, x, y, norm, nd;
+  uint      q, k;
+
+  for (k = 0; k < 3; k++) {
+    at[k] = _mm256_set1_pd(A_t[k]);
+    bt[k] = _mm256_set1_pd(B_t[k]);
+    ct[k] = _mm256_set1_pd(C_t[k]);
+    as[k] = _mm256_set1_pd(A_s[k]);
+    bs[k] = _mm256_set1_pd(B_s[k]);
+    cs[k] = _mm256_set1_pd(C_s[k]);
+    n_s[k] = _mm256_set1_pd(ns[k]);
+  }
+  one = _mm256_set1_pd(1.0);
+
+  for (q = 0; q + 4 <= n; q += 4) {
+    Cx = _mm256_loadu_pd(sx + q);
+    Bx = _mm256_sub_pd(_mm256_loadu_pd(tx + q), Cx);
+    Ax = _mm256_sub_pd(one, _mm256_loadu_pd(tx + q));
+    Cy = _mm256_loadu_pd(sy + q);
+    By = _mm256_sub_pd(_mm256_loadu_pd(ty + q), Cy);
+    Ay = _mm256_sub_pd(one, _mm256_loadu_pd(ty + q));
+
+    /* Difference of the points in both triangles */
+    for (k = 0; k < 3; k++) {
+      x = _mm256_add_pd(_mm256_mul_pd(at[k], Ax), _mm256_mul_pd(bt[k], Bx));
+      x = _mm256_add_pd(x, _mm256_mul_pd(ct[k], Cx));
+      y = _mm256_add_pd(_mm256_mul_pd(as[k], Ay), _mm256_mul_pd(bs[k], By));
+      y = _mm256_add_pd(y, _mm256_mul_pd(cs[k], Cy));
+      d[k] = _mm256_sub_pd(x, y);
+    }
+
+    norm = _mm256_mul_pd(d[0], d[0]);
+    norm = _mm256_add_pd(norm, _mm256_mul_pd(d[1], d[1]));
+    norm = _mm256_add_pd(norm, _mm256_mul_pd(d[2], d[2]));
+
+    nd = _mm256_mul_pd(d[0], n_s[0]);
+    nd = _mm256_add_pd(nd, _mm256_mul_pd(d[1], n_s[1]));
+    nd = _mm256_add_pd(nd, _mm256_mul_pd(d[2], n_s[2]));
+    norm = _mm256_mul_pd(norm, _mm256_sqrt_pd(norm));
+
+    _mm256_storeu_pd(quad + q, _mm256_div_pd(nd, norm));
+  }
+
+  dlp_quadrature_laplacebem3d(n - q, tx + q, sx + q, ty + q, sy + q, A_t,
+			      B_t, C_t, A_s, B_s, C_s, ns, quad + q);
+}
+
+__attribute__ ((target("avx512f")))
+static void
+slp_quadrature_avx512_laplacebem3d(uint n, const real * tx, const real * sx,
+				   const real * ty, const real * sy,
+				   const real * A_t, const real * B_t,
+				   const real * C_t, const real * A_s,
+				   const real * B_s, const real * C_s,
+				   field * quad)
+{
+  __m512d   at[3], bt[3], ct[3], as[3], bs[3], cs[3], d[3];
+  __m512d   one, Ax, Bx, Cx, Ay, By, Cy, x, y, norm;
+  uint      q, k;
+
+  for (k = 0; k < 3; k++) {
+    at[k] = _mm512_set1_pd(A_t[k]);
+    bt[k] = _mm512_set1_pd(B_t[k]);
+    ct[k] = _mm512_set1_pd(C_t[k]);
+    as[k] = _mm512_set1_pd(A_s[k]);
+    bs[k] = _mm512_set1_pd(B_s[k]);
+    cs[k] = _mm512_set1_pd(C_s[k]);
+  }
+  one = _mm512_set1_pd(1.0);
+
+  for (q = 0; q + 8 <= n; q += 8) {
+    Cx = _mm512_loadu_pd(sx + q);
+    Bx = _mm512_sub_pd(_mm512_loadu_pd(tx + q), Cx);
+    Ax = _mm512_sub_pd(one, _mm512_loadu_pd(tx + q));
+    Cy = _mm512_loadu_pd(sy + q);
+    By = _mm512_sub_pd(_mm512_loadu_pd(ty + q), Cy);
+    Ay = _mm512_sub_pd(one, _mm512_loadu_pd(ty + q));
+
+    /* Difference of the points in both triangles */
+    for (k = 0; k < 3; k++) {
+      x = _mm512_add_pd(_mm512_mul_pd(at[k], Ax), _mm512_mul_pd(bt[k], Bx));
+      x = _mm512_add_pd(x, _mm512_mul_pd(ct[k], Cx));
+      y = _mm512_add_pd(_mm512_mul_pd(as[k], Ay), _mm512_mul_pd(bs[k], By));
+      y = _mm512_add_pd(y, _mm512_mul_pd(cs[k], Cy));
+      d[k] = _mm512_sub_pd(x, y);
+    }
+
+    norm = _mm512_mul_pd(d[0], d[0]);
+    norm = _mm512_add_pd(norm, _mm512_mul_pd(d[1], d[1]));
+    norm = _mm512_add_pd(norm, _mm512_mul_pd(d[2], d[2]));
+
+    _mm512_storeu_pd(quad + q, _mm512_div_pd(one, _mm512_sqrt_pd(norm)));
+  }
+
+  slp_quadrature_laplacebem3d(n - q, tx + q, sx + q, ty + q, sy + q, A_t,
+			      B_t, C_t, A_s, B_s, C_s, quad + q);
+}
+
+__attribute__ ((target("avx512f")))
+static void
+dlp_quadrature_avx512_laplacebem3d(uint n, const real * tx, const real * sx,
+				   const real * ty, const real * sy,
+				   const real * A_t, const real * B_t,
+				   const real * C_t, const real * A_s,
+				   const real * B_s, const real * C_s,
+				   const real * ns, field * quad)
+{
+  __m512d   at[3], bt[3], ct[3], as[3], bs[3], cs[3], n_s[3], d[3];
+  __m512d   one, Ax, Bx, Cx, Ay, By, Cy, x, y, norm, nd;
+  uint      q, k;
+
+  for (k = 0; k < 3; k++) {
+    at[k] = _mm512_set1_pd(A_t[k]);
+    bt[k] = _mm512_set1_pd(B_t[k]);
+    ct[k] = _mm512_set1_pd(C_t[k]);
+    as[k] = _mm512_set1_pd(A_s[k]);
+    bs[k] = _mm512_set1_pd(B_s[k]);
+    cs[k] = _mm512_set1_pd(C_s[k]);
+    n_s[k] = _mm512_set1_pd(ns[k]);
+  }
+  one = _mm512_set1_pd(1.0);
+
+  for (q = 0; q + 8 <= n; q += 8) {
+    Cx = _mm512_loadu_pd(sx + q);
+    Bx = _mm512_sub_pd(_mm512_loadu_pd(tx + q), Cx);
+    Ax = _mm512_sub_pd(one, _mm512_loadu_pd(tx + q));
+    Cy = _mm512_loadu_pd(sy + q);
+    By = _mm512_sub_pd(_mm512_loadu_pd(ty + q), Cy);
+    Ay = _mm512_sub_pd(one, _mm512_loadu_pd(ty + q));
+
+    /* Difference of the points in both triangles */
+    for (k = 0; k < 3; k++) {
+      x = _mm512_add_pd(_mm512_mul_pd(at[k], Ax), _mm512_mul_pd(bt[k], Bx));
+      x = _mm512_add_pd(x, _mm512_mul_pd(ct[k], Cx));
+      y = _mm512_add_pd(_mm512_mul_pd(as[k], Ay), _mm512_mul_pd(bs[k], By));
+      y = _mm512_add_pd(y, _mm512_mul_pd(cs[k], Cy));
+      d[k] = _mm512_sub_pd(x, y);
+    }
+
+    norm = _mm512_mul_pd(d[0], d[0]);
+    norm = _mm512_add_pd(norm, _mm512_mul_pd(d[1], d[1]));
+    norm = _mm512_add_pd(norm, _mm512_mul_pd(d[2], d[2]));
+
+    nd = _mm512_mul_pd(d[0], n_s[0]);
+    nd = _mm512_add_pd(nd, _mm512_mul_pd(d[1], n_s[1]));
+    nd = _mm512_add_pd(nd, _mm512_mul_pd(d[2], n_s[2]));
+    norm = _mm512_mul_pd(norm, _mm512_sqrt_pd(norm));
+
+    _mm512_storeu_pd(quad + q, _mm512_div_pd(nd, norm));
+  }
+
+  dlp_quadrature_laplacebem3d(n - q, tx + q, sx + q, ty + q, sy + q, A_t,
+			      B_t, C_t, A_s, B_s, C_s, ns, quad + q);
+}
+#endif
+
+static    slpquad_laplacebem3d
+select_slp_quadrature_laplacebem3d()
+{
+#ifdef USE_SIMD_LAPLACEBEM3D
+  if (__builtin_cpu_supports("avx512f"))
+    return slp_quadrature_avx512_laplacebem3d;
+  if (__builtin_cpu_supports("avx2"))
+    return slp_quadrature_avx2_laplacebem3d;
+#endif
+  return slp_quadrature_laplacebem3d;
+}
+
+static    dlpquad_laplacebem3d
+select_dlp_quadrature_laplacebem3d()
+{
+#ifdef USE_SIMD_LAPLACEBEM3D
+  if (__builtin_cpu_supports("avx512f"))
+    return dlp_quadrature_avx512_laplacebem3d;
+  if (__builtin_cpu_supports("avx2"))
+    return dlp_quadrature_avx2_laplacebem3d;
+#endif
+  return dlp_quadrature_laplacebem3d;
+}
+
 static void
 fill_slp_cc_laplacebem3d(const uint * ridx, const uint * cidx,
 			 pcbem3d bem, bool ntrans, pamatrix N)
@@ -35,6 +372,8 @@ fill_slp_cc_laplacebem3d(const uint * ridx, const uint * cidx,
   const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const real *gr_g = (const real *) gr->g;
+  slpquad_laplacebem3d slpquad;
+  field    *quad;
   field    *aa = N->a;
   uint      rows = N->rows;
   uint      cols = N->cols;
@@ -44,11 +383,13 @@ fill_slp_cc_laplacebem3d(const uint * ridx, const uint * cidx,
   const uint *tri_t, *tri_s;
   real     *xq, *yq, *wq;
   uint      tp[3], sp[3];
-  real      Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, dx, dy, dz, factor,
-    factor2;
+  real      factor, factor2;
   field     sum;
   uint      q, nq, ss, tt, s, t;
 
+  slpquad = select_slp_quadrature_laplacebem3d();
+  quad = allocfield(bem->sq->nmax);
+
   if (ntrans == true) {
     for (t = 0; t < cols; ++t) {
       tt = (ridx == NULL ? t : ridx[t]);
@@ -70,26 +411,11 @@ fill_slp_cc_laplacebem3d(const uint * ridx, const uint * cidx,
 	B_s = gr_x[tri_s[sp[1]]];
 	C_s = gr_x[tri_s[sp[2]]];
 
+	slpquad(nq, xq, xq + nq, yq, yq + nq, A_t, B_t, C_t,
+		A_s, B_s, C_s, quad);
+
 	for (q = 0; q < nq; ++q) {
-	  tx = xq[q];
-	  sx = xq[q + nq];
-	  ty = yq[q];
-	  sy = yq[q + nq];
-	  Ax = 1.0 - tx;
-	  Bx = tx - sx;
-	  Cx = sx;
-	  Ay = 1.0 - ty;
-	  By = ty - sy;
-	  Cy = sy;
-
-	  dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
-	    - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
-	  dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
-	    - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
-	  dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
-	    - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
-
-	  sum += wq[q] / REAL_SQRT(dx * dx + dy * dy + dz * dz);
+	  sum += wq[q] * quad[q];
 	}
 
 	aa[s + t * ld] = sum * factor2;
@@ -118,32 +444,19 @@ fill_slp_cc_laplacebem3d(const uint * ridx, const uint * cidx,
 	B_s = gr_x[tri_s[sp[1]]];
 	C_s = gr_x[tri_s[sp[2]]];
 
+	slpquad(nq, xq, xq + nq, yq, yq + nq, A_t, B_t, C_t,
+		A_s, B_s, C_s, quad);
+
 	for (q = 0; q < nq; ++q) {
-	  tx = xq[q];
-	  sx = xq[q + nq];
-	  ty = yq[q];
-	  sy = yq[q + nq];
-	  Ax = 1.0 - tx;
-	  Bx = tx - sx;
-	  Cx = sx;
-	  Ay = 1.0 - ty;
-	  By = ty - sy;
-	  Cy = sy;
-
-	  dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
-	    - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
-	  dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
-	    - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
-	  dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
-	    - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
-
-	  sum += wq[q] / REAL_SQRT(dx * dx + dy * dy + dz * dz);
+	  sum += wq[q] * quad[q];
 	}
 
 	aa[t + s * ld] = sum * factor2;
       }
     }
   }
+
+  freemem(quad);
 }
 
 static void
@@ -155,6 +468,8 @@ fill_dlp_cc_laplacebem3d(const uint * ridx, const uint * cidx,
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const real *gr_g = (const real *) gr->g;
+  dlpquad_laplacebem3d dlpquad;
+  field    *quad;
   field    *aa = N->a;
   uint      rows = N->rows;
   uint      cols = N->cols;
@@ -164,11 +479,13 @@ fill_dlp_cc_laplacebem3d(const uint * ridx, const uint * cidx,
   const uint *tri_t, *tri_s;
   real     *xq, *yq, *wq;
   uint      tp[3], sp[3];
-  real      norm, dx, dy, dz, Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, factor,
-    factor2;
+  real      factor, factor2;
   field     res;
   uint      q, tt, ss, nq, t, s;
 
+  dlpquad = select_dlp_quadrature_laplacebem3d();
+  quad = allocfield(bem->sq->nmax);
+
   if (ntrans == true) {
     for (t = 0; t < cols; ++t) {
       tt = (ridx == NULL ? t : ridx[t]);
@@ -199,29 +516,11 @@ fill_dlp_cc_laplacebem3d(const uint * ridx, const uint * cidx,
 	  B_s = gr_x[tri_s[sp[1]]];
 	  C_s = gr_x[tri_s[sp[2]]];
 
+	  dlpquad(nq, xq, xq + nq, yq, yq + nq, A_t, B_t, C_t,
+		  A_s, B_s, C_s, ns, quad);
+
 	  for (q = 0; q < nq; ++q) {
-	    tx = xq[q];
-	    sx = xq[q + nq];
-	    ty = yq[q];
-	    sy = yq[q + nq];
-	    Ax = 1.0 - tx;
-	    Bx = tx - sx;
-	    Cx = sx;
-	    Ay = 1.0 - ty;
-	    By = ty - sy;
-	    Cy = sy;
-
-	    dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
-	      - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
-	    dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
-	      - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
-	    dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
-	      - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
-
-	    norm = dx * dx + dy * dy + dz * dz;
-
-	    res += wq[q] * (dx * ns[0] + dy * ns[1] + dz * ns[2])
-	      / (norm * REAL_SQRT(norm));
+	    res += wq[q] * quad[q];
 	  }
 
 	  aa[s + t * ld] = res * factor2;
@@ -259,29 +558,11 @@ fill_dlp_cc_laplacebem3d(const uint * ridx, const uint * cidx,
 	  B_s = gr_x[tri_s[sp[1]]];
 	  C_s = gr_x[tri_s[sp[2]]];
 
+	  dlpquad(nq, xq, xq + nq, yq, yq + nq, A_t, B_t, C_t,
+		  A_s, B_s, C_s, ns, quad);
+
 	  for (q = 0; q < nq; ++q) {
-	    tx = xq[q];
-	    sx = xq[q + nq];
-	    ty = yq[q];
-	    sy = yq[q + nq];
-	    Ax = 1.0 - tx;
-	    Bx = tx - sx;
-	    Cx = sx;
-	    Ay = 1.0 - ty;
-	    By = ty - sy;
-	    Cy = sy;
-
-	    dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
-	      - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
-	    dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
-	      - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
-	    dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
-	      - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
-
-	    norm = dx * dx + dy * dy + dz * dz;
-
-	    res += wq[q] * (dx * ns[0] + dy * ns[1] + dz * ns[2])
-	      / (norm * REAL_SQRT(norm));
+	    res += wq[q] * quad[q];
 	  }
 
 	  aa[t + s * ld] = res * factor2;
@@ -289,6 +570,8 @@ fill_dlp_cc_laplacebem3d(const uint * ridx, const uint * cidx,
       }
     }
   }
+
+  freemem(quad);
 }
 
 static void
@@ -302,6 +585,7 @@ fill_dlp_cl_laplacebem3d(const uint * ridx, const uint * cidx,
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const uint triangles = gr->triangles;
   plistnode *v2t = bem->v2t;
+  dlpquad_laplacebem3d dlpquad;
   field    *quad;
   field    *aa = N->a;
   uint      rows = N->rows;
@@ -315,14 +599,14 @@ fill_dlp_cl_laplacebem3d(const uint * ridx, const uint * cidx,
   plistnode v;
   real     *xq, *xq2, *yq, *yq2, *wq, *mass;
   uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
-  real      norm, Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, dx, dy, dz, factor,
-    factor2;
+  real      factor, factor2;
   field     res, base;
   uint      i, j, t, s, q, nq, cj;
   uint      ii, jj, tt, ss, vv;
 
   clear_amatrix(N);
 
+  dlpquad = select_dlp_quadrature_laplacebem3d();
   quad = allocfield(bem->sq->nmax);
 
   if (ntrans == true) {
@@ -382,30 +666,8 @@ fill_dlp_cl_laplacebem3d(const uint * ridx, const uint * cidx,
 	  B_s = gr_x[tri_sp[1]];
 	  C_s = gr_x[tri_sp[2]];
 
-	  for (q = 0; q < nq; ++q) {
-	    tx = xq[q];
-	    sx = xq2[q];
-	    ty = yq[q];
-	    sy = yq2[q];
-	    Ax = 1.0 - tx;
-	    Bx = tx - sx;
-	    Cx = sx;
-	    Ay = 1.0 - ty;
-	    By = ty - sy;
-	    Cy = sy;
-
-	    dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
-	      - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
-	    dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
-	      - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
-	    dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
-	      - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
-
-	    norm = dx * dx + dy * dy + dz * dz;
-
-	    quad[q] = (dx * ns[0] + dy * ns[1] + dz * ns[2])
-	      / (norm * REAL_SQRT(norm));
-	  }
+	  dlpquad(nq, xq, xq2, yq, yq2, A_t, B_t, C_t,
+		  A_s, B_s, C_s, ns, quad);
 
 	  vl = tl1->vl;
 	  while (vl) {
@@ -516,30 +778,8 @@ fill_dlp_cl_laplacebem3d(const uint * ridx, const uint * cidx,
 	  B_s = gr_x[tri_sp[1]];
 	  C_s = gr_x[tri_sp[2]];
 
-	  for (q = 0; q < nq; ++q) {
-	    tx = xq[q];
-	    sx = xq[q + nq];
-	    ty = yq[q];
-	    sy = yq[q + nq];
-	    Ax = 1.0 - tx;
-	    Bx = tx - sx;
-	    Cx = sx;
-	    Ay = 1.0 - ty;
-	    By = ty - sy;
-	    Cy = sy;
-
-	    dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
-	      - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
-	    dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
-	      - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
-	    dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
-	      - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
-
-	    norm = dx * dx + dy * dy + dz * dz;
-
-	    quad[q] = (dx * ns[0] + dy * ns[1] + dz * ns[2])
-	      / (norm * REAL_SQRT(norm));
-	  }
+	  dlpquad(nq, xq, xq + nq, yq, yq + nq, A_t, B_t, C_t,
+		  A_s, B_s, C_s, ns, quad);
 
 	  vl = tl1->vl;
 	  while (vl) {
@@ -607,6 +847,7 @@ fill_slp_ll_laplacebem3d(const uint * ridx, const uint * cidx,
   const preal gr_g = (const preal) gr->g;
   const uint triangles = gr->triangles;
   plistnode *v2t = bem->v2t;
+  slpquad_laplacebem3d slpquad;
   field    *quad;
   field    *aa = N->a;
   uint      rows = N->rows;
@@ -620,10 +861,10 @@ fill_slp_ll_laplacebem3d(const uint * ridx, const uint * cidx,
   plistnode v;
   real     *xq, *yq, *wq, *ww;
   uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
-  real      norm, Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, dx, dy, dz, factor,
-    factor2, res, base;
+  real      factor, factor2, res, base;
   uint      i, j, t, s, k, l, rj, cj, tt, ss, q, nq, ii, jj, vv;
 
+  slpquad = select_slp_quadrature_laplacebem3d();
   quad = allocfield(bem->sq->nmax);
 
   clear_amatrix(N);
@@ -703,29 +944,8 @@ fill_slp_ll_laplacebem3d(const uint * ridx, const uint * cidx,
 	B_s = gr_x[tri_sp[1]];
 	C_s = gr_x[tri_sp[2]];
 
-	for (q = 0; q < nq; ++q) {
-	  tx = xq[q];
-	  sx = xq[q + nq];
-	  ty = yq[q];
-	  sy = yq[q + nq];
-	  Ax = 1.0 - tx;
-	  Bx = tx - sx;
-	  Cx = sx;
-	  Ay = 1.0 - ty;
-	  By = ty - sy;
-	  Cy = sy;
-
-	  dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
-	    - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
-	  dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
-	    - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
-	  dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
-	    - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
-
-	  norm = REAL_SQRT(dx * dx + dy * dy + dz * dz);
-
-	  quad[q] = 1.0 / norm;
-	}
+	slpquad(nq, xq, xq + nq, yq, yq + nq, A_t, B_t, C_t,
+		A_s, B_s, C_s, quad);
 
 	vl_c = tl1_c->vl;
 	while (vl_c) {
@@ -835,29 +1055,8 @@ fill_slp_ll_laplacebem3d(const uint * ridx, const uint * cidx,
 	B_s = gr_x[tri_sp[1]];
 	C_s = gr_x[tri_sp[2]];
 
-	for (q = 0; q < nq; ++q) {
-	  tx = xq[q];
-	  sx = xq[q + nq];
-	  ty = yq[q];
-	  sy = yq[q + nq];
-	  Ax = 1.0 - tx;
-	  Bx = tx - sx;
-	  Cx = sx;
-	  Ay = 1.0 - ty;
-	  By = ty - sy;
-	  Cy = sy;
-
-	  dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
-	    - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
-	  dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
-	    - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
-	  dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
-	    - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
-
-	  norm = REAL_SQRT(dx * dx + dy * dy + dz * dz);
-
-	  quad[q] = 1.0 / norm;
-	}
+	slpquad(nq, xq, xq + nq, yq, yq + nq, A_t, B_t, C_t,
+		A_s, B_s, C_s, quad);
 
 	vl_c = tl1_c->vl;
 	while (vl_c) {
@@ -910,6 +1109,7 @@ fill_dlp_ll_laplacebem3d(const uint * ridx, const uint * cidx,
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const uint triangles = gr->triangles;
   plistnode *v2t = bem->v2t;
+  dlpquad_laplacebem3d dlpquad;
   field    *quad;
   field    *aa = N->a;
   uint      rows = N->rows;
@@ -923,10 +1123,10 @@ fill_dlp_ll_laplacebem3d(const uint * ridx, const uint * cidx,
   plistnode v;
   real     *xq, *yq, *wq, *ww, *mass;
   uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
-  real      res, norm, base, Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, dx, dy,
-    dz, factor, factor2;
+  real      res, base, factor, factor2;
   uint      i, j, k, l, t, s, tt, ss, q, nq, rj, cj, ii, jj, vv;
 
+  dlpquad = select_dlp_quadrature_laplacebem3d();
   quad = allocfield(bem->sq->nmax);
 
   clear_amatrix(N);
@@ -1009,30 +1209,8 @@ fill_dlp_ll_laplacebem3d(const uint * ridx, const uint * cidx,
 	  B_s = gr_x[tri_sp[1]];
 	  C_s = gr_x[tri_sp[2]];
 
-	  for (q = 0; q < nq; ++q) {
-	    tx = xq[q];
-	    sx = xq[q + nq];
-	    ty = yq[q];
-	    sy = yq[q + nq];
-	    Ax = 1.0 - tx;
-	    Bx = tx - sx;
-	    Cx = sx;
-	    Ay = 1.0 - ty;
-	    By = ty - sy;
-	    Cy = sy;
-
-	    dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
-	      - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
-	    dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
-	      - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
-	    dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
-	      - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
-
-	    norm = dx * dx + dy * dy + dz * dz;
-
-	    quad[q] = (dx * ns[0] + dy * ns[1] + dz * ns[2])
-	      / (norm * REAL_SQRT(norm));
-	  }
+	  dlpquad(nq, xq, xq + nq, yq, yq + nq, A_t, B_t, C_t,
+		  A_s, B_s, C_s, ns, quad);
 
 	  vl_c = tl1_c->vl;
 	  while (vl_c) {
@@ -1182,30 +1360,8 @@ fill_dlp_ll_laplacebem3d(const uint * ridx, const uint * cidx,
 	  B_s = gr_x[tri_sp[1]];
 	  C_s = gr_x[tri_sp[2]];
 
-	  for (q = 0; q < nq; ++q) {
-	    tx = xq[q];
-	    sx = xq[q + nq];
-	    ty = yq[q];
-	    sy = yq[q + nq];
-	    Ax = 1.0 - tx;
-	    Bx = tx - sx;
-	    Cx = sx;
-	    Ay = 1.0 - ty;
-	    By = ty - sy;
-	    Cy = sy;
-
-	    dx = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx
-	      - (A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy);
-	    dy = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx
-	      - (A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy);
-	    dz = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx
-	      - (A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy);
-
-	    norm = dx * dx + dy * dy + dz * dz;
-
-	    quad[q] = (dx * ns[0] + dy * ns[1] + dz * ns[2])
-	      / (norm * REAL_SQRT(norm));
-	  }
+	  dlpquad(nq, xq, xq + nq, yq, yq + nq, A_t, B_t, C_t,
+		  A_s, B_s, C_s, ns, quad);
 
 	  vl_c = tl1_c->vl;
 	  while (vl_c) {
@@ -1282,26 +1438,381 @@ fill_dlp_ll_laplacebem3d(const uint * ridx, const uint * cidx,
   freemem(quad);
 }
 
+/* ------------------------------------------------------------
+ Evaluation of the fundamental solution
+ ------------------------------------------------------------ */
+
+/* The point sets are converted to structure-of-arrays form, i.e., all
+ * x, y and z coordinates are stored in separate contiguous arrays.
+ * The matrices are then filled column by column, so the innermost
+ * loop runs over contiguous arrays and can be processed in batches of
+ * four or eight entries by the AVX2 or AVX-512 versions. These are
+ * selected at runtime if the library is compiled with USE_SIMD. */
+
+static real *
+soa_points_laplacebem3d(const real(*X)[3], uint n)
+{
+  real     *xs;
+  uint      i;
+
+  xs = allocreal(3 * (size_t) n);
+
+  for (i = 0; i < n; i++) {
+    xs[i] = X[i][0];
+    xs[i + n] = X[i][1];
+    xs[i + 2 * n] = X[i][2];
+  }
+
+  return xs;
+}
+
+static void
+kernel_column_laplacebem3d(uint rows, const real * x0, const real * x1,
+			   const real * x2, const real * y, pfield v)
+{
+  uint      i;
+  real      dx, dy, dz;
+
+  for (i = 0; i < rows; i++) {
+    dx = x0[i] - y[0];
+    dy = x1[i] - y[1];
+    dz = x2[i] - y[2];
+
+    v[i] = KERNEL_CONST_BEM3D / REAL_SQRT(dx * dx + dy * dy + dz * dz);
+  }
+}
+
+static void
+dny_kernel_column_laplacebem3d(uint rows, const real * x0, const real * x1,
+			       const real * x2, const real * y,
+			       const real * ny, pfield v)
+{
+  uint      i;
+  real      dx, dy, dz, norm2;
+
+  for (i = 0; i < rows; i++) {
+    dx = x0[i] - y[0];
+    dy = x1[i] - y[1];
+    dz = x2[i] - y[2];
+
+    norm2 = 1.0 / (dx * dx + dy * dy + dz * dz);
+
+    v[i] = KERNEL_CONST_BEM3D * (dx * ny[0] + dy * ny[1] + dz * ny[2])
+      * norm2 * REAL_SQRT(norm2);
+  }
+}
+
+static void
+dnx_dny_kernel_column_laplacebem3d(uint rows, const real * x0,
+				   const real * x1, const real * x2,
+				   const real * nx0, const real * nx1,
+				   const real * nx2, const real * y,
+				   const real * ny, pfield v)
+{
+  uint      i;
+  real      dx, dy, dz, norm2, dot1, h0, h1, h2;
+
+  for (i = 0; i < rows; i++) {
+    dx = x0[i] - y[0];
+    dy = x1[i] - y[1];
+    dz = x2[i] - y[2];
+
+    norm2 = 1.0 / (dx * dx + dy * dy + dz * dz);
+
+    dot1 = -3.0 * norm2 * (ny[0] * dx + ny[1] * dy + ny[2] * dz);
+    h0 = dx * dot1 + ny[0];
+    h1 = dy * dot1 + ny[1];
+    h2 = dz * dot1 + ny[2];
+
+    v[i] = KERNEL_CONST_BEM3D * REAL_SQRT(norm2) * norm2
+      * (h0 * nx0[i] + h1 * nx1[i] + h2 * nx2[i]);
+  }
+}
+
+#ifdef USE_SIMD_LAPLACEBEM3D
+__attribute__ ((target("avx2")))
+static void
+kernel_column_avx2_laplacebem3d(uint rows, const real * x0, const real * x1,
+				const real * x2, const real * y, pfield v)
+{
+  __m256d   y0, y1, y2, c, dx, dy, dz, r2;
+  uint      i;
+
+  y0 = _mm256_set1_pd(y[0]);
+  y1 = _mm256_set1_pd(y[1]);
+  y2 = _mm256_set1_pd(y[2]);
+  c = _mm256_set1_pd(KERNEL_CONST_BEM3D);
+
+  for (i = 0; i + 4 <= rows; i += 4) {
+    dx = _mm256_sub_pd(_mm256_loadu_pd(x0 + i), y0);
+    dy = _mm256_sub_pd(_mm256_loadu_pd(x1 + i), y1);
+    dz = _mm256_sub_pd(_mm256_loadu_pd(x2 + i), y2);
+
+    r2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx),
+				     _mm256_mul_pd(dy, dy)),
+		       _mm256_mul_pd(dz, dz));
+
+    _mm256_storeu_pd(v + i, _mm256_div_pd(c, _mm256_sqrt_pd(r2)));
+  }
+
+  kernel_column_laplacebem3d(rows - i, x0 + i, x1 + i, x2 + i, y, v + i);
+}
+
+__attribute__ ((target("avx2")))
+static void
+dny_kernel_column_avx2_laplacebem3d(uint rows, const real * x0,
+				    const real * x1, const real * x2,
+				    const real * y, const real * ny, pfield v)
+{
+  __m256d   y0, y1, y2, n0, n1, n2, c, one, dx, dy, dz, norm2, dot;
+  uint      i;
+
+  y0 = _mm256_set1_pd(y[0]);
+  y1 = _mm256_set1_pd(y[1]);
+  y2 = _mm256_set1_pd(y[2]);
+  n0 = _mm256_set1_pd(ny[0]);
+  n1 = _mm256_set1_pd(ny[1]);
+  n2 = _mm256_set1_pd(ny[2]);
+  c = _mm256_set1_pd(KERNEL_CONST_BEM3D);
+  one = _mm256_set1_pd(1.0);
+
+  for (i = 0; i + 4 <= rows; i += 4) {
+    dx = _mm256_sub_pd(_mm256_loadu_pd(x0 + i), y0);
+    dy = _mm256_sub_pd(_mm256_loadu_pd(x1 + i), y1);
+    dz = _mm256_sub_pd(_mm256_loadu_pd(x2 + i), y2);
+
+    norm2 = _mm256_div_pd(one,
+			  _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx),
+						      _mm256_mul_pd(dy, dy)),
+					_mm256_mul_pd(dz, dz)));
+
+    dot = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, n0),
+				      _mm256_mul_pd(dy, n1)),
+			_mm256_mul_pd(dz, n2));
+
+    _mm256_storeu_pd(v + i,
+		     _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(c, dot), norm2),
+				   _mm256_sqrt_pd(norm2)));
+  }
+
+  dny_kernel_column_laplacebem3d(rows - i, x0 + i, x1 + i, x2 + i, y, ny,
+				 v + i);
+}
+
+__attribute__ ((target("avx2")))
+static void
+dnx_dny_kernel_column_avx2_laplacebem3d(uint rows, const real * x0,
+					const real * x1, const real * x2,
+					const real * nx0, const real * nx1,
+					const real * nx2, const real * y,
+					const real * ny, pfield v)
+{
+  __m256d   y0, y1, y2, n0, n1, n2, c, one, m3;
+  __m256d   dx, dy, dz, norm2, dot1, h0, h1, h2, hn;
+  uint      i;
+
+  y0 = _mm256_set1_pd(y[0]);
+  y1 = _mm256_set1_pd(y[1]);
+  y2 = _mm256_set1_pd(y[2]);
+  n0 = _mm256_set1_pd(ny[0]);
+  n1 = _mm256_set1_pd(ny[1]);
+  n2 = _mm256_set1_pd(ny[2]);
+  c = _mm256_set1_pd(KERNEL_CONST_BEM3D);
+  one = _mm256_set1_pd(1.0);
+  m3 = _mm256_set1_pd(-3.0);
+
+  for (i = 0; i + 4 <= rows; i += 4) {
+    dx = _mm256_sub_pd(_mm256_loadu_pd(x0 + i), y0);
+    dy = _mm256_sub_pd(_mm256_loadu_pd(x1 + i), y1);
+    dz = _mm256_sub_pd(_mm256_loadu_pd(x2 + i), y2);
+
+    norm2 = _mm256_div_pd(one,
+			  _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx),
+						      _mm256_mul_pd(dy, dy)),
+					_mm256_mul_pd(dz, dz)));
+
+    dot1 = _mm256_mul_pd(_mm256_mul_pd(m3, norm2),
+			 _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(n0, dx),
+						     _mm256_mul_pd(n1, dy)),
+				       _mm256_mul_pd(n2, dz)));
+    h0 = _mm256_add_pd(_mm256_mul_pd(dx, dot1), n0);
+    h1 = _mm256_add_pd(_mm256_mul_pd(dy, dot1), n1);
+    h2 = _mm256_add_pd(_mm256_mul_pd(dz, dot1), n2);
+
+    hn = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(h0,
+						   _mm256_loadu_pd(nx0 + i)),
+				     _mm256_mul_pd(h1,
+						   _mm256_loadu_pd(nx1 + i))),
+		       _mm256_mul_pd(h2, _mm256_loadu_pd(nx2 + i)));
+
+    _mm256_storeu_pd(v + i,
+		     _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(c,
+							       _mm256_sqrt_pd
+							       (norm2)),
+						 norm2), hn));
+  }
+
+  dnx_dny_kernel_column_laplacebem3d(rows - i, x0 + i, x1 + i, x2 + i,
+				     nx0 + i, nx1 + i, nx2 + i, y, ny,
+				     v + i);
+}
+
+__attribute__ ((target("avx512f")))
+static void
+kernel_column_avx512_laplacebem3d(uint rows, const real * x0,
+				  const real * x1, const real * x2,
+				  const real * y, pfield v)
+{
+  __m512d   y0, y1, y2, c, dx, dy, dz, r2;
+  uint      i;
+
+  y0 = _mm512_set1_pd(y[0]);
+  y1 = _mm512_set1_pd(y[1]);
+  y2 = _mm512_set1_pd(y[2]);
+  c = _mm512_set1_pd(KERNEL_CONST_BEM3D);
+
+  for (i = 0; i + 8 <= rows; i += 8) {
+    dx = _mm512_sub_pd(_mm512_loadu_pd(x0 + i), y0);
+    dy = _mm512_sub_pd(_mm512_loadu_pd(x1 + i), y1);
+    dz = _mm512_sub_pd(_mm512_loadu_pd(x2 + i), y2);
+
+    r2 = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx),
+				     _mm512_mul_pd(dy, dy)),
+		       _mm512_mul_pd(dz, dz));
+
+    _mm512_storeu_pd(v + i, _mm512_div_pd(c, _mm512_sqrt_pd(r2)));
+  }
+
+  kernel_column_laplacebem3d(rows - i, x0 + i, x1 + i, x2 + i, y, v + i);
+}
+
+__attribute__ ((target("avx512f")))
+static void
+dny_kernel_column_avx512_laplacebem3d(uint rows, const real * x0,
+				      const real * x1, const real * x2,
+				      const real * y, const real * ny,
+				      pfield v)
+{
+  __m512d   y0, y1, y2, n0, n1, n2, c, one, dx, dy, dz, norm2, dot;
+  uint      i;
+
+  y0 = _mm512_set1_pd(y[0]);
+  y1 = _mm512_set1_pd(y[1]);
+  y2 = _mm512_set1_pd(y[2]);
+  n0 = _mm512_set1_pd(ny[0]);
+  n1 = _mm512_set1_pd(ny[1]);
+  n2 = _mm512_set1_pd(ny[2]);
+  c = _mm512_set1_pd(KERNEL_CONST_BEM3D);
+  one = _mm512_set1_pd(1.0);
+
+  for (i = 0; i + 8 <= rows; i += 8) {
+    dx = _mm512_sub_pd(_mm512_loadu_pd(x0 + i), y0);
+    dy = _mm512_sub_pd(_mm512_loadu_pd(x1 + i), y1);
+    dz = _mm512_sub_pd(_mm512_loadu_pd(x2 + i), y2);
+
+    norm2 = _mm512_div_pd(one,
+			  _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx),
+						      _mm512_mul_pd(dy, dy)),
+					_mm512_mul_pd(dz, dz)));
+
+    dot = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, n0),
+				      _mm512_mul_pd(dy, n1)),
+			_mm512_mul_pd(dz, n2));
+
+    _mm512_storeu_pd(v + i,
+		     _mm512_mul_pd(_mm512_mul_pd(_mm512_mul_pd(c, dot), norm2),
+				   _mm512_sqrt_pd(norm2)));
+  }
+
+  dny_kernel_column_laplacebem3d(rows - i, x0 + i, x1 + i, x2 + i, y, ny,
+				 v + i);
+}
+
+__attribute__ ((target("avx512f")))
+static void
+dnx_dny_kernel_column_avx512_laplacebem3d(uint rows, const real * x0,
+					  const real * x1, const real * x2,
+					  const real * nx0, const real * nx1,
+					  const real * nx2, const real * y,
+					  const real * ny, pfield v)
+{
+  __m512d   y0, y1, y2, n0, n1, n2, c, one, m3;
+  __m512d   dx, dy, dz, norm2, dot1, h0, h1, h2, hn;
+  uint      i;
+
+  y0 = _mm512_set1_pd(y[0]);
+  y1 = _mm512_set1_pd(y[1]);
+  y2 = _mm512_set1_pd(y[2]);
+  n0 = _mm512_set1_pd(ny[0]);
+  n1 = _mm512_set1_pd(ny[1]);
+  n2 = _mm512_set1_pd(ny[2]);
+  c = _mm512_set1_pd(KERNEL_CONST_BEM3D);
+  one = _mm512_set1_pd(1.0);
+  m3 = _mm512_set1_pd(-3.0);
+
+  for (i = 0; i + 8 <= rows; i += 8) {
+    dx = _mm512_sub_pd(_mm512_loadu_pd(x0 + i), y0);
+    dy = _mm512_sub_pd(_mm512_loadu_pd(x1 + i), y1);
+    dz = _mm512_sub_pd(_mm512_loadu_pd(x2 + i), y2);
+
+    norm2 = _mm512_div_pd(one,
+			  _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx),
+						      _mm512_mul_pd(dy, dy)),
+					_mm512_mul_pd(dz, dz)));
+
+    dot1 = _mm512_mul_pd(_mm512_mul_pd(m3, norm2),
+			 _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(n0, dx),
+						     _mm512_mul_pd(n1, dy)),
+				       _mm512_mul_pd(n2, dz)));
+    h0 = _mm512_add_pd(_mm512_mul_pd(dx, dot1), n0);
+    h1 = _mm512_add_pd(_mm512_mul_pd(dy, dot1), n1);
+    h2 = _mm512_add_pd(_mm512_mul_pd(dz, dot1), n2);
+
+    hn = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(h0,
+						   _mm512_loadu_pd(nx0 + i)),
+				     _mm512_mul_pd(h1,
+						   _mm512_loadu_pd(nx1 + i))),
+		       _mm512_mul_pd(h2, _mm512_loadu_pd(nx2 + i)));
+
+    _mm512_storeu_pd(v + i,
+		     _mm512_mul_pd(_mm512_mul_pd(_mm512_mul_pd(c,
+							       _mm512_sqrt_pd
+							       (norm2)),
+						 norm2), hn));
+  }
+
+  dnx_dny_kernel_column_laplacebem3d(rows - i, x0 + i, x1 + i, x2 + i,
+				     nx0 + i, nx1 + i, nx2 + i, y, ny,
+				     v + i);
+}
+#endif
+
 static void
 fill_kernel_laplacebem3d(const real(*X)[3], const real(*Y)[3], pamatrix V)
 {
   uint      rows = V->rows;
   uint      cols = V->cols;
-  uint      ld = V->ld;
+  longindex ld = V->ld;
 
-  uint      i, j;
-  real      dx, dy, dz;
+  void      (*column) (uint rows, const real * x0, const real * x1,
+			   const real * x2, const real * y, pfield v);
+  real     *xs;
+  uint      j;
 
-  for (j = 0; j < cols; ++j) {
-    for (i = 0; i < rows; ++i) {
-      dx = X[i][0] - Y[j][0];
-      dy = X[i][1] - Y[j][1];
-      dz = X[i][2] - Y[j][2];
+  column = kernel_column_laplacebem3d;
+#ifdef USE_SIMD_LAPLACEBEM3D
+  if (__builtin_cpu_supports("avx512f"))
+    column = kernel_column_avx512_laplacebem3d;
+  else if (__builtin_cpu_supports("avx2"))
+    column = kernel_column_avx2_laplacebem3d;
+#endif
 
-      V->a[i + j * ld] = KERNEL_CONST_BEM3D
-	/ REAL_SQRT(dx * dx + dy * dy + dz * dz);
-    }
-  }
+  xs = soa_points_laplacebem3d(X, rows);
+
+  for (j = 0; j < cols; ++j)
+    column(rows, xs, xs + rows, xs + 2 * rows, Y[j], V->a + j * ld);
+
+  freemem(xs);
 }
 
 static void
@@ -1310,24 +1821,28 @@ fill_dny_kernel_laplacebem3d(const real(*X)[3], const real(*Y)[3],
 {
   uint      rows = V->rows;
   uint      cols = V->cols;
-  uint      ld = V->ld;
+  longindex ld = V->ld;
 
-  uint      i, j;
-  real      dx, dy, dz, norm2;
+  void      (*column) (uint rows, const real * x0, const real * x1,
+			   const real * x2, const real * y, const real * ny,
+			   pfield v);
+  real     *xs;
+  uint      j;
 
-  for (j = 0; j < cols; ++j) {
-    for (i = 0; i < rows; ++i) {
-      dx = X[i][0] - Y[j][0];
-      dy = X[i][1] - Y[j][1];
-      dz = X[i][2] - Y[j][2];
+  column = dny_kernel_column_laplacebem3d;
+#ifdef USE_SIMD_LAPLACEBEM3D
+  if (__builtin_cpu_supports("avx512f"))
+    column = dny_kernel_column_avx512_laplacebem3d;
+  else if (__builtin_cpu_supports("avx2"))
+    column = dny_kernel_column_avx2_laplacebem3d;
+#endif
 
-      norm2 = 1.0 / (dx * dx + dy * dy + dz * dz);
+  xs = soa_points_laplacebem3d(X, rows);
 
-      V->a[i + j * ld] = KERNEL_CONST_BEM3D
-	* (dx * NY[j][0] + dy * NY[j][1] + dz * NY[j][2]) * norm2
-	* REAL_SQRT(norm2);
-    }
-  }
+  for (j = 0; j < cols; ++j)
+    column(rows, xs, xs + rows, xs + 2 * rows, Y[j], NY[j], V->a + j * ld);
+
+  freemem(xs);
 }
 
 static void
@@ -1337,30 +1852,32 @@ fill_dnx_dny_kernel_laplacebem3d(const real(*X)[3],
 {
   uint      rows = V->rows;
   uint      cols = V->cols;
-  uint      ld = V->ld;
-
-  uint      i, j;
-  real      h[3];
-  real      dx, dy, dz, norm2, dot1, kernel;
-
-  for (j = 0; j < cols; ++j) {
-    for (i = 0; i < rows; ++i) {
-      dx = X[i][0] - Y[j][0];
-      dy = X[i][1] - Y[j][1];
-      dz = X[i][2] - Y[j][2];
-
-      norm2 = 1.0 / (dx * dx + dy * dy + dz * dz);
-
-      dot1 = -3.0 * norm2 * (NY[j][0] * dx + NY[j][1] * dy + NY[j][2] * dz);
-      h[0] = dx * dot1 + NY[j][0];
-      h[1] = dy * dot1 + NY[j][1];
-      h[2] = dz * dot1 + NY[j][2];
-      kernel = REAL_SQRT(norm2) * norm2
-	* (h[0] * NX[i][0] + h[1] * NX[i][1] + h[2] * NX[i][2]);
-
-      V->a[i + j * ld] = KERNEL_CONST_BEM3D * kernel;
-    }
-  }
+  longindex ld = V->ld;
+
+  void      (*column) (uint rows, const real * x0, const real * x1,
+			   const real * x2, const real * nx0,
+			   const real * nx1, const real * nx2,
+			   const real * y, const real * ny, pfield v);
+  real     *xs, *nxs;
+  uint      j;
+
+  column = dnx_dny_kernel_column_laplacebem3d;
+#ifdef USE_SIMD_LAPLACEBEM3D
+  if (__builtin_cpu_supports("avx512f"))
+    column = dnx_dny_kernel_column_avx512_laplacebem3d;
+  else if (__builtin_cpu_supports("avx2"))
+    column = dnx_dny_kernel_column_avx2_laplacebem3d;
+#endif
+
+  xs = soa_points_laplacebem3d(X, rows);
+  nxs = soa_points_laplacebem3d(NX, rows);
+
+  for (j = 0; j < cols; ++j)
+    column(rows, xs, xs + rows, xs + 2 * rows, nxs, nxs + rows,
+	   nxs + 2 * rows, Y[j], NY[j], V->a + j * ld);
+
+  freemem(nxs);
+  freemem(xs);
 }
 
 static void
@@ -1368,21 +1885,20 @@ fill_kernel_c_laplacebem3d(const uint * idx, const real(*Z)[3],
 			   pcbem3d bem, pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const preal gr_g = (const preal) gr->g;
   uint      rows = V->rows;
   uint      cols = V->cols;
   uint      ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * nq;
 
-  const real *A, *B, *C;
+  const real *Xq;
+  real     *xbuf;
   uint      s, ss, i, q;
-  real      gs_fac, sum, kernel, x, y, z, tx, sx, Ax, Bx, Cx;
+  real      gs_fac, sum, kernel, x, y, z;
+
+  xbuf = allocreal(3 * nq);
 
   /*
    *  integrate kernel function over first variable with constant basisfunctions
@@ -1391,24 +1907,16 @@ fill_kernel_c_laplacebem3d(const uint * idx, const real(*Z)[3],
   for (s = 0; s < rows; ++s) {
     ss = (idx == NULL ? s : idx[s]);
     gs_fac = gr_g[ss] * KERNEL_CONST_BEM3D;
-    A = gr_x[gr_t[ss][0]];
-    B = gr_x[gr_t[ss][1]];
-    C = gr_x[gr_t[ss][2]];
+    Xq = getquadpoints_bem3d(bem, ss, xbuf);
 
     for (i = 0; i < cols; ++i) {
 
       sum = 0.0;
 
       for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	x = Z[i][0] - (A[0] * Ax + B[0] * Bx + C[0] * Cx);
-	y = Z[i][1] - (A[1] * Ax + B[1] * Bx + C[1] * Cx);
-	z = Z[i][2] - (A[2] * Ax + B[2] * Bx + C[2] * Cx);
+	x = Z[i][0] - Xq[q];
+	y = Z[i][1] - Xq[q + nq];
+	z = Z[i][2] - Xq[q + 2 * nq];
 
 	kernel = REAL_SQRT(x * x + y * y + z * z);
 
@@ -1418,6 +1926,8 @@ fill_kernel_c_laplacebem3d(const uint * idx, const real(*Z)[3],
       V->a[s + i * (longindex) ld] = sum * gs_fac;
     }
   }
+
+  freemem(xbuf);
 }
 
 static void
@@ -1425,7 +1935,6 @@ fill_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
 			   pcbem3d bem, pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const preal gr_g = (const preal) gr->g;
   plistnode *v2t = bem->v2t;
@@ -1434,22 +1943,22 @@ fill_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
   field    *aa = V->a;
   uint      ld = V->ld;
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
   real      base = bem->sq->base_single;
   field    *quad;
 
   ptri_list tl, tl1;
   pvert_list vl;
-  const real *A, *B, *C;
+  const real *Xq;
+  real     *xbuf;
   uint      tri_tp[3];
   plistnode v;
   uint      t, i, j, k, q, rj;
-  real      gt_fac, sum, kernel, x, y, z, tx, sx, Ax, Bx, Cx;
+  real      gt_fac, sum, kernel, x, y, z;
   longindex ii, tt, vv;
 
   quad = allocfield(nq);
+  xbuf = allocreal(3 * nq);
 
   clear_amatrix(V);
 
@@ -1480,9 +1989,7 @@ fill_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
   for (t = 0, tl1 = tl; t < rj; t++, tl1 = tl1->next) {
     tt = tl1->t;
     gt_fac = gr_g[tt] * KERNEL_CONST_BEM3D;
-    A = gr_x[gr_t[tt][0]];
-    B = gr_x[gr_t[tt][1]];
-    C = gr_x[gr_t[tt][2]];
+    Xq = getquadpoints_bem3d(bem, tt, xbuf);
 
     for (i = 0; i < 3; ++i) {
       tri_tp[i] = gr_t[tt][i];
@@ -1491,15 +1998,9 @@ fill_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
     for (j = 0; j < cols; ++j) {
 
       for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	x = A[0] * Ax + B[0] * Bx + C[0] * Cx - Z[j][0];
-	y = A[1] * Ax + B[1] * Bx + C[1] * Cx - Z[j][1];
-	z = A[2] * Ax + B[2] * Bx + C[2] * Cx - Z[j][2];
+	x = Xq[q] - Z[j][0];
+	y = Xq[q + nq] - Z[j][1];
+	z = Xq[q + 2 * nq] - Z[j][2];
 
 	kernel = REAL_SQRT(x * x + y * y + z * z);
 
@@ -1535,6 +2036,7 @@ fill_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
   del_tri_list(tl);
 
   freemem(quad);
+  freemem(xbuf);
 }
 
 static void
@@ -1542,43 +2044,34 @@ fill_dnz_kernel_c_laplacebem3d(const uint * idx, const real(*Z)[3],
 			       const real(*N)[3], pcbem3d bem, pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const preal gr_g = (const preal) gr->g;
   uint      rows = V->rows;
   uint      cols = V->cols;
   uint      ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * nq;
 
-  const real *A, *B, *C;
+  const real *Xq;
+  real     *xbuf;
   uint      t, tt, i, q;
-  real      gt_fac, sum, kernel, dx, dy, dz, tx, sx, Ax, Bx, Cx;
+  real      gt_fac, sum, kernel, dx, dy, dz;
+
+  xbuf = allocreal(3 * nq);
 
   for (t = 0; t < rows; ++t) {
     tt = (idx == NULL ? t : idx[t]);
     gt_fac = gr_g[tt] * KERNEL_CONST_BEM3D;
-    A = gr_x[gr_t[tt][0]];
-    B = gr_x[gr_t[tt][1]];
-    C = gr_x[gr_t[tt][2]];
+    Xq = getquadpoints_bem3d(bem, tt, xbuf);
 
     for (i = 0; i < cols; ++i) {
 
       sum = 0.0;
 
       for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	dx = A[0] * Ax + B[0] * Bx + C[0] * Cx - Z[i][0];
-	dy = A[1] * Ax + B[1] * Bx + C[1] * Cx - Z[i][1];
-	dz = A[2] * Ax + B[2] * Bx + C[2] * Cx - Z[i][2];
+	dx = Xq[q] - Z[i][0];
+	dy = Xq[q + nq] - Z[i][1];
+	dz = Xq[q + 2 * nq] - Z[i][2];
 
 	kernel = dx * dx + dy * dy + dz * dz;
 
@@ -1590,6 +2083,8 @@ fill_dnz_kernel_c_laplacebem3d(const uint * idx, const real(*Z)[3],
       V->a[t + i * ld] = sum * gt_fac;
     }
   }
+
+  freemem(xbuf);
 }
 
 static void
@@ -1597,7 +2092,6 @@ fill_dnz_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
 			       const real(*N)[3], pcbem3d bem, pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const preal gr_g = (const preal) gr->g;
   plistnode *v2t = bem->v2t;
@@ -1606,22 +2100,22 @@ fill_dnz_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
   field    *aa = V->a;
   uint      ld = V->ld;
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
   real      base = bem->sq->base_single;
   field    *quad;
 
   ptri_list tl, tl1;
   pvert_list vl;
-  const real *A, *B, *C;
+  const real *Xq;
+  real     *xbuf;
   uint      tri_tp[3];
   plistnode v;
   uint      t, i, j, k, q, rj;
-  real      gt_fac, sum, kernel, x, y, z, tx, sx, Ax, Bx, Cx;
+  real      gt_fac, sum, kernel, x, y, z;
   longindex ii, tt, vv;
 
   quad = allocfield(nq);
+  xbuf = allocreal(3 * nq);
 
   clear_amatrix(V);
 
@@ -1652,9 +2146,7 @@ fill_dnz_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
   for (t = 0, tl1 = tl; t < rj; t++, tl1 = tl1->next) {
     tt = tl1->t;
     gt_fac = gr_g[tt] * KERNEL_CONST_BEM3D;
-    A = gr_x[gr_t[tt][0]];
-    B = gr_x[gr_t[tt][1]];
-    C = gr_x[gr_t[tt][2]];
+    Xq = getquadpoints_bem3d(bem, tt, xbuf);
 
     for (i = 0; i < 3; ++i) {
       tri_tp[i] = gr_t[tt][i];
@@ -1663,15 +2155,9 @@ fill_dnz_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
     for (j = 0; j < cols; ++j) {
 
       for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	x = A[0] * Ax + B[0] * Bx + C[0] * Cx - Z[j][0];
-	y = A[1] * Ax + B[1] * Bx + C[1] * Cx - Z[j][1];
-	z = A[2] * Ax + B[2] * Bx + C[2] * Cx - Z[j][2];
+	x = Xq[q] - Z[j][0];
+	y = Xq[q + nq] - Z[j][1];
+	z = Xq[q + 2 * nq] - Z[j][2];
 
 	kernel = x * x + y * y + z * z;
 
@@ -1707,6 +2193,7 @@ fill_dnz_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
   del_tri_list(tl);
 
   freemem(quad);
+  freemem(xbuf);
 }
 
 static void
@@ -1715,30 +2202,27 @@ fill_dnzdcol_kernel_c_laplacebem3d(const uint * idx,
 				   pcbem3d bem, pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const preal gr_g = (const preal) gr->g;
   uint      rows = V->rows;
   uint      cols = V->cols;
   uint      ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * nq;
 
-  const real *A, *B, *C, *ns;
+  const real *Xq, *ns;
+  real     *xbuf;
   uint      s, ss, i, q;
-  real      gs_fac, sum, kernel, norm2, dot1, tx, sx, Ax, Bx, Cx;
+  real      gs_fac, sum, kernel, norm2, dot1;
   real      dxy[3], h[3];
 
+  xbuf = allocreal(3 * nq);
+
   for (s = 0; s < rows; ++s) {
     ss = (idx == NULL ? s : idx[s]);
     gs_fac = gr_g[ss] * KERNEL_CONST_BEM3D;
-    A = gr_x[gr_t[ss][0]];
-    B = gr_x[gr_t[ss][1]];
-    C = gr_x[gr_t[ss][2]];
+    Xq = getquadpoints_bem3d(bem, ss, xbuf);
     ns = gr_n[ss];
 
     for (i = 0; i < cols; ++i) {
@@ -1746,15 +2230,9 @@ fill_dnzdcol_kernel_c_laplacebem3d(const uint * idx,
       sum = 0.0;
 
       for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	dxy[0] = Z[i][0] - (A[0] * Ax + B[0] * Bx + C[0] * Cx);
-	dxy[1] = Z[i][1] - (A[1] * Ax + B[1] * Bx + C[1] * Cx);
-	dxy[2] = Z[i][2] - (A[2] * Ax + B[2] * Bx + C[2] * Cx);
+	dxy[0] = Z[i][0] - Xq[q];
+	dxy[1] = Z[i][1] - Xq[q + nq];
+	dxy[2] = Z[i][2] - Xq[q + 2 * nq];
 
 	norm2 = 1.0 / (dxy[0] * dxy[0] + dxy[1] * dxy[1] + dxy[2] * dxy[2]);
 
@@ -1773,6 +2251,8 @@ fill_dnzdcol_kernel_c_laplacebem3d(const uint * idx,
       V->a[s + i * ld] = sum * gs_fac;
     }
   }
+
+  freemem(xbuf);
 }
 
 static void
@@ -1781,7 +2261,6 @@ fill_dnzdcol_kernel_l_laplacebem3d(const uint * idx,
 				   pcbem3d bem, pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const preal gr_g = (const preal) gr->g;
@@ -1791,23 +2270,23 @@ fill_dnzdcol_kernel_l_laplacebem3d(const uint * idx,
   field    *aa = V->a;
   uint      ld = V->ld;
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
   real      base = bem->sq->base_single;
   field    *quad;
 
   ptri_list tl, tl1;
   pvert_list vl;
-  const real *A, *B, *C, *nt;
+  const real *Xq, *nt;
+  real     *xbuf;
   uint      tri_tp[3];
   plistnode v;
   uint      t, i, j, k, q, rj;
-  real      gt_fac, sum, kernel, norm2, dot1, tx, sx, Ax, Bx, Cx;
+  real      gt_fac, sum, kernel, norm2, dot1;
   real      dxy[3], h[3];
   longindex ii, tt, vv;
 
   quad = allocfield(nq);
+  xbuf = allocreal(3 * nq);
 
   clear_amatrix(V);
 
@@ -1839,9 +2318,7 @@ fill_dnzdcol_kernel_l_laplacebem3d(const uint * idx,
     tt = tl1->t;
     gt_fac = gr_g[tt] * KERNEL_CONST_BEM3D;
     nt = gr_n[tt];
-    A = gr_x[gr_t[tt][0]];
-    B = gr_x[gr_t[tt][1]];
-    C = gr_x[gr_t[tt][2]];
+    Xq = getquadpoints_bem3d(bem, tt, xbuf);
 
     for (i = 0; i < 3; ++i) {
       tri_tp[i] = gr_t[tt][i];
@@ -1850,15 +2327,9 @@ fill_dnzdcol_kernel_l_laplacebem3d(const uint * idx,
     for (j = 0; j < cols; ++j) {
 
       for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	dxy[0] = Z[j][0] - (A[0] * Ax + B[0] * Bx + C[0] * Cx);
-	dxy[1] = Z[j][1] - (A[1] * Ax + B[1] * Bx + C[1] * Cx);
-	dxy[2] = Z[j][2] - (A[2] * Ax + B[2] * Bx + C[2] * Cx);
+	dxy[0] = Z[j][0] - Xq[q];
+	dxy[1] = Z[j][1] - Xq[q + nq];
+	dxy[2] = Z[j][2] - Xq[q + 2 * nq];
 
 	norm2 = 1.0 / (dxy[0] * dxy[0] + dxy[1] * dxy[1] + dxy[2] * dxy[2]);
 
@@ -1901,6 +2372,7 @@ fill_dnzdcol_kernel_l_laplacebem3d(const uint * idx,
   del_tri_list(tl);
 
   freemem(quad);
+  freemem(xbuf);
 }
 
 static void
@@ -1909,22 +2381,21 @@ fill_dcol_kernel_col_c_laplacebem3d(const uint * idx,
 				    pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const preal gr_g = (const preal) gr->g;
   uint      rows = V->rows;
   uint      cols = V->cols;
   uint      ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * nq;
 
-  const real *A, *B, *C, *ns;
+  const real *Xq, *ns;
+  real     *xbuf;
   uint      s, ss, i, q;
-  real      gs_fac, sum, kernel, dx, dy, dz, tx, sx, Ax, Bx, Cx;
+  real      gs_fac, sum, kernel, dx, dy, dz;
+
+  xbuf = allocreal(3 * nq);
 
   /*
    *  integrate kernel function over first variable with constant basisfunctions
@@ -1934,24 +2405,16 @@ fill_dcol_kernel_col_c_laplacebem3d(const uint * idx,
     ss = (idx == NULL ? s : idx[s]);
     gs_fac = gr_g[ss] * KERNEL_CONST_BEM3D;
     ns = gr_n[ss];
-    A = gr_x[gr_t[ss][0]];
-    B = gr_x[gr_t[ss][1]];
-    C = gr_x[gr_t[ss][2]];
+    Xq = getquadpoints_bem3d(bem, ss, xbuf);
 
     for (i = 0; i < cols; ++i) {
 
       sum = 0.0;
 
       for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	dx = Z[i][0] - (A[0] * Ax + B[0] * Bx + C[0] * Cx);
-	dy = Z[i][1] - (A[1] * Ax + B[1] * Bx + C[1] * Cx);
-	dz = Z[i][2] - (A[2] * Ax + B[2] * Bx + C[2] * Cx);
+	dx = Z[i][0] - Xq[q];
+	dy = Z[i][1] - Xq[q + nq];
+	dz = Z[i][2] - Xq[q + 2 * nq];
 
 	kernel = dx * dx + dy * dy + dz * dz;
 
@@ -1963,6 +2426,8 @@ fill_dcol_kernel_col_c_laplacebem3d(const uint * idx,
       V->a[s + i * ld] = sum * gs_fac;
     }
   }
+
+  freemem(xbuf);
 }
 
 static void
@@ -1971,7 +2436,6 @@ fill_dcol_kernel_col_l_laplacebem3d(const uint * idx,
 				    pamatrix V)
 {
   pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const preal gr_g = (const preal) gr->g;
@@ -1981,22 +2445,22 @@ fill_dcol_kernel_col_l_laplacebem3d(const uint * idx,
   field    *aa = V->a;
   uint      ld = V->ld;
   uint      nq = bem->sq->n_single;
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
   real      base = bem->sq->base_single;
   field    *quad;
 
   ptri_list tl, tl1;
   pvert_list vl;
-  const real *A, *B, *C, *nt;
+  const real *Xq, *nt;
+  real     *xbuf;
   uint      tri_tp[3];
   plistnode v;
   uint      t, i, j, k, q, rj;
-  real      gt_fac, sum, kernel, dx, dy, dz, tx, sx, Ax, Bx, Cx;
+  real      gt_fac, sum, kernel, dx, dy, dz;
   longindex ii, tt, vv;
 
   quad = allocfield(nq);
+  xbuf = allocreal(3 * nq);
 
   clear_amatrix(V);
 
@@ -2028,9 +2492,7 @@ fill_dcol_kernel_col_l_laplacebem3d(const uint * idx,
     tt = tl1->t;
     gt_fac = gr_g[tt] * KERNEL_CONST_BEM3D;
     nt = gr_n[tt];
-    A = gr_x[gr_t[tt][0]];
-    B = gr_x[gr_t[tt][1]];
-    C = gr_x[gr_t[tt][2]];
+    Xq = getquadpoints_bem3d(bem, tt, xbuf);
 
     for (i = 0; i < 3; ++i) {
       tri_tp[i] = gr_t[tt][i];
@@ -2039,15 +2501,9 @@ fill_dcol_kernel_col_l_laplacebem3d(const uint * idx,
     for (j = 0; j < cols; ++j) {
 
       for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	dx = Z[j][0] - (A[0] * Ax + B[0] * Bx + C[0] * Cx);
-	dy = Z[j][1] - (A[1] * Ax + B[1] * Bx + C[1] * Cx);
-	dz = Z[j][2] - (A[2] * Ax + B[2] * Bx + C[2] * Cx);
+	dx = Z[j][0] - Xq[q];
+	dy = Z[j][1] - Xq[q + nq];
+	dz = Z[j][2] - Xq[q + 2 * nq];
 
 	kernel = dx * dx + dy * dy + dz * dz;
 
@@ -2083,6 +2539,7 @@ fill_dcol_kernel_col_l_laplacebem3d(const uint * idx,
   del_tri_list(tl);
 
   freemem(quad);
+  freemem(xbuf);
 }
 
 pbem3d
@@ -112,6 +112,19 @@ typedef field *pfield;
 /** @brief Pointer to constant @ref field array. */
 typedef const field *pcfield;
 
+/** @brief Single-precision field type.
+ *
+ *  This type is used to store coefficients that do not require
+ *  full precision, computations are still carried out with
+ *  @ref field. */
+typedef float sfield;
+
+/** @brief Pointer to @ref sfield array. */
+typedef sfield *psfield;
+
+/** @brief Pointer to constant @ref sfield array. */
+typedef const sfield *pcsfield;
+
 /** @brief @ref field constant zero */
 extern const field f_zero;
 
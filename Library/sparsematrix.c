@@ -35,44 +35,122 @@ new_zero_sparsematrix(psparsepattern sp)
 {
   psparsematrix A;
   ppatentry e;
-  uint     *row;
-  uint     *col;
-  pfield    coeff;
-  uint      rows, cols;
+  uint     *ri, *ci;
   uint      nz;
-  uint      i, j;
+  uint      i;
 
   assert(sp != NULL);
 
-  rows = sp->rows;
-  cols = sp->cols;
-
   /* Find out total number of non-zero entries */
   nz = 0;
   for (i = 0; i < sp->rows; i++)
     for (e = sp->row[i]; e != NULL; e = e->next)
       nz++;
 
-  /* Create empty sparse matrix */
+  /* Collect entries in coordinate format */
+  ri = allocuint(nz);
+  ci = allocuint(nz);
+  nz = 0;
+  for (i = 0; i < sp->rows; i++)
+    for (e = sp->row[i]; e != NULL; e = e->next) {
+      assert(e->row == i);
+      ri[nz] = i;
+      ci[nz] = e->col;
+      nz++;
+    }
+
+  /* Sort entries and initialize coefficients by zero */
+  A = new_coo_sparsematrix(sp->rows, sp->cols, nz, ri, ci, NULL);
+
+  freemem(ci);
+  freemem(ri);
+
+  return A;
+}
+
+psparsematrix
+new_coo_sparsematrix(uint rows, uint cols, uint n,
+		     const uint * ri, const uint * ci, pcfield x)
+{
+  psparsematrix A;
+  uint     *start, *perm1, *perm2;
+  uint     *row, *col;
+  pfield    coeff;
+  uint      nz;
+  uint      i, j, k, l;
+
+  assert(n == 0 || ri != NULL);
+  assert(n == 0 || ci != NULL);
+
+  perm1 = allocuint(n);
+  perm2 = allocuint(n);
+
+  /* Stable counting sort by column indices */
+  start = allocuint(cols + 1);
+  for (j = 0; j <= cols; j++)
+    start[j] = 0;
+  for (k = 0; k < n; k++) {
+    assert(ci[k] < cols);
+    start[ci[k] + 1]++;
+  }
+  for (j = 0; j < cols; j++)
+    start[j + 1] += start[j];
+  for (k = 0; k < n; k++)
+    perm1[start[ci[k]]++] = k;
+  freemem(start);
+
+  /* Stable counting sort by row indices, columns remain ascending */
+  start = allocuint(rows + 1);
+  for (i = 0; i <= rows; i++)
+    start[i] = 0;
+  for (k = 0; k < n; k++) {
+    assert(ri[k] < rows);
+    start[ri[k] + 1]++;
+  }
+  for (i = 0; i < rows; i++)
+    start[i + 1] += start[i];
+  for (l = 0; l < n; l++) {
+    k = perm1[l];
+    perm2[start[ri[k]]++] = k;
+  }
+  freemem(start);
+
+  /* Count distinct entries */
+  nz = 0;
+  for (l = 0; l < n; l++)
+    if (l == 0 || ri[perm2[l]] != ri[perm2[l - 1]]
+	|| ci[perm2[l]] != ci[perm2[l - 1]])
+      nz++;
+
+  /* Create matrix, merging duplicate entries */
   A = new_raw_sparsematrix(rows, cols, nz);
   row = A->row;
   col = A->col;
   coeff = A->coeff;
 
-  /* Initialize pattern */
   j = 0;
+  l = 0;
   for (i = 0; i < rows; i++) {
     row[i] = j;
-    for (e = sp->row[i]; e != NULL; e = e->next) {
-      assert(e->row == i);
-      col[j] = e->col;
-      coeff[j] = 0.0;
-      j++;
+    for (; l < n && ri[perm2[l]] == i; l++) {
+      k = perm2[l];
+      if (j > row[i] && col[j - 1] == ci[k]) {
+	if (x)
+	  coeff[j - 1] += x[k];
+      }
+      else {
+	col[j] = ci[k];
+	coeff[j] = (x ? x[k] : 0.0);
+	j++;
+      }
     }
   }
   assert(j == nz);
   row[i] = j;
 
+  freemem(perm2);
+  freemem(perm1);
+
   /* Ensure that diagonal entries come first */
   sort_sparsematrix(A);
 
@@ -94,6 +172,44 @@ del_sparsematrix(psparsematrix a)
    Access methods
    ------------------------------------------------------------ */
 
+/* Find the position of an entry in the compressed row storage.
+   Rows created by new_coo_sparsematrix or new_zero_sparsematrix
+   contain the diagonal entry first and the remaining entries in
+   ascending order, so a binary search can be used.
+   Rows of other matrices are handled by a linear search. */
+static uint
+findentry(pcsparsematrix a, uint row, uint col)
+{
+  const uint *acol = a->col;
+  uint      lo, hi, mid, i;
+
+  lo = a->row[row];
+  hi = a->row[row + 1];
+
+  if (lo < hi) {
+    if (acol[lo] == col)
+      return lo;
+    if (acol[lo] == row)
+      lo++;
+  }
+
+  i = lo;
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (acol[mid] < col)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < a->row[row + 1] && acol[lo] == col)
+    return lo;
+
+  hi = a->row[row + 1];
+  for (; i < hi && acol[i] != col; i++);
+
+  return i;
+}
+
 field
 addentry_sparsematrix(psparsematrix a, uint row, uint col, field x)
 {
@@ -103,7 +219,7 @@ addentry_sparsematrix(psparsematrix a, uint row, uint col, field x)
   assert(row < a->rows);
   assert(col < a->cols);
 
-  for (i = a->row[row]; i < a->row[row + 1] && a->col[i] != col; i++);
+  i = findentry(a, row, col);
 
   assert(i < a->row[row + 1]);
   assert(a->col[i] == col);
@@ -120,7 +236,7 @@ setentry_sparsematrix(psparsematrix a, uint row, uint col, field x)
   assert(row < a->rows);
   assert(col < a->cols);
 
-  for (i = a->row[row]; i < a->row[row + 1] && a->col[i] != col; i++);
+  i = findentry(a, row, col);
   assert(i < a->row[row + 1]);
   assert(a->col[i] == col);
 
@@ -148,21 +264,6 @@ getsize_sparsematrix(pcsparsematrix a)
    Simple utility functions
    ------------------------------------------------------------ */
 
-static void
-swap(uint i1, uint i2, uint * col, pfield coeff)
-{
-  uint      hcol;
-  field     hcoeff;
-
-  hcol = col[i1];
-  col[i1] = col[i2];
-  col[i2] = hcol;
-
-  hcoeff = coeff[i1];
-  coeff[i1] = coeff[i2];
-  coeff[i2] = hcoeff;
-}
-
 void
 sort_sparsematrix(psparsematrix a)
 {
@@ -170,13 +271,24 @@ sort_sparsematrix(psparsematrix a)
   uint     *col = a->col;
   pfield    coeff = a->coeff;
   uint      rows = a->rows;
-  uint      i, j, k;
+  uint      hcol;
+  field     hcoeff;
+  uint      i, j;
 
   for (i = 0; i < rows; i++) {
-    k = row[i];
     for (j = row[i]; j < row[i + 1] && i != col[j]; j++);
-    if (j < row[i + 1])
-      swap(k, j, col, coeff);
+    if (j < row[i + 1]) {
+      /* Move the diagonal entry to the front, keeping the order
+         of all other entries */
+      hcol = col[j];
+      hcoeff = coeff[j];
+      for (; j > row[i]; j--) {
+	col[j] = col[j - 1];
+	coeff[j] = coeff[j - 1];
+      }
+      col[j] = hcol;
+      coeff[j] = hcoeff;
+    }
   }
 }
 
@@ -281,6 +393,13 @@ print_eps_sparsematrix(pcsparsematrix a, const char *filename, uint offset)
    Basic linear algebra
    ------------------------------------------------------------ */
 
+#ifdef USE_OPENMP
+/* matrices with at least this number of non-zero entries are multiplied
+   by several threads, starting a parallel region takes a few microseconds,
+   roughly the time of ten thousand multiply-adds */
+#define PARALLEL_NONZEROS_SPARSEMATRIX 16384
+#endif
+
 void
 addeval_sparsematrix_avector(field alpha, pcsparsematrix a,
 			     pcavector x, pavector y)
@@ -307,6 +426,11 @@ addeval_sparsematrix_avector(field alpha, pcsparsematrix a,
   xv = x->v;
   yv = y->v;
 
+  /* Rows are independent, so they can be handled in parallel */
+#ifdef USE_OPENMP
+#pragma omp parallel for private(j, sum) \
+  if(max_pardepth > 0 && row[rows] >= PARALLEL_NONZEROS_SPARSEMATRIX)
+#endif
   for (i = 0; i < rows; i++) {
     sum = 0.0;
     for (j = row[i]; j < row[i + 1]; j++)
@@ -420,7 +544,7 @@ add_sparsematrix_amatrix(field alpha, bool atrans, pcsparsematrix a,
     for (i = 0; i < rows; i++)
       for (k = row[i]; k < row[i + 1]; k++) {
 	j = col[k];
-	b->a[i + k * ldb] += alpha * coeff[k];
+	b->a[i + j * ldb] += alpha * coeff[k];
       }
   }
 }
@@ -81,6 +81,31 @@ new_raw_sparsematrix(uint rows, uint cols, uint nz);
 HEADER_PREFIX psparsematrix
 new_zero_sparsematrix(psparsepattern sp);
 
+/** @brief Create a sparsematrix from a list of entries in
+ *     coordinate format.
+ *
+ *  The entries are sorted by two stable counting sorts, first by
+ *  column and then by row, and entries appearing more than once
+ *  are summed.
+ *  In each row, the diagonal entry comes first, followed by all
+ *  other entries in ascending order of their columns, so that
+ *  @ref addentry_sparsematrix and @ref setentry_sparsematrix can
+ *  use a binary search.
+ *
+ *  @remark Should always be matched by a call to @ref del_sparsematrix.
+ *
+ *  @param rows Number of rows.
+ *  @param cols Number of columns.
+ *  @param n Number of entries in coordinate format.
+ *  @param ri Row indices of the entries, array of length @c n.
+ *  @param ci Column indices of the entries, array of length @c n.
+ *  @param x Values of the entries, array of length @c n.
+ *     If this is a null pointer, all coefficients are set to zero.
+ *  @returns Fully initialized @ref sparsematrix object. */
+HEADER_PREFIX psparsematrix
+new_coo_sparsematrix(uint rows, uint cols, uint n,
+		     const uint * ri, const uint * ci, pcfield x);
+
 /** @brief Delete a @ref sparsematrix object.
  *
  *  Releases the storage corresponding to the object.
@@ -141,6 +166,7 @@ getsize_sparsematrix(pcsparsematrix a);
  *
  *  Reorder the entries of each row in @c col and @c coeff to
  *  place the diagonal entry first.
+ *  The order of all other entries is preserved.
  *  Since many iterative solvers require us to handle this entry
  *  differently from all others, this optimization can improve
  *  the performance.
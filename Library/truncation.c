@@ -23,6 +23,8 @@ new_truncmode()
   tm->blocks = false;
   tm->zeta_level = 1.0;
   tm->zeta_age = 1.0;
+  tm->accumulate = false;
+  tm->randomized = false;
 
   return tm;
 }
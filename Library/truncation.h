@@ -52,6 +52,23 @@ struct _truncmode {
   real zeta_level;
   /** @brief Block-age-dependent tolerance factor */
   real zeta_age;
+
+  /** @brief If set to <tt>true</tt> low-rank updates of @ref hmatrix
+   *  "hmatrices" are accumulated and truncated only once before
+   *  the block is used in a triangular solve or multiplication,
+   *  or by @ref trunc_hmatrix. Saves most time in combination with
+   *  <tt>randomized</tt>, since the cost of an SVD grows quadratically
+   *  with the rank of the accumulated factors. */
+  bool accumulate;
+
+  /** @brief If set to <tt>true</tt> @ref rkmatrix "rkmatrices" are
+   *  truncated by a randomized range finder that samples the
+   *  matrix with random vectors until the estimated error is small
+   *  enough, followed by an SVD of the resulting small factorization,
+   *  instead of an SVD of the full-rank core.
+   *  Used by @ref trunc_rkmatrix, @ref add_rkmatrix and
+   *  @ref merge_rkmatrix. */
+  bool randomized;
 };
 
 /* ------------------------------------------------------------
@@ -14,12 +14,8 @@
    ------------------------------------------------------------ */
 
 puniform
-new_uniform(pclusterbasis rb, pclusterbasis cb)
+init_uniform(puniform u, pclusterbasis rb, pclusterbasis cb)
 {
-  puniform  u;
-
-  u = allocmem(sizeof(uniform));
-
   u->rb = u->cb = 0;
   u->rnext = u->rprev = u->cnext = u->cprev = 0;
 
@@ -32,7 +28,7 @@ new_uniform(pclusterbasis rb, pclusterbasis cb)
 }
 
 void
-del_uniform(puniform u)
+uninit_uniform(puniform u)
 {
   assert(u != 0);
 
@@ -40,6 +36,22 @@ del_uniform(puniform u)
 
   unref_row_uniform(u);
   unref_col_uniform(u);
+}
+
+puniform
+new_uniform(pclusterbasis rb, pclusterbasis cb)
+{
+  puniform  u;
+
+  u = allocmem(sizeof(uniform));
+
+  return init_uniform(u, rb, cb);
+}
+
+void
+del_uniform(puniform u)
+{
+  uninit_uniform(u);
 
   freemem(u);
 }
@@ -82,6 +82,31 @@ struct _uniform {
  Constructors and destructors
  ------------------------------------------------------------ */
 
+/** @brief Initialize a @ref _uniform "uniform" object.
+ *
+ *  Sets the @ref _clusterbasis "clusterbasis" pointers and sets up
+ *  the coupling matrix, but does not allocate storage for the
+ *  object itself.
+ *
+ *  @remark Should always be matched by a call to @ref uninit_uniform.
+ *
+ *  @param u Object to be initialized.
+ *  @param rb Row @ref _clusterbasis "clusterbasis"
+ *  @param cb Column @ref _clusterbasis "clusterbasis"
+ *  @returns Initialized @ref _uniform "uniform" object. */
+HEADER_PREFIX puniform
+init_uniform(puniform u, pclusterbasis rb, pclusterbasis cb);
+
+/** @brief Uninitialize a @ref _uniform "uniform" object.
+ *
+ *  Invalidates pointers, releases the coupling matrix and removes the
+ *  object from the block row and block column lists, but does not
+ *  release the storage of the object itself.
+ *
+ *  @param u Object to be uninitialized. */
+HEADER_PREFIX void
+uninit_uniform(puniform u);
+
 /**
  * @brief Create a new @ref _uniform "uniform" object.
  *
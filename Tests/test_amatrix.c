@@ -1,7 +1,10 @@
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "amatrix.h"
 #include "factorizations.h"
+#include "krylov.h"
+#include "sparsematrix.h"
 #include "settings.h"
 
 static uint problems = 0;
@@ -119,6 +122,394 @@ check_triangularsolve(bool lower, bool unit, bool atrans,
   uninit_avector(xv);
 }
 
+/* Compare addmul_amatrix for all combinations of transposed factors
+   to simple loops.  The target is a submatrix, so that its leading
+   dimension differs from its number of rows. */
+static void
+check_addmul(uint rows, uint mid, uint cols)
+{
+  amatrix   atmp, btmp, ctmp, dtmp, ttmp;
+  pamatrix  a, b, c, d, t;
+  field     sum, aval, bval;
+  real      error;
+  bool      atrans, btrans;
+  uint      i, j, l;
+
+  t = init_amatrix(&ttmp, rows + 3, cols);
+  random_amatrix(t);
+  c = init_sub_amatrix(&ctmp, t, rows, 1, cols, 0);
+  d = init_amatrix(&dtmp, rows, cols);
+
+  for (atrans = 0; atrans <= 1; atrans++)
+    for (btrans = 0; btrans <= 1; btrans++) {
+      a = (atrans ? init_amatrix(&atmp, mid, rows) :
+	   init_amatrix(&atmp, rows, mid));
+      b = (btrans ? init_amatrix(&btmp, cols, mid) :
+	   init_amatrix(&btmp, mid, cols));
+      random_amatrix(a);
+      random_amatrix(b);
+
+      for (j = 0; j < cols; j++)
+	for (i = 0; i < rows; i++) {
+	  sum = 0.0;
+	  for (l = 0; l < mid; l++) {
+	    aval = (atrans ? CONJ(a->a[l + i * a->ld]) : a->a[i + l * a->ld]);
+	    bval = (btrans ? CONJ(b->a[j + l * b->ld]) : b->a[l + j * b->ld]);
+	    sum += aval * bval;
+	  }
+	  d->a[i + j * d->ld] = c->a[i + j * c->ld] - 0.5 * sum;
+	}
+
+      addmul_amatrix(-0.5, atrans, a, btrans, b, c);
+
+      add_amatrix(-1.0, false, c, d);
+      error = normfrob_amatrix(d) / normfrob_amatrix(c);
+
+      (void) printf("Checking addmul_amatrix (%u x %u x %u, atrans=%s, "
+		    "btrans=%s)\n"
+		    "  Accuracy %g, %sokay\n", rows, mid, cols,
+		    (atrans ? "tr" : "fl"), (btrans ? "tr" : "fl"), error,
+		    (IS_IN_RANGE(0.0, error, 1.0e-14) ? "" : "    NOT "));
+      if (!IS_IN_RANGE(0.0, error, 1.0e-14))
+	problems++;
+
+      uninit_amatrix(b);
+      uninit_amatrix(a);
+    }
+
+  uninit_amatrix(d);
+  uninit_amatrix(c);
+  uninit_amatrix(t);
+}
+
+/* Compare addeval_amatrix_avector and addevaltrans_amatrix_avector
+   to simple loops.  The matrix is a submatrix, so that its leading
+   dimension differs from its number of rows. */
+static void
+check_addeval(uint rows, uint cols)
+{
+  amatrix   atmp, ttmp;
+  avector   xtmp, ytmp, dtmp;
+  pamatrix  a, t;
+  pavector  x, y, d;
+  field     sum;
+  real      error;
+  bool      atrans;
+  uint      i, j, xdim, ydim;
+
+  t = init_amatrix(&ttmp, rows + 3, cols);
+  random_amatrix(t);
+  a = init_sub_amatrix(&atmp, t, rows, 1, cols, 0);
+
+  for (atrans = 0; atrans <= 1; atrans++) {
+    xdim = (atrans ? rows : cols);
+    ydim = (atrans ? cols : rows);
+    x = init_avector(&xtmp, xdim);
+    y = init_avector(&ytmp, ydim);
+    d = init_avector(&dtmp, ydim);
+    random_avector(x);
+    random_avector(y);
+
+    for (i = 0; i < ydim; i++) {
+      sum = 0.0;
+      for (j = 0; j < xdim; j++)
+	sum += (atrans ? CONJ(a->a[j + i * a->ld]) : a->a[i + j * a->ld])
+	  * x->v[j];
+      d->v[i] = y->v[i] - 0.5 * sum;
+    }
+
+    mvm_amatrix_avector(-0.5, atrans, a, x, y);
+
+    add_avector(-1.0, y, d);
+    error = norm2_avector(d) / norm2_avector(y);
+
+    (void) printf("Checking addeval%s_amatrix_avector (%u x %u)\n"
+		  "  Accuracy %g, %sokay\n", (atrans ? "trans" : ""), rows,
+		  cols, error,
+		  (IS_IN_RANGE(0.0, error, 1.0e-14) ? "" : "    NOT "));
+    if (!IS_IN_RANGE(0.0, error, 1.0e-14))
+      problems++;
+
+    uninit_avector(d);
+    uninit_avector(y);
+    uninit_avector(x);
+  }
+
+  uninit_amatrix(a);
+  uninit_amatrix(t);
+}
+
+/* Check the blocked triangular solver with triangular factors of an
+   LR decomposition that are too large to be handled directly.
+   The unit triangular matrices are taken from L, the others from R,
+   to keep all of them well-conditioned. */
+static void
+check_large_triangularsolve(uint n)
+{
+  amatrix   atmp, ltmp, rtmp;
+  pamatrix  a, l, r;
+  bool      unit, atrans, xtrans;
+
+  a = init_amatrix(&atmp, n, n);
+  random_invertible_amatrix(a, 1.0);
+  lrdecomp_amatrix(a);
+
+  l = init_amatrix(&ltmp, n, n);
+  r = init_amatrix(&rtmp, n, n);
+
+  for (unit = 0; unit <= 1; unit++) {
+    if (unit) {
+      copy_lower_amatrix(a, true, l);
+      copy_amatrix(true, l, r);
+    }
+    else {
+      copy_upper_amatrix(a, false, r);
+      copy_amatrix(true, r, l);
+    }
+
+    for (atrans = 0; atrans <= 1; atrans++)
+      for (xtrans = 0; xtrans <= 1; xtrans++) {
+	check_triangularsolve(true, unit, atrans, l, xtrans);
+	check_triangularsolve(false, unit, atrans, r, xtrans);
+      }
+  }
+
+  /* bool is not restricted to 0 and 1 */
+  check_triangularsolve((bool) 2, false, true, l, false);
+  check_triangularsolve((bool) 2, false, false, l, true);
+
+  uninit_amatrix(r);
+  uninit_amatrix(l);
+  uninit_amatrix(a);
+}
+
+/* Check the structure of a matrix built by new_coo_sparsematrix:
+   diagonal first, then strictly ascending columns */
+static    bool
+check_rows_sparsematrix(pcsparsematrix a)
+{
+  uint      i, j, lo;
+
+  for (i = 0; i < a->rows; i++) {
+    lo = a->row[i];
+    if (lo < a->row[i + 1] && a->col[lo] == i)
+      lo++;
+    for (j = lo; j < a->row[i + 1]; j++)
+      if (a->col[j] == i || (j > lo && a->col[j - 1] >= a->col[j]))
+	return false;
+  }
+
+  return true;
+}
+
+/* Build a sparse matrix from unsorted coordinate triplets containing
+   duplicates and compare it to a dense matrix */
+static void
+check_coo_sparsematrix(uint rows, uint cols, uint n)
+{
+  psparsematrix a, a0;
+  amatrix   dtmp, ctmp;
+  pamatrix  d, c;
+  uint     *ri, *ci;
+  pfield    x;
+  uint      nz, i, j, k;
+  real      error;
+  bool      okay;
+
+  ri = allocuint(n);
+  ci = allocuint(n);
+  x = allocfield(n);
+
+  /* Few columns per row, so that many entries appear repeatedly */
+  for (k = 0; k < n; k++) {
+    ri[k] = rand() % rows;
+    ci[k] = (ri[k] + rand() % 5) % cols;
+    x[k] = 2.0 * rand() / RAND_MAX - 1.0;
+  }
+
+  d = init_zero_amatrix(&dtmp, rows, cols);
+  for (k = 0; k < n; k++)
+    d->a[ri[k] + ci[k] * d->ld] += x[k];
+
+  c = init_zero_amatrix(&ctmp, rows, cols);
+  for (k = 0; k < n; k++)
+    c->a[ri[k] + ci[k] * c->ld] = 1.0;
+  nz = 0;
+  for (j = 0; j < cols; j++)
+    for (i = 0; i < rows; i++)
+      if (c->a[i + j * c->ld] != 0.0)
+	nz++;
+
+  a = new_coo_sparsematrix(rows, cols, n, ri, ci, x);
+  a0 = new_coo_sparsematrix(rows, cols, n, ri, ci, NULL);
+
+  okay = (a->nz == nz && check_rows_sparsematrix(a));
+  (void) printf("Checking new_coo_sparsematrix (%u x %u, %u entries)\n"
+		"  %u distinct entries, expected %u, %sokay\n", rows, cols,
+		n, a->nz, nz, (okay ? "" : "    NOT "));
+  if (!okay)
+    problems++;
+
+  clear_amatrix(c);
+  add_sparsematrix_amatrix(1.0, false, a, c);
+  add_amatrix(-1.0, false, d, c);
+  error = normfrob_amatrix(c) / normfrob_amatrix(d);
+  (void) printf("  Accuracy %g, %sokay\n", error,
+		(IS_IN_RANGE(0.0, error, 1.0e-15) ? "" : "    NOT "));
+  if (!IS_IN_RANGE(0.0, error, 1.0e-15))
+    problems++;
+
+  okay = (a0->nz == a->nz);
+  for (k = 0; okay && k <= rows; k++)
+    okay = (a0->row[k] == a->row[k]);
+  for (k = 0; okay && k < a->nz; k++)
+    okay = (a0->col[k] == a->col[k] && a0->coeff[k] == 0.0);
+  (void) printf("  Pattern without coefficients %sokay\n",
+		(okay ? "" : "    NOT "));
+  if (!okay)
+    problems++;
+
+  del_sparsematrix(a0);
+  del_sparsematrix(a);
+  uninit_amatrix(c);
+  uninit_amatrix(d);
+  freemem(x);
+  freemem(ci);
+  freemem(ri);
+}
+
+/* Compare the positions found by addentry_sparsematrix to a linear
+   search, both for sorted rows and for rows of a raw matrix in
+   arbitrary order */
+static void
+check_findentry_sparsematrix(uint rows, uint cols)
+{
+  psparsematrix a;
+  uint     *ri, *ci;
+  uint      n, i, j, k, h;
+  bool      okay, sorted;
+
+  n = 8 * rows;
+  ri = allocuint(n);
+  ci = allocuint(n);
+  for (k = 0; k < n; k++) {
+    ri[k] = k / 8;
+    ci[k] = (ri[k] + 3 * (k % 8)) % cols;
+  }
+
+  for (sorted = 0; sorted <= 1; sorted++) {
+    a = new_coo_sparsematrix(rows, cols, n, ri, ci, NULL);
+
+    if (!sorted) {
+      /* Reverse the order within each row, so that the columns
+         are descending and the diagonal entry comes last */
+      for (i = 0; i < rows; i++)
+	for (j = a->row[i], k = a->row[i + 1]; j + 1 < k; j++, k--) {
+	  h = a->col[j];
+	  a->col[j] = a->col[k - 1];
+	  a->col[k - 1] = h;
+	}
+    }
+
+    okay = true;
+    for (i = 0; i < rows; i++)
+      for (j = a->row[i]; j < a->row[i + 1]; j++) {
+	setentry_sparsematrix(a, i, a->col[j], 0.0);
+	(void) addentry_sparsematrix(a, i, a->col[j], (field) (j + 1));
+      }
+    for (k = 0; k < a->nz; k++)
+      if (a->coeff[k] != (field) (k + 1))
+	okay = false;
+
+    (void) printf("Checking addentry_sparsematrix (%s rows)\n"
+		  "  Positions %sokay\n", (sorted ? "sorted" : "raw"),
+		  (okay ? "" : "    NOT "));
+    if (!okay)
+      problems++;
+
+    del_sparsematrix(a);
+  }
+
+  freemem(ci);
+  freemem(ri);
+}
+
+/* Compare the sparse matrix-vector products, with and without
+   parallelization, to the dense product */
+static void
+check_addeval_sparsematrix(uint rows, uint cols)
+{
+  psparsematrix a;
+  amatrix   dtmp;
+  pamatrix  d;
+  avector   xtmp, ytmp, ztmp, wtmp;
+  pavector  x, y, z, w;
+  uint     *ri, *ci;
+  pfield    v;
+  uint      pardepth, n, k;
+  real      error, error2;
+  bool      trans;
+
+  n = 10 * rows;
+  ri = allocuint(n);
+  ci = allocuint(n);
+  v = allocfield(n);
+  for (k = 0; k < n; k++) {
+    ri[k] = rand() % rows;
+    ci[k] = rand() % cols;
+    v[k] = 2.0 * rand() / RAND_MAX - 1.0;
+  }
+  a = new_coo_sparsematrix(rows, cols, n, ri, ci, v);
+
+  d = init_zero_amatrix(&dtmp, rows, cols);
+  add_sparsematrix_amatrix(1.0, false, a, d);
+
+  pardepth = max_pardepth;
+
+  for (trans = 0; trans <= 1; trans++) {
+    x = init_avector(&xtmp, (trans ? rows : cols));
+    y = init_avector(&ytmp, (trans ? cols : rows));
+    z = init_avector(&ztmp, (trans ? cols : rows));
+    w = init_avector(&wtmp, (trans ? cols : rows));
+    random_avector(x);
+    random_avector(y);
+    copy_avector(y, z);
+    copy_avector(y, w);
+
+    mvm_amatrix_avector(2.0, trans, d, x, y);
+
+    max_pardepth = (pardepth > 0 ? pardepth : 1);
+    mvm_sparsematrix_avector(2.0, trans, a, x, z);
+    max_pardepth = 0;
+    mvm_sparsematrix_avector(2.0, trans, a, x, w);
+    max_pardepth = pardepth;
+
+    add_avector(-1.0, z, w);
+    error2 = norm2_avector(w);
+    add_avector(-1.0, y, z);
+    error = norm2_avector(z) / norm2_avector(y);
+
+    (void) printf("Checking mvm_sparsematrix_avector (%u x %u, trans=%s)\n"
+		  "  Accuracy %g, sequential difference %g, %sokay\n", rows,
+		  cols, (trans ? "tr" : "fl"), error, error2,
+		  (IS_IN_RANGE(0.0, error, 1.0e-14)
+		   && error2 == 0.0 ? "" : "    NOT "));
+    if (!(IS_IN_RANGE(0.0, error, 1.0e-14) && error2 == 0.0))
+      problems++;
+
+    uninit_avector(w);
+    uninit_avector(z);
+    uninit_avector(y);
+    uninit_avector(x);
+  }
+
+  uninit_amatrix(d);
+  del_sparsematrix(a);
+  freemem(v);
+  freemem(ci);
+  freemem(ri);
+}
+
 static void
 check_lowereval(bool unit, bool atrans, pcamatrix a, bool xtrans)
 {
@@ -343,6 +734,202 @@ set_unit(pamatrix R)
   }
 }
 
+static void
+check_cgs2gmres(uint n, uint kmax)
+{
+  pamatrix  a, qb, hess, qr;
+  pavector  b, x1, x2, rhat, q, tau, r;
+  uint      i, k, steps;
+  real      error;
+
+  a = new_amatrix(n, n);
+  random_amatrix(a);
+  for (i = 0; i < n; i++)
+    a->a[i + i * a->ld] += n;
+
+  b = new_avector(n);
+  random_avector(b);
+  x1 = new_avector(n);
+  clear_avector(x1);
+  x2 = new_avector(n);
+  clear_avector(x2);
+  rhat = new_avector(kmax + 1);
+  r = new_avector(n);
+
+  /* GMRES with Householder reflections */
+  q = new_avector(n);
+  tau = new_avector(n);
+  qr = new_amatrix(n, kmax + 1);
+  init_gmres((addeval_t) addeval_amatrix_avector, a, b, x1, r, q, &k,
+	     qr, tau);
+  for (steps = 0; steps < 4 * kmax && ABS(r->v[k]) > 1e-14; steps++) {
+    if (k + 1 >= kmax)
+      finish_gmres((addeval_t) addeval_amatrix_avector, a, b, x1, r, q,
+		   &k, qr, tau);
+    step_gmres((addeval_t) addeval_amatrix_avector, a, b, x1, r, q, &k,
+	       qr, tau);
+  }
+  finish_gmres((addeval_t) addeval_amatrix_avector, a, b, x1, r, q, &k,
+	       qr, tau);
+
+  /* GMRES with classical Gram-Schmidt and reorthogonalization */
+  qb = new_amatrix(n, kmax + 1);
+  hess = new_amatrix(kmax + 1, kmax);
+  init_cgs2gmres((addeval_t) addeval_amatrix_avector, a, b, x2, rhat, &k,
+		 qb, hess);
+  for (steps = 0; steps < 4 * kmax && ABS(rhat->v[k]) > 1e-14; steps++) {
+    if (k + 1 >= kmax)
+      finish_cgs2gmres((addeval_t) addeval_amatrix_avector, a, b, x2, rhat,
+		       &k, qb, hess);
+    step_cgs2gmres((addeval_t) addeval_amatrix_avector, a, b, x2, rhat, &k,
+		   qb, hess);
+  }
+  finish_cgs2gmres((addeval_t) addeval_amatrix_avector, a, b, x2, rhat, &k,
+		   qb, hess);
+
+  (void) printf("Checking CGS2 GMRES\n");
+  copy_avector(b, r);
+  addeval_amatrix_avector(-1.0, a, x2, r);
+  error = norm2_avector(r) / norm2_avector(b);
+  (void) printf("  Residual %.2e, %sokay\n", error,
+		(error < tolerance ? "" : "    NOT "));
+  if (error >= tolerance)
+    problems++;
+
+  add_avector(-1.0, x1, x2);
+  error = norm2_avector(x2) / norm2_avector(x1);
+  (void) printf("  Difference to Householder GMRES %.2e, %sokay\n", error,
+		(error < tolerance ? "" : "    NOT "));
+  if (error >= tolerance)
+    problems++;
+
+  del_amatrix(hess);
+  del_amatrix(qb);
+  del_amatrix(qr);
+  del_avector(tau);
+  del_avector(q);
+  del_avector(r);
+  del_avector(rhat);
+  del_avector(x2);
+  del_avector(x1);
+  del_avector(b);
+  del_amatrix(a);
+}
+
+static void
+check_solver(const char *name, pcamatrix a, pcavector b, pcavector x,
+	     pckrylovinfo info)
+{
+  pavector  r;
+  real      error;
+
+  r = new_avector(b->dim);
+  copy_avector(b, r);
+  addeval_amatrix_avector(-1.0, a, x, r);
+  error = norm2_avector(r) / norm2_avector(b);
+  del_avector(r);
+
+  (void) printf("Checking %s, %u steps\n"
+		"  Residual %.2e, %sokay\n", name, info->steps, error,
+		(error < 1e-10 && info->converged ? "" : "    NOT "));
+  if (error >= 1e-10 || !info->converged)
+    problems++;
+}
+
+static void
+addevalmat_amatrix(field alpha, void *a, pcamatrix x, pamatrix y)
+{
+  addmul_amatrix(alpha, false, (pcamatrix) a, false, x, y);
+}
+
+static void
+check_blocksolver(const char *name, pcamatrix a, pcamatrix b, pcamatrix x,
+		  pckrylovinfo info)
+{
+  pamatrix  r;
+  real      error;
+
+  r = new_amatrix(b->rows, b->cols);
+  copy_amatrix(false, b, r);
+  addmul_amatrix(-1.0, false, a, false, x, r);
+  error = normfrob_amatrix(r) / normfrob_amatrix(b);
+  del_amatrix(r);
+
+  (void) printf("Checking %s, %u steps\n"
+		"  Residual %.2e, %sokay\n", name, info->steps, error,
+		(error < 1e-10 && info->converged ? "" : "    NOT "));
+  if (error >= 1e-10 || !info->converged)
+    problems++;
+}
+
+static void
+check_solvers(uint n)
+{
+  pamatrix  a, l, bm, xm;
+  pavector  b, x;
+  pkrylovinfo info;
+  uint      i;
+
+  /* Symmetric positive definite matrix */
+  l = new_amatrix(n, n);
+  random_amatrix(l);
+  a = new_identity_amatrix(n, n);
+  scale_amatrix(n, a);
+  addmul_amatrix(1.0, false, l, true, l, a);
+
+  b = new_avector(n);
+  random_avector(b);
+  x = new_avector(n);
+  bm = new_amatrix(n, 4);
+  random_amatrix(bm);
+  xm = new_amatrix(n, 4);
+  info = new_krylovinfo(4 * n);
+
+  clear_avector(x);
+  solve_cg((addeval_t) addeval_amatrix_avector, a, NULL, NULL, b, x,
+	   1e-12, 4 * n, info);
+  check_solver("solve_cg", a, b, x, info);
+
+  clear_avector(x);
+  solve_gmres((addeval_t) addeval_amatrix_avector, a, NULL, NULL, b, x,
+	      1e-12, 4 * n, 10, info);
+  check_solver("solve_gmres", a, b, x, info);
+
+  clear_amatrix(xm);
+  solve_blockcg(addevalmat_amatrix, a, bm, xm, 1e-12, 4 * n, info);
+  check_blocksolver("solve_blockcg", a, bm, xm, info);
+
+  /* Make the matrix non-symmetric */
+  for (i = 0; i + 1 < n; i++)
+    a->a[i + (i + 1) * a->ld] += 0.5 * n;
+
+  clear_avector(x);
+  solve_gmres((addeval_t) addeval_amatrix_avector, a, NULL, NULL, b, x,
+	      1e-12, 4 * n, 10, info);
+  check_solver("solve_gmres, non-symmetric", a, b, x, info);
+
+  clear_avector(x);
+  solve_bicgstab((addeval_t) addeval_amatrix_avector, a, b, x,
+		 1e-12, 4 * n, info);
+  check_solver("solve_bicgstab, non-symmetric", a, b, x, info);
+
+  clear_amatrix(xm);
+  solve_blockgmres(addevalmat_amatrix, a, bm, xm, 1e-12, 4 * n, 5, info);
+  check_blocksolver("solve_blockgmres, non-symmetric", a, bm, xm, info);
+
+  (void) printf("  Timings of last solver: %.2e total, %.2e matrix, "
+		"%.2e orthogonalization, %.2e other\n", info->t_total,
+		info->t_mvm, info->t_ortho, info->t_other);
+
+  del_krylovinfo(info);
+  del_amatrix(xm);
+  del_amatrix(bm);
+  del_avector(x);
+  del_avector(b);
+  del_amatrix(a);
+  del_amatrix(l);
+}
+
 int
 main()
 {
@@ -703,6 +1290,34 @@ main()
   del_amatrix(acopy);
   del_amatrix(a);
 
+  /* Check blocked matrix multiplication and triangular solves above
+     the sizes handled by simple loops */
+  (void) printf("----------------------------------------\n");
+  check_addmul(37, 29, 31);
+  check_addmul(64, 64, 64);
+  check_addmul(261, 301, 70);
+  check_addmul(9, 4, 2100);
+  check_addeval(37, 29);
+  check_addeval(64, 64);
+  check_addeval(301, 70);
+  check_large_triangularsolve(150);
+  check_large_triangularsolve(67);
+
+  /* Check sparse matrices */
+  (void) printf("----------------------------------------\n");
+  check_coo_sparsematrix(40, 40, 400);
+  check_coo_sparsematrix(37, 53, 300);
+  check_coo_sparsematrix(53, 37, 300);
+  check_findentry_sparsematrix(40, 40);
+  check_findentry_sparsematrix(30, 50);
+  check_addeval_sparsematrix(2000, 2000);
+  check_addeval_sparsematrix(1500, 700);
+
+  /* Check GMRES variants */
+  (void) printf("----------------------------------------\n");
+  check_cgs2gmres(100, 10);
+  check_solvers(100);
+
   (void) printf("----------------------------------------\n"
 		"  %u matrices and\n"
 		"  %u vectors still active\n"
@@ -34,6 +34,7 @@ main(int argc, char **argv)
   pclusterbasis rbf, cbf;	/* Adaptive cluster bases */
   ph2matrix G5;			/* H^2-matrix from dense matrix */
   ph2matrix G6;			/* H^2-matrix from hierarchical compression */
+  ph2matrix G7;			/* H^2-matrix from randomized compression */
   pavector  x, y;		/* Vectors for testing */
   pstopwatch sw;		/* Measure runtime */
   real      t_run;		/* Runtime */
@@ -436,6 +437,30 @@ main(int argc, char **argv)
 		  IS_IN_RANGE(6.0e-9, error, 6.0e-8) ? "       " : "   NOT ");
     if (!IS_IN_RANGE(6.0e-9, error, 6.0e-8))
       problems++;
+
+    (void) printf("----------------------------------------\n"
+		  "Building randomized cluster bases for dense matrix\n");
+
+    tm->randomized = true;
+    start_stopwatch(sw);
+    rbf = buildrowbasis_amatrix(G, broot, tm, eps);
+    cbf = buildcolbasis_amatrix(G, broot, tm, eps);
+    t_run = stop_stopwatch(sw);
+    tm->randomized = false;
+
+    (void) printf("  %.2f seconds\n"
+		  "  Rank sums %u and %u\n", t_run, rbf->ktree, cbf->ktree);
+
+    G7 = build_projected_amatrix_h2matrix(G, broot, rbf, cbf);
+
+    (void) printf("Rel. spectral error bound by power iteration\n");
+    error = norm2diff_amatrix_h2matrix(G7, G) / normG;
+    (void) printf("  %.4e                                %s okay\n", error,
+		  IS_IN_RANGE(6.0e-9, error, 6.0e-8) ? "       " : "   NOT ");
+    if (!IS_IN_RANGE(6.0e-9, error, 6.0e-8))
+      problems++;
+
+    del_h2matrix(G7);
   }
 
   (void) printf("========================================\n" "Cleaning up\n");
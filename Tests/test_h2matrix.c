@@ -3,6 +3,7 @@
 #include "hmatrix.h"
 #include "harith.h"
 #include "h2matrix.h"
+#include "binfile.h"
 #include "h2arith.h"
 #include "truncation.h"
 
@@ -16,6 +17,207 @@ static uint problems = 0;
 
 #define IS_IN_RANGE(a, b, c) (((a) < (b)) && ((b) < (c)))
 
+static void
+check_binfile(pch2matrix a)
+{
+  pbinfile  bf;
+  avector   xtmp, ytmp, ztmp;
+  pavector  x, y, z;
+  real      error;
+
+  write_binfile_h2matrix(a, "test_h2matrix.bin");
+  bf = read_binfile("test_h2matrix.bin");
+  assert(bf != NULL && bf->h2 != NULL);
+
+  x = init_avector(&xtmp, a->cb->t->size);
+  y = init_avector(&ytmp, a->rb->t->size);
+  z = init_avector(&ztmp, a->rb->t->size);
+  random_avector(x);
+
+  clear_avector(y);
+  addeval_h2matrix_avector(1.0, a, x, y);
+  clear_avector(z);
+  addeval_h2matrix_avector(1.0, bf->h2, x, z);
+  add_avector(-1.0, y, z);
+  error = norm2_avector(z);
+  (void) printf("Checking read_binfile for h2matrix\n"
+		"  Difference %g, %sokay\n", error,
+		(error == 0.0 ? "" : "    NOT "));
+  if (error != 0.0)
+    problems++;
+
+  uninit_avector(z);
+  uninit_avector(y);
+  uninit_avector(x);
+
+  del_binfile(bf);
+  (void) remove("test_h2matrix.bin");
+}
+
+static void
+check_arena(pch2matrix a, pbem2d bem2, pblock b)
+{
+  ph2matrix c;
+  pclusterbasis rb, cb;
+  avector   xtmp, ytmp, ztmp;
+  pavector  x, y, z;
+  uint      amatrices, bases;
+  real      error;
+
+  amatrices = getactives_amatrix();
+  bases = getactives_clusterbasis();
+
+  rb = build_from_cluster_arena_clusterbasis(a->rb->t);
+  cb = build_from_cluster_arena_clusterbasis(a->cb->t);
+  assemble_bem2d_h2matrix_row_clusterbasis(bem2, rb);
+  assemble_bem2d_h2matrix_col_clusterbasis(bem2, cb);
+
+  c = build_from_block_arena_h2matrix(b, rb, cb);
+  assemble_bem2d_h2matrix(bem2, b, c);
+
+  x = init_avector(&xtmp, a->cb->t->size);
+  y = init_avector(&ytmp, a->rb->t->size);
+  z = init_avector(&ztmp, a->rb->t->size);
+  random_avector(x);
+
+  clear_avector(y);
+  addeval_h2matrix_avector(1.0, a, x, y);
+  clear_avector(z);
+  addeval_h2matrix_avector(1.0, c, x, z);
+  add_avector(-1.0, y, z);
+  error = norm2_avector(z) / norm2_avector(y);
+  (void) printf("Checking build_from_block_arena_h2matrix\n"
+		"  Accuracy %g, %sokay\n", error,
+		(error <= 1.0e-14 ? "" : "    NOT "));
+  if (error > 1.0e-14)
+    problems++;
+
+  uninit_avector(z);
+  uninit_avector(y);
+  uninit_avector(x);
+
+  del_h2matrix(c);
+
+  (void) printf("  Active objects after deletion: %u matrices, "
+		"%u cluster bases, %sokay\n", getactives_amatrix() - amatrices,
+		getactives_clusterbasis() - bases,
+		(getactives_amatrix() == amatrices
+		 && getactives_clusterbasis() == bases ? "" : "    NOT "));
+  if (getactives_amatrix() != amatrices
+      || getactives_clusterbasis() != bases)
+    problems++;
+}
+
+static void
+check_parallel_mvm(pch2matrix a)
+{
+  avector   xtmp, ytmp, ztmp;
+  pavector  x, y, z;
+  pstopwatch sw;
+  real      error, t, t0;
+  uint      pardepth, i;
+
+  x = init_avector(&xtmp, a->cb->t->size);
+  y = init_avector(&ytmp, a->rb->t->size);
+  z = init_avector(&ztmp, a->rb->t->size);
+  random_avector(x);
+
+  sw = new_stopwatch();
+  t0 = 0.0;
+
+  for (pardepth = 0; pardepth <= 4; pardepth++) {
+    random_avector(y);
+    copy_avector(y, z);
+
+    addeval_h2matrix_avector(0.75, (ph2matrix) a, x, y);
+    addeval_parallel_h2matrix_avector(0.75, (ph2matrix) a, x, z, pardepth);
+
+    add_avector(-1.0, y, z);
+    error = norm2_avector(z);
+    (void) printf("Checking addeval_parallel_h2matrix_avector"
+		  " (pardepth=%u)\n"
+		  "  Difference %g, %sokay\n", pardepth, error,
+		  (error == 0.0 ? "" : "    NOT "));
+    if (error != 0.0)
+      problems++;
+
+    random_avector(y);
+    copy_avector(y, z);
+
+    addevaltrans_h2matrix_avector(0.75, (ph2matrix) a, x, y);
+    addevaltrans_parallel_h2matrix_avector(0.75, (ph2matrix) a, x, z,
+					   pardepth);
+
+    add_avector(-1.0, y, z);
+    error = norm2_avector(z);
+    (void) printf("Checking addevaltrans_parallel_h2matrix_avector"
+		  " (pardepth=%u)\n"
+		  "  Difference %g, %sokay\n", pardepth, error,
+		  (error == 0.0 ? "" : "    NOT "));
+    if (error != 0.0)
+      problems++;
+
+    /* Strong scaling: same matrix, increasing number of threads */
+    start_stopwatch(sw);
+    for (i = 0; i < 20; i++)
+      addeval_parallel_h2matrix_avector(1.0, (ph2matrix) a, x, y, pardepth);
+    t = stop_stopwatch(sw) / 20;
+    if (pardepth == 0)
+      t0 = t;
+    (void) printf("  %.2e seconds per MVM, speedup %.2f\n", t,
+		  (t > 0.0 ? t0 / t : 0.0));
+  }
+
+  del_stopwatch(sw);
+
+  uninit_avector(z);
+  uninit_avector(y);
+  uninit_avector(x);
+}
+
+static void
+check_block_mvm(pch2matrix a, bool atrans)
+{
+  amatrix   Xtmp, Ytmp, Ztmp;
+  pamatrix  X, Y, Z;
+  avector   xtmp, ytmp;
+  pavector  x, y;
+  uint      rows, cols, m, j;
+  real      error;
+
+  rows = (atrans ? a->cb->t->size : a->rb->t->size);
+  cols = (atrans ? a->rb->t->size : a->cb->t->size);
+  m = 7;
+
+  X = init_amatrix(&Xtmp, cols, m);
+  random_amatrix(X);
+  Y = init_zero_amatrix(&Ytmp, rows, m);
+  Z = init_zero_amatrix(&Ztmp, rows, m);
+
+  /* Reference result, computed column by column */
+  for (j = 0; j < m; j++) {
+    x = init_column_avector(&xtmp, X, j);
+    y = init_column_avector(&ytmp, Z, j);
+    mvm_h2matrix_avector(0.5, atrans, a, x, y);
+    uninit_avector(y);
+    uninit_avector(x);
+  }
+
+  mvm_h2matrix_amatrix(0.5, atrans, a, X, Y);
+
+  add_amatrix(-1.0, false, Z, Y);
+  error = normfrob_amatrix(Y) / normfrob_amatrix(Z);
+  (void) printf("Checking mvm_h2matrix_amatrix (atrans=%s)\n"
+		"  Accuracy %g, %sokay\n", (atrans ? "tr" : "fl"), error,
+		(IS_IN_RANGE(0.0, error, 1.0e-14) ? "" : "    NOT "));
+  if (!IS_IN_RANGE(0.0, error, 1.0e-14))
+    problems++;
+
+  uninit_amatrix(Z);
+  uninit_amatrix(Y);
+  uninit_amatrix(X);
+}
+
 int
 main()
 {
@@ -69,6 +271,15 @@ main()
   clear_avector(b);
   mvm_h2matrix_avector(1.0, false, h2, x, b);
 
+  check_block_mvm(h2, false);
+  check_block_mvm(h2, true);
+
+  check_parallel_mvm(h2);
+
+  check_arena(h2, bem2, block2);
+
+  check_binfile(h2);
+
   (void) printf("Copying matrix\n");
 
   rbcopy = clone_clusterbasis(h2->rb);
@@ -1,7 +1,12 @@
 #include <stdio.h>
+#include <string.h>
 #include "settings.h"
 #include "hmatrix.h"
 #include "harith.h"
+#include "hcoarsen.h"
+#include "flathmatrix.h"
+#include "binfile.h"
+#include "clustergeometry.h"
 
 #include "laplacebem2d.h"
 
@@ -32,6 +37,854 @@ check_addhmatrix(phmatrix a, real tol)
   del_hmatrix(acopy);
 }
 
+static void
+check_parallel_mvm(pchmatrix a)
+{
+  avector   xtmp, ytmp, ztmp;
+  pavector  x, y, z;
+  real      error;
+  uint      pardepth;
+
+  x = init_avector(&xtmp, a->cc->size);
+  y = init_avector(&ytmp, a->rc->size);
+  z = init_avector(&ztmp, a->rc->size);
+  random_avector(x);
+
+  for (pardepth = 1; pardepth <= 4; pardepth++) {
+    random_avector(y);
+    copy_avector(y, z);
+
+    fastaddeval_hmatrix_avector(0.75, a, x, y);
+    fastaddeval_parallel_hmatrix_avector(0.75, a, x, z, pardepth);
+
+    add_avector(-1.0, y, z);
+    error = norm2_avector(z);
+    (void) printf("Checking fastaddeval_parallel_hmatrix_avector"
+		  " (pardepth=%u)\n"
+		  "  Difference %g, %sokay\n", pardepth, error,
+		  (error == 0.0 ? "" : "    NOT "));
+    if (error != 0.0)
+      problems++;
+
+    random_avector(y);
+    copy_avector(y, z);
+
+    fastaddevaltrans_hmatrix_avector(0.75, a, x, y);
+    fastaddevaltrans_parallel_hmatrix_avector(0.75, a, x, z, pardepth);
+
+    add_avector(-1.0, y, z);
+    error = norm2_avector(z);
+    (void) printf("Checking fastaddevaltrans_parallel_hmatrix_avector"
+		  " (pardepth=%u)\n"
+		  "  Difference %g, %sokay\n", pardepth, error,
+		  (error == 0.0 ? "" : "    NOT "));
+    if (error != 0.0)
+      problems++;
+  }
+
+  uninit_avector(z);
+  uninit_avector(y);
+  uninit_avector(x);
+}
+
+static    bool
+compare_cluster(pccluster t1, pccluster t2, uint * mark, uint * leaves)
+{
+  bool      equal;
+  uint      i;
+
+  if (t1->size != t2->size || t1->sons != t2->sons)
+    return false;
+
+  for (i = 0; i < t1->dim; i++)
+    if (t1->bmin[i] != t2->bmin[i] || t1->bmax[i] != t2->bmax[i])
+      return false;
+
+  equal = true;
+  if (t1->sons > 0) {
+    for (i = 0; i < t1->sons && equal; i++)
+      equal = compare_cluster(t1->son[i], t2->son[i], mark, leaves);
+  }
+  else {
+    /* leaves have to contain the same indices */
+    (*leaves)++;
+    for (i = 0; i < t1->size; i++)
+      mark[t1->idx[i]] = *leaves;
+    for (i = 0; i < t2->size && equal; i++)
+      equal = (mark[t2->idx[i]] == *leaves);
+  }
+
+  return equal;
+}
+
+static void
+check_parallel_cluster(uint n, clustermode mode, const char *name)
+{
+  pclustergeometry cf;
+  pcluster  t1, t2;
+  uint     *idx1, *idx2, *mark;
+  uint      i, j, leaves;
+  bool      equal;
+
+  cf = new_clustergeometry(3, n);
+  idx1 = allocuint(n);
+  idx2 = allocuint(n);
+  mark = allocuint(n);
+  for (i = 0; i < n; i++) {
+    for (j = 0; j < 3; j++) {
+      cf->x[i][j] = (real) rand() / RAND_MAX;
+      cf->smin[i][j] = cf->x[i][j];
+      cf->smax[i][j] = cf->x[i][j];
+    }
+    cf->w[i] = 1.0;
+    idx1[i] = idx2[i] = i;
+  }
+
+  t1 = build_cluster(cf, n, idx1, 32, mode);
+  t2 = build_parallel_cluster(cf, n, idx2, 32, mode, 4);
+
+  leaves = 0;
+  equal = compare_cluster(t1, t2, mark, &leaves);
+  (void) printf("Checking build_parallel_cluster, %s, %u indices\n"
+		"  %u clusters, %sokay\n", name, n, t2->desc,
+		(equal ? "" : "    NOT "));
+  if (!equal)
+    problems++;
+
+  del_cluster(t2);
+  del_cluster(t1);
+  freemem(mark);
+  freemem(idx2);
+  freemem(idx1);
+  del_clustergeometry(cf);
+}
+
+static    bool
+check_cluster_geometry(pccluster t, pclustergeometry cf, uint clf)
+{
+  uint      i, j, off;
+
+  for (i = 0; i < t->size; i++)
+    for (j = 0; j < t->dim; j++)
+      if (cf->x[t->idx[i]][j] < t->bmin[j]
+	  || cf->x[t->idx[i]][j] > t->bmax[j])
+	return false;
+
+  if (t->sons == 0)
+    return (t->size <= clf);
+
+  off = 0;
+  for (i = 0; i < t->sons; i++) {
+    if (t->son[i]->idx != t->idx + off
+	|| !check_cluster_geometry(t->son[i], cf, clf))
+      return false;
+    off += t->son[i]->size;
+  }
+
+  return (off == t->size);
+}
+
+static void
+check_morton_cluster(uint n)
+{
+  pclustergeometry cf;
+  pcluster  t;
+  uint     *idx, *mark;
+  uint      i, j;
+  bool      okay;
+
+  cf = new_clustergeometry(3, n);
+  idx = allocuint(n);
+  mark = allocuint(n);
+  for (i = 0; i < n; i++) {
+    for (j = 0; j < 3; j++) {
+      cf->x[i][j] = (real) rand() / RAND_MAX;
+      cf->smin[i][j] = cf->x[i][j];
+      cf->smax[i][j] = cf->x[i][j];
+    }
+    cf->w[i] = 1.0;
+    idx[i] = i;
+    mark[i] = 0;
+  }
+
+  t = build_cluster(cf, n, idx, 32, H2_MORTON);
+
+  /* idx has to be a permutation, clusters have to be consistent */
+  okay = check_cluster_geometry(t, cf, 32);
+  for (i = 0; i < n; i++)
+    mark[idx[i]]++;
+  for (i = 0; i < n; i++)
+    okay = okay && (mark[i] == 1);
+
+  (void) printf("Checking build_morton_cluster, %u indices\n"
+		"  %u clusters, %sokay\n", n, t->desc,
+		(okay ? "" : "    NOT "));
+  if (!okay)
+    problems++;
+
+  del_cluster(t);
+  freemem(mark);
+  freemem(idx);
+  del_clustergeometry(cf);
+}
+
+static    bool
+compare_block(pcblock b1, pcblock b2)
+{
+  uint      i;
+
+  if (b1->rc != b2->rc || b1->cc != b2->cc || b1->a != b2->a
+      || b1->rsons != b2->rsons || b1->csons != b2->csons
+      || b1->desc != b2->desc)
+    return false;
+
+  for (i = 0; i < b1->rsons * b1->csons; i++)
+    if (!compare_block(b1->son[i], b2->son[i]))
+      return false;
+
+  return true;
+}
+
+static void
+check_parallel_block(pcluster root, real eta)
+{
+  const char *name[] = { "2", "max", "sphere" };
+  admissible admis[3];
+  pblock    b1, b2;
+  bool      equal;
+  uint      i;
+
+  admis[0] = admissible_2_cluster;
+  admis[1] = admissible_max_cluster;
+  admis[2] = admissible_sphere_cluster;
+
+  for (i = 0; i < 3; i++) {
+    b1 = build_nonstrict_block(root, root, &eta, admis[i]);
+    b2 = build_parallel_nonstrict_block(root, root, &eta, admis[i], 4);
+    equal = compare_block(b1, b2);
+    del_block(b2);
+    del_block(b1);
+
+    b1 = build_strict_block(root, root, &eta, admis[i]);
+    b2 = build_parallel_strict_block(root, root, &eta, admis[i], 4);
+    equal = equal && compare_block(b1, b2);
+
+    (void) printf("Checking build_parallel_*_block, admissible_%s_cluster\n"
+		  "  %u blocks, %sokay\n", name[i], b2->desc,
+		  (equal ? "" : "    NOT "));
+    if (!equal)
+      problems++;
+
+    del_block(b2);
+    del_block(b1);
+  }
+}
+
+static void
+record_names_block(pcblock b, uint bname, uint rname, uint cname,
+		   uint pardepth, void *data)
+{
+  uint     *names = (uint *) data;
+
+  (void) b;
+  (void) pardepth;
+
+  names[2 * bname] = rname;
+  names[2 * bname + 1] = cname;
+}
+
+static void
+count_rowlist_flatblock(pcflatblock fb, uint rname, const uint * blk,
+			uint n, void *data)
+{
+  uint     *cnt = (uint *) data;
+  uint      i;
+
+  for (i = 0; i < n; i++)
+    if (fb->rname[blk[i]] == rname)
+      cnt[0]++;
+}
+
+static void
+check_flatblock(pblock b)
+{
+  pflatblock fb;
+  pblock   *bn;
+  uint     *names;
+  uint      cnt, k, i;
+  bool      okay;
+
+  fb = new_flatblock(b);
+  bn = enumerate_block(b);
+  names = allocuint(2 * b->desc);
+  iterate_block(b, 0, 0, 0, record_names_block, 0, names);
+
+  okay = (fb->blocks == b->desc && fb->depth == getdepth_block(b));
+  for (k = 0; k < fb->blocks && okay; k++) {
+    /* compare with the depth-first enumeration */
+    okay = (bn[fb->bname[k]] == fb->b[k] && fb->rc[k] == fb->b[k]->rc
+	    && fb->cc[k] == fb->b[k]->cc && fb->a[k] == fb->b[k]->a
+	    && names[2 * fb->bname[k]] == fb->rname[k]
+	    && names[2 * fb->bname[k] + 1] == fb->cname[k]);
+
+    /* check sons and fathers */
+    for (i = 0; i < fb->b[k]->rsons * fb->b[k]->csons && okay; i++)
+      okay = (fb->b[fb->sonstart[k] + i] == fb->b[k]->son[i]
+	      && fb->father[fb->sonstart[k] + i] == k);
+  }
+
+  cnt = 0;
+  iterate_rowlist_flatblock(fb, 0, count_rowlist_flatblock, &cnt);
+  okay = okay && (cnt == fb->blocks);
+
+  (void) printf("Checking new_flatblock\n"
+		"  %u blocks on %u levels, %sokay\n", fb->blocks, fb->depth,
+		(okay ? "" : "    NOT "));
+  if (!okay)
+    problems++;
+
+  freemem(names);
+  freemem(bn);
+  del_flatblock(fb);
+}
+
+static    prkmatrix
+new_decaying_rkmatrix(uint rows, uint cols, uint k)
+{
+  prkmatrix r;
+  avector   tmp;
+  pavector  ac;
+  uint      j;
+
+  r = new_rkmatrix(rows, cols, k);
+  random_amatrix(&r->A);
+  random_amatrix(&r->B);
+  for (j = 0; j < k; j++) {
+    ac = init_column_avector(&tmp, &r->A, j);
+    scale_avector(REAL_POW(0.5, j), ac);
+    uninit_avector(ac);
+  }
+
+  return r;
+}
+
+static    real
+error_rkmatrix(pcrkmatrix r, pcamatrix d)
+{
+  pamatrix  e;
+  real      error;
+
+  e = new_amatrix(d->rows, d->cols);
+  copy_amatrix(false, d, e);
+  addmul_amatrix(-1.0, false, &r->A, true, &r->B, e);
+  error = norm2_amatrix(e) / norm2_amatrix(d);
+  del_amatrix(e);
+
+  return error;
+}
+
+static void
+check_randomized_rkmatrix(uint rows, uint cols, uint k, real eps)
+{
+  ptruncmode tm;
+  prkmatrix r, s, t;
+  pamatrix  d, d1;
+  amatrix   tmp;
+  real      error[3];
+  uint      rank[3];
+  bool      okay;
+
+  tm = new_releucl_truncmode();
+  tm->randomized = true;
+
+  r = new_decaying_rkmatrix(rows, cols, k);
+  s = new_decaying_rkmatrix(rows, cols, k);
+  d = new_zero_amatrix(2 * rows, cols);
+
+  /* Truncation */
+  d1 = init_sub_amatrix(&tmp, d, rows, 0, cols, 0);
+  addmul_amatrix(1.0, false, &r->A, true, &r->B, d1);
+  t = clone_rkmatrix(r);
+  trunc_rkmatrix(tm, eps, t);
+  error[0] = error_rkmatrix(t, d1);
+  rank[0] = t->k;
+
+  /* Addition */
+  addmul_amatrix(-0.5, false, &s->A, true, &s->B, d1);
+  copy_rkmatrix(false, r, t);
+  add_rkmatrix(-0.5, s, tm, eps, t);
+  error[1] = error_rkmatrix(t, d1);
+  rank[1] = t->k;
+  uninit_amatrix(d1);
+
+  /* Merge into a column */
+  clear_amatrix(d);
+  addmul_amatrix(1.0, false, &r->A, true, &r->B, d);
+  d1 = init_sub_amatrix(&tmp, d, rows, rows, cols, 0);
+  addmul_amatrix(1.0, false, &s->A, true, &s->B, d1);
+  uninit_amatrix(d1);
+  copy_rkmatrix(false, r, t);
+  resize_rkmatrix(t, rows, cols, k);
+  copy_amatrix(false, &r->A, &t->A);
+  merge_rkmatrix(true, s, tm, eps, t);
+  error[2] = error_rkmatrix(t, d);
+  rank[2] = t->k;
+
+  okay = (error[0] <= 4.0 * eps && error[1] <= 4.0 * eps
+	  && error[2] <= 4.0 * eps && rank[0] < k);
+  (void) printf("Checking randomized truncation, rank %u\n"
+		"  trunc %.2e (rank %u), add %.2e (rank %u),"
+		" merge %.2e (rank %u), %sokay\n", k, error[0], rank[0],
+		error[1], rank[1], error[2], rank[2],
+		(okay ? "" : "    NOT "));
+  if (!okay)
+    problems++;
+
+  del_rkmatrix(t);
+  del_amatrix(d);
+  del_rkmatrix(s);
+  del_rkmatrix(r);
+  del_truncmode(tm);
+}
+
+static void
+check_parallel_decomp(pchmatrix a, bool chol, real tol)
+{
+  phmatrix  f0, f1;
+  avector   xtmp, ytmp;
+  pavector  x, y;
+  pstopwatch sw;
+  real      error, t, t0;
+  uint      pardepth;
+
+  x = init_avector(&xtmp, a->rc->size);
+  y = init_avector(&ytmp, a->rc->size);
+  random_avector(x);
+
+  sw = new_stopwatch();
+
+  f0 = clone_hmatrix(a);
+  start_stopwatch(sw);
+  if (chol)
+    choldecomp_parallel_hmatrix(f0, 0, tol, 0);
+  else
+    lrdecomp_parallel_hmatrix(f0, 0, tol, 0);
+  t0 = stop_stopwatch(sw);
+
+  for (pardepth = 1; pardepth <= 3; pardepth++) {
+    f1 = clone_hmatrix(a);
+    start_stopwatch(sw);
+    if (chol)
+      choldecomp_parallel_hmatrix(f1, 0, tol, pardepth);
+    else
+      lrdecomp_parallel_hmatrix(f1, 0, tol, pardepth);
+    t = stop_stopwatch(sw);
+
+    copy_avector(x, y);
+    if (chol) {
+      cholsolve_hmatrix_avector(f0, y);
+      cholsolve_hmatrix_avector(f1, x);
+    }
+    else {
+      lrsolve_hmatrix_avector(false, f0, y);
+      lrsolve_hmatrix_avector(false, f1, x);
+    }
+    add_avector(-1.0, x, y);
+    error = norm2_avector(y);
+    (void) printf("Checking %s (pardepth=%u)\n"
+		  "  %.2f seconds, speedup %.2f\n"
+		  "  Difference %g, %sokay\n",
+		  (chol ? "choldecomp_parallel_hmatrix" :
+		   "lrdecomp_parallel_hmatrix"), pardepth, t,
+		  (t > 0.0 ? t0 / t : 0.0), error,
+		  (error == 0.0 ? "" : "    NOT "));
+    if (error != 0.0)
+      problems++;
+
+    random_avector(x);
+    del_hmatrix(f1);
+  }
+
+  del_hmatrix(f0);
+  del_stopwatch(sw);
+
+  uninit_avector(y);
+  uninit_avector(x);
+}
+
+static void
+check_accumulated_decomp(pchmatrix a, bool chol, real tol)
+{
+  phmatrix  f;
+  ptruncmode tm;
+  avector   xtmp, btmp;
+  pavector  x, b;
+  pstopwatch sw;
+  real      error[2], t[2];
+  uint      i;
+
+  x = init_avector(&xtmp, a->rc->size);
+  b = init_avector(&btmp, a->rc->size);
+  random_avector(x);
+
+  sw = new_stopwatch();
+  tm = new_releucl_truncmode();
+
+  for (i = 0; i < 2; i++) {
+    tm->accumulate = (i == 1);
+
+    f = clone_hmatrix(a);
+    start_stopwatch(sw);
+    if (chol)
+      choldecomp_hmatrix(f, tm, tol);
+    else
+      lrdecomp_hmatrix(f, tm, tol);
+    t[i] = stop_stopwatch(sw);
+
+    clear_avector(b);
+    if (chol) {
+      addevalsymm_hmatrix_avector(1.0, a, x, b);
+      cholsolve_hmatrix_avector(f, b);
+    }
+    else {
+      addeval_hmatrix_avector(1.0, a, x, b);
+      lrsolve_hmatrix_avector(false, f, b);
+    }
+    add_avector(-1.0, x, b);
+    error[i] = norm2_avector(b) / norm2_avector(x);
+
+    del_hmatrix(f);
+  }
+
+  (void) printf("Checking %s with accumulated updates\n"
+		"  %.2f seconds, immediate updates %.2f seconds\n"
+		"  Accuracy %g, immediate updates %g, %sokay\n",
+		(chol ? "choldecomp_hmatrix" : "lrdecomp_hmatrix"), t[1],
+		t[0], error[1], error[0],
+		(error[1] <= 2.0 * error[0] + tol ? "" : "    NOT "));
+  if (error[1] > 2.0 * error[0] + tol)
+    problems++;
+
+  del_truncmode(tm);
+  del_stopwatch(sw);
+
+  uninit_avector(b);
+  uninit_avector(x);
+}
+
+/* Copy the first "len" bytes of a file, replacing "vsz" bytes at
+   position "pos" by "val", and check that the copy is rejected */
+static    bool
+rejects_modified_binfile(const char *src, size_t len, size_t pos,
+			 const void *val, size_t vsz)
+{
+  pbinfile  bf;
+  FILE     *in, *out;
+  char     *buf;
+  size_t    size;
+
+  in = fopen(src, "rb");
+  assert(in != NULL);
+  (void) fseek(in, 0, SEEK_END);
+  size = ftell(in);
+  (void) fseek(in, 0, SEEK_SET);
+  buf = (char *) allocmem(size);
+  size = fread(buf, 1, size, in);
+  fclose(in);
+
+  if (len > size)
+    len = size;
+  if (val && pos + vsz <= len)
+    memcpy(buf + pos, val, vsz);
+
+  out = fopen("test_hmatrix_bad.bin", "wb");
+  assert(out != NULL);
+  (void) fwrite(buf, 1, len, out);
+  fclose(out);
+  freemem(buf);
+
+  bf = read_binfile("test_hmatrix_bad.bin");
+  (void) remove("test_hmatrix_bad.bin");
+
+  if (bf) {
+    del_binfile(bf);
+    return false;
+  }
+  return true;
+}
+
+static void
+check_corrupt_binfile(const char *name)
+{
+  /* Layout: 8 magic bytes, 10 uint fields with the depth of the row
+     cluster tree in the eighth, dataoff and datasize, followed by the
+     stream starting with the offset of the root's index array, the
+     root's size, offset and number of sons */
+  size_t    hdsize = 8 + 10 * sizeof(uint) + 2 * sizeof(size_t);
+  size_t    rdepth = 8 + 7 * sizeof(uint);
+  size_t    huge = ~(size_t) 0 - 15;
+  uint      big = ~0u;
+  uint      odd = 1;
+  uint      zero = 0;
+  uint      deep = BINFILE_MAXDEPTH + 1;
+  uint      ok = 0;
+
+  (void) printf("Checking read_binfile for corrupt files\n");
+
+  ok += rejects_modified_binfile(name, hdsize + 100, 0, NULL, 0);
+  ok += rejects_modified_binfile(name, ~(size_t) 0,
+				 8 + 10 * sizeof(uint) + sizeof(size_t),
+				 &huge, sizeof(size_t));
+  ok += rejects_modified_binfile(name, ~(size_t) 0, hdsize, &odd,
+				 sizeof(uint));
+  ok += rejects_modified_binfile(name, ~(size_t) 0,
+				 hdsize + 2 * sizeof(uint), &big,
+				 sizeof(uint));
+  ok += rejects_modified_binfile(name, ~(size_t) 0,
+				 hdsize + 3 * sizeof(uint), &big,
+				 sizeof(uint));
+  ok += rejects_modified_binfile(name, ~(size_t) 0,
+				 hdsize + 4 * sizeof(uint), &big,
+				 sizeof(uint));
+  ok += rejects_modified_binfile(name, ~(size_t) 0, rdepth, &zero,
+				 sizeof(uint));
+  ok += rejects_modified_binfile(name, ~(size_t) 0, rdepth, &deep,
+				 sizeof(uint));
+
+  (void) printf("  %u of 8 rejected, %sokay\n", ok,
+		(ok == 8 ? "" : "    NOT "));
+  if (ok != 8)
+    problems++;
+}
+
+static void
+check_binfile(pchmatrix a)
+{
+  pbinfile  bf;
+  avector   xtmp, ytmp, ztmp;
+  pavector  x, y, z;
+  real      error;
+
+  write_binfile_hmatrix(a, "test_hmatrix.bin");
+  bf = read_binfile("test_hmatrix.bin");
+  assert(bf != NULL && bf->hm != NULL);
+
+  x = init_avector(&xtmp, a->cc->size);
+  y = init_avector(&ytmp, a->rc->size);
+  z = init_avector(&ztmp, a->rc->size);
+  random_avector(x);
+
+  clear_avector(y);
+  addeval_hmatrix_avector(1.0, a, x, y);
+  clear_avector(z);
+  addeval_hmatrix_avector(1.0, bf->hm, x, z);
+  add_avector(-1.0, y, z);
+  error = norm2_avector(z);
+  (void) printf("Checking read_binfile for hmatrix\n"
+		"  Difference %g, %sokay\n", error,
+		(error == 0.0 ? "" : "    NOT "));
+  if (error != 0.0)
+    problems++;
+
+  uninit_avector(z);
+  uninit_avector(y);
+  uninit_avector(x);
+
+  del_binfile(bf);
+
+  check_corrupt_binfile("test_hmatrix.bin");
+
+  (void) remove("test_hmatrix.bin");
+}
+
+static void
+check_arena(pchmatrix a, pbem2d bem2, pblock b)
+{
+  phmatrix  c;
+  avector   xtmp, ytmp, ztmp;
+  pavector  x, y, z;
+  size_t    sizeold, sizenew;
+  uint      amatrices, avectors;
+  real      error;
+
+  amatrices = getactives_amatrix();
+  avectors = getactives_avector();
+
+  c = build_from_block_arena_hmatrix(b, 0);
+  assemble_bem2d_hmatrix(bem2, b, c);
+
+  x = init_avector(&xtmp, a->cc->size);
+  y = init_avector(&ytmp, a->rc->size);
+  z = init_avector(&ztmp, a->rc->size);
+  random_avector(x);
+
+  clear_avector(y);
+  addeval_hmatrix_avector(1.0, a, x, y);
+  clear_avector(z);
+  addeval_hmatrix_avector(1.0, c, x, z);
+  add_avector(-1.0, y, z);
+  error = norm2_avector(z) / norm2_avector(y);
+  (void) printf("Checking build_from_block_arena_hmatrix\n"
+		"  Accuracy %g, %sokay\n", error,
+		(IS_IN_RANGE(0.0, error, 1.0e-14) ? "" : "    NOT "));
+  if (!IS_IN_RANGE(0.0, error, 1.0e-14))
+    problems++;
+
+  /* Coarsening attaches heap-allocated rkmatrix objects to nodes
+     taken from the arena, these have to be released individually */
+  sizeold = getsize_hmatrix(c);
+  coarsen_hmatrix(c, 1.0e-6, true);
+  sizenew = getsize_hmatrix(c);
+
+  clear_avector(z);
+  addeval_hmatrix_avector(1.0, c, x, z);
+  add_avector(-1.0, y, z);
+  error = norm2_avector(z) / norm2_avector(y);
+  (void) printf("Checking coarsen_hmatrix with arena\n"
+		"  Storage %.1f MB -> %.1f MB, accuracy %g, %sokay\n",
+		sizeold / 1048576.0, sizenew / 1048576.0, error,
+		(sizenew < sizeold
+		 && IS_IN_RANGE(0.0, error, 1.0e-5) ? "" : "    NOT "));
+  if (!(sizenew < sizeold && IS_IN_RANGE(0.0, error, 1.0e-5)))
+    problems++;
+
+  uninit_avector(z);
+  uninit_avector(y);
+  uninit_avector(x);
+
+  del_hmatrix(c);
+
+  (void) printf("  Active objects after deletion: %u matrices, %u vectors, "
+		"%sokay\n", getactives_amatrix() - amatrices,
+		getactives_avector() - avectors,
+		(getactives_amatrix() == amatrices
+		 && getactives_avector() == avectors ? "" : "    NOT "));
+  if (getactives_amatrix() != amatrices || getactives_avector() != avectors)
+    problems++;
+}
+
+static void
+check_flathmatrix(pchmatrix a)
+{
+  pflathmatrix fa;
+  avector   xtmp, ytmp, ztmp;
+  pavector  x, y, z;
+  real      error;
+
+  fa = build_from_hmatrix_flathmatrix(a);
+
+  x = init_avector(&xtmp, a->cc->size);
+  y = init_avector(&ytmp, a->rc->size);
+  z = init_avector(&ztmp, a->rc->size);
+  random_avector(x);
+
+  clear_avector(y);
+  addeval_hmatrix_avector(1.0, a, x, y);
+  clear_avector(z);
+  addeval_flathmatrix_avector(1.0, fa, x, z);
+  add_avector(-1.0, y, z);
+  error = norm2_avector(z) / norm2_avector(y);
+  (void) printf("Checking addeval_flathmatrix_avector\n"
+		"  Accuracy %g, %sokay\n", error,
+		(IS_IN_RANGE(0.0, error, 1.0e-14) ? "" : "    NOT "));
+  if (!IS_IN_RANGE(0.0, error, 1.0e-14))
+    problems++;
+
+  clear_avector(y);
+  addevaltrans_hmatrix_avector(1.0, a, x, y);
+  clear_avector(z);
+  addevaltrans_flathmatrix_avector(1.0, fa, x, z);
+  add_avector(-1.0, y, z);
+  error = norm2_avector(z) / norm2_avector(y);
+  (void) printf("Checking addevaltrans_flathmatrix_avector\n"
+		"  Accuracy %g, %sokay\n", error,
+		(IS_IN_RANGE(0.0, error, 1.0e-14) ? "" : "    NOT "));
+  if (!IS_IN_RANGE(0.0, error, 1.0e-14))
+    problems++;
+
+  del_flathmatrix(fa);
+
+  fa = build_from_hmatrix_mixed_flathmatrix(a, 1.0e-4);
+
+  clear_avector(y);
+  addeval_hmatrix_avector(1.0, a, x, y);
+  clear_avector(z);
+  addeval_flathmatrix_avector(1.0, fa, x, z);
+  add_avector(-1.0, y, z);
+  error = norm2_avector(z) / norm2_avector(y);
+  (void) printf("Checking build_from_hmatrix_mixed_flathmatrix\n"
+		"  %.1f%% of the storage in single precision\n"
+		"  %.1f KB instead of %.1f KB\n"
+		"  Accuracy %g, %sokay\n",
+		100.0 * fa->ssize / (fa->size + fa->ssize),
+		getsize_flathmatrix(fa) / 1024.0,
+		getsize_hmatrix(a) / 1024.0, error,
+		(IS_IN_RANGE(0.0, error, 1.0e-4) ? "" : "    NOT "));
+  if (!IS_IN_RANGE(0.0, error, 1.0e-4))
+    problems++;
+
+  clear_avector(y);
+  addevaltrans_hmatrix_avector(1.0, a, x, y);
+  clear_avector(z);
+  addevaltrans_flathmatrix_avector(1.0, fa, x, z);
+  add_avector(-1.0, y, z);
+  error = norm2_avector(z) / norm2_avector(y);
+  (void) printf("Checking addevaltrans_flathmatrix_avector (mixed)\n"
+		"  Accuracy %g, %sokay\n", error,
+		(IS_IN_RANGE(0.0, error, 1.0e-4) ? "" : "    NOT "));
+  if (!IS_IN_RANGE(0.0, error, 1.0e-4))
+    problems++;
+
+  uninit_avector(z);
+  uninit_avector(y);
+  uninit_avector(x);
+
+  del_flathmatrix(fa);
+}
+
+static void
+check_block_mvm(pchmatrix a, bool atrans)
+{
+  amatrix   Xtmp, Ytmp, Ztmp;
+  pamatrix  X, Y, Z;
+  avector   xtmp, ytmp;
+  pavector  x, y;
+  uint      rows, cols, m, j;
+  real      error;
+
+  rows = (atrans ? a->cc->size : a->rc->size);
+  cols = (atrans ? a->rc->size : a->cc->size);
+  m = 7;
+
+  X = init_amatrix(&Xtmp, cols, m);
+  random_amatrix(X);
+  Y = init_zero_amatrix(&Ytmp, rows, m);
+  Z = init_zero_amatrix(&Ztmp, rows, m);
+
+  /* Reference result, computed column by column */
+  for (j = 0; j < m; j++) {
+    x = init_column_avector(&xtmp, X, j);
+    y = init_column_avector(&ytmp, Z, j);
+    mvm_hmatrix_avector(0.5, atrans, a, x, y);
+    uninit_avector(y);
+    uninit_avector(x);
+  }
+
+  mvm_hmatrix_amatrix(0.5, atrans, a, X, Y);
+
+  add_amatrix(-1.0, false, Z, Y);
+  error = normfrob_amatrix(Y) / normfrob_amatrix(Z);
+  (void) printf("Checking mvm_hmatrix_amatrix (atrans=%s)\n"
+		"  Accuracy %g, %sokay\n", (atrans ? "tr" : "fl"), error,
+		(IS_IN_RANGE(0.0, error, 1.0e-14) ? "" : "    NOT "));
+  if (!IS_IN_RANGE(0.0, error, 1.0e-14))
+    problems++;
+
+  uninit_amatrix(Z);
+  uninit_amatrix(Y);
+  uninit_amatrix(X);
+}
+
 static void
 check_triangularsolve(bool lower, bool unit, bool atrans,
 		      pchmatrix a, bool xtrans, real tol)
@@ -257,6 +1110,23 @@ main()
 					   build_bem2d_rect_quadpoints);
   setup_hmatrix_recomp_bem2d(bem2, true, eps_aca, false, eps_aca);
 
+  (void) printf("----------------------------------------\n"
+		"Check parallel cluster tree construction\n");
+  check_parallel_cluster(100000, H2_ADAPTIVE, "adaptive");
+  check_parallel_cluster(100000, H2_REGULAR, "regular");
+  check_parallel_cluster(20000, H2_SIMSUB, "simsub");
+  check_parallel_cluster(20000, H2_PCA, "pca");
+  check_morton_cluster(100000);
+
+  (void) printf("----------------------------------------\n"
+		"Check parallel block tree construction\n");
+  check_parallel_block(root2, eta);
+  check_flatblock(block2);
+
+  (void) printf("----------------------------------------\n"
+		"Check randomized truncation\n");
+  check_randomized_rkmatrix(200, 150, 80, 1.0e-8);
+
   (void) printf("----------------------------------------\n"
 		"Check %u x %u H-matrix addition\n", n, n);
 
@@ -267,6 +1137,17 @@ main()
 
   check_addhmatrix(a, tol);
 
+  check_parallel_mvm(a);
+
+  check_arena(a, bem2, block2);
+
+  check_binfile(a);
+
+  check_flathmatrix(a);
+
+  check_block_mvm(a, false);
+  check_block_mvm(a, true);
+
   del_hmatrix(a);
 
   (void) printf("----------------------------------------\n"
@@ -287,6 +1168,9 @@ main()
   (void) printf("Copying matrix\n");
   acopy = clone_hmatrix(a);
 
+  check_parallel_decomp(a, true, tol);
+  check_accumulated_decomp(a, true, tol);
+
   (void) printf("Computing Cholesky factorization\n");
   choldecomp_hmatrix(a, 0, tol);
 
@@ -364,6 +1248,9 @@ main()
   (void) printf("Copying matrix\n");
   acopy = clone_hmatrix(a);
 
+  check_parallel_decomp(a, false, tol);
+  check_accumulated_decomp(a, false, tol);
+
   (void) printf("Computing LR factorization\n");
   lrdecomp_hmatrix(a, 0, tol);
 
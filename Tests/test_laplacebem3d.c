@@ -171,6 +171,148 @@ solve_cg_bem3d(matrixtype type, void *A, pavector b, pavector x,
 
 }
 
+/* Compare the fundamental solution and its normal derivatives with
+ * a straightforward evaluation */
+static void
+check_kernels(pcbem3d bem)
+{
+  pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  pamatrix  V;
+  real(*X)[3], (*Y)[3];
+  real      d[3], r2, dot, hn, val, error, maxerror[3];
+  uint      rows, cols, i, j, k;
+
+  /* Odd number of rows to check the remainders of vectorized loops */
+  rows = gr->triangles - 3;
+  cols = gr->triangles / 2;
+
+  X = (real(*)[3]) allocreal(3 * rows);
+  Y = (real(*)[3]) allocreal(3 * cols);
+  for (i = 0; i < rows; i++)
+    for (k = 0; k < 3; k++)
+      X[i][k] = (gr_x[gr_t[i][0]][k] + gr_x[gr_t[i][1]][k]
+		 + gr_x[gr_t[i][2]][k]) / 3.0;
+  for (j = 0; j < cols; j++)
+    for (k = 0; k < 3; k++)
+      Y[j][k] = 0.5 * (gr_x[gr_t[2 * j][0]][k] + gr_x[gr_t[2 * j][1]][k]
+		       + gr_x[gr_t[2 * j][2]][k]);
+
+  V = new_amatrix(rows, cols);
+
+  for (k = 0; k < 3; k++) {
+    if (k == 0)
+      bem->kernels->fundamental((const real(*)[3]) X, (const real(*)[3]) Y,
+				V);
+    else if (k == 1)
+      bem->kernels->dny_fundamental((const real(*)[3]) X,
+				    (const real(*)[3]) Y, gr_n, V);
+    else
+      bem->kernels->dnx_dny_fundamental((const real(*)[3]) X, gr_n,
+					(const real(*)[3]) Y, gr_n, V);
+
+    maxerror[k] = 0.0;
+    for (j = 0; j < cols; j++)
+      for (i = 0; i < rows; i++) {
+	d[0] = X[i][0] - Y[j][0];
+	d[1] = X[i][1] - Y[j][1];
+	d[2] = X[i][2] - Y[j][2];
+	r2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+	dot = d[0] * gr_n[j][0] + d[1] * gr_n[j][1] + d[2] * gr_n[j][2];
+
+	if (k == 0)
+	  val = 1.0 / REAL_SQRT(r2);
+	else if (k == 1)
+	  val = dot / (r2 * REAL_SQRT(r2));
+	else {
+	  hn = gr_n[i][0] * gr_n[j][0] + gr_n[i][1] * gr_n[j][1]
+	    + gr_n[i][2] * gr_n[j][2]
+	    - 3.0 * dot * (d[0] * gr_n[i][0] + d[1] * gr_n[i][1]
+			   + d[2] * gr_n[i][2]) / r2;
+	  val = hn / (r2 * REAL_SQRT(r2));
+	}
+	val *= 0.25 / M_PI;
+
+	error = REAL_ABS(V->a[i + j * V->ld] - val)
+	  / (REAL_ABS(val) > 1.0 ? REAL_ABS(val) : 1.0);
+	if (error > maxerror[k])
+	  maxerror[k] = error;
+      }
+  }
+
+  printf("Checking Laplace kernel functions\n"
+	 "  Errors %.2e, %.2e, %.2e, %sokay\n",
+	 maxerror[0], maxerror[1], maxerror[2],
+	 (maxerror[0] <= 1.0e-14 && maxerror[1] <= 1.0e-14
+	  && maxerror[2] <= 1.0e-14 ? "" : "    NOT "));
+  if (maxerror[0] > 1.0e-14 || maxerror[1] > 1.0e-14
+      || maxerror[2] > 1.0e-14)
+    problems++;
+
+  del_amatrix(V);
+  freemem(Y);
+  freemem(X);
+}
+
+/* Compare kernel integrals and L^2-projections with and without
+ * precomputed quadrature points, the points remain active afterwards */
+static void
+check_quadpoints(pbem3d bem, pbem3d bem_dlp)
+{
+  pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  pamatrix  V, W;
+  pavector  f, g;
+  real(*Z)[3];
+  real      error, errorf;
+  uint      rows, cols, j, k;
+
+  rows = gr->triangles;
+  cols = 7;
+
+  Z = (real(*)[3]) allocreal(3 * cols);
+  for (j = 0; j < cols; j++)
+    for (k = 0; k < 3; k++)
+      Z[j][k] = 0.8 * (gr_x[gr_t[5 * j][0]][k] + gr_x[gr_t[5 * j][1]][k]
+		       + gr_x[gr_t[5 * j][2]][k]);
+
+  V = new_amatrix(rows, cols);
+  W = new_amatrix(rows, cols);
+  f = new_avector(rows);
+  g = new_avector(rows);
+
+  bem->kernels->kernel_row(NULL, (const real(*)[3]) Z, bem, V);
+  projectl2_bem3d_const_avector(bem, eval_dirichlet_quadratic_laplacebem3d,
+				f);
+
+  setup_quadpoints_bem3d(bem);
+  setup_quadpoints_bem3d(bem_dlp);
+
+  bem->kernels->kernel_row(NULL, (const real(*)[3]) Z, bem, W);
+  projectl2_bem3d_const_avector(bem, eval_dirichlet_quadratic_laplacebem3d,
+				g);
+
+  add_amatrix(-1.0, false, V, W);
+  error = normfrob_amatrix(W) / normfrob_amatrix(V);
+  add_avector(-1.0, f, g);
+  errorf = norm2_avector(g) / norm2_avector(f);
+
+  printf("Checking precomputed quadrature points\n"
+	 "  Errors %.2e, %.2e, %sokay\n", error, errorf,
+	 (error <= 1.0e-14 && errorf <= 1.0e-14 ? "" : "    NOT "));
+  if (error > 1.0e-14 || errorf > 1.0e-14)
+    problems++;
+
+  del_avector(g);
+  del_avector(f);
+  del_amatrix(W);
+  del_amatrix(V);
+  freemem(Z);
+}
+
 static void
 test_hmatrix_system(const char *apprxtype, pcamatrix Vfull,
 		    pcamatrix KMfull, pblock block, pbem3d bem_slp,
@@ -412,6 +554,9 @@ main(int argc, char **argv)
 
   printf("Testing unit sphere with %d triangles\n", n);
 
+  check_kernels(bem_dlp);
+  check_quadpoints(bem_slp, bem_dlp);
+
   printf("----------------------------------------\n");
   printf("Testing inner Boundary integral equations:\n");
   printf("----------------------------------------\n\n");
@@ -519,6 +664,11 @@ main(int argc, char **argv)
   test_hmatrix_system("ACA partial pivoting", Vfull, KMfull, block, bem_slp,
 		      V, bem_dlp, KM, false, false, 7.0e-2, 7.5e-2);
 
+  setup_hmatrix_aprx_pacaplus_bem3d(bem_slp, root, root, block, eps_aca);
+  setup_hmatrix_aprx_pacaplus_bem3d(bem_dlp, root, root, block, eps_aca);
+  test_hmatrix_system("ACA+ partial pivoting", Vfull, KMfull, block, bem_slp,
+		      V, bem_dlp, KM, false, false, 7.0e-2, 7.5e-2);
+
   setup_hmatrix_aprx_hca_bem3d(bem_slp, root, root, block, m, eps_aca);
   setup_hmatrix_aprx_hca_bem3d(bem_slp, root, root, block, m, eps_aca);
   test_hmatrix_system("HCA2", Vfull, KMfull, block, bem_slp, V, bem_dlp, KM,